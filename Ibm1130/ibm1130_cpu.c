@@ -477,19 +477,21 @@ static const char *xio_funcs[] = {
 };
 static int32 ibm1130_qcount ()
 {
-    int32 i, cnt;
-    UNIT *uptr;
+    int32 i, j, n, cnt;
+    UNIT **entries;
     DEVICE *dptr;
 
     cnt = 0;
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
-        dptr = find_dev_from_unit (uptr);
+    n = sim_qlist (&entries);
+    for (j = 0; j < n; j++) {
+        dptr = find_dev_from_unit (entries[j]);
         for (i=0; sim_devices[i]; i++)
             if (dptr == sim_devices[i]) {
                 cnt++;
                 break;
             }
     }
+    free (entries);
     return cnt;
 }
 
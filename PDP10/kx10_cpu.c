@@ -209,6 +209,39 @@ uint64  fault_data;                           /* Fault data from last fault */
 int     trap_flag;                            /* In trap cycle */
 int     last_page;                            /* Last page mapped */
 #endif
+#if KI | KL
+/*
+ * Host TLB.  Caches the result of a successful page_lookup() for plain
+ * accesses (no PI cycle, previous context or public mode), so that
+ * Mem_read and Mem_write can go straight to host memory after a single
+ * tag compare.  Entries are invalidated whenever e_tlb/u_tlb are cleared
+ * by bumping the generation number held in every tag.  A refill of an
+ * empty e_tlb/u_tlb entry only drops the host entries for that page pair.
+ */
+typedef struct {
+    uint32      tag;                          /* Generation, section, page */
+    int         flags;                        /* FTLB_xxx */
+    int         last_page;                    /* KI last_page, -1 if direct */
+    uint64     *mem;                          /* Host address of page */
+} FAST_TLB;
+
+#define FTLB_WRITE      1                     /* Write allowed */
+#define FTLB_PUBLIC     2                     /* Public page */
+#define FTLB_GEN        (1 << 21)             /* Tag generation increment */
+
+FAST_TLB fast_tlb[2][512];                    /* Exec and user host TLB */
+uint32   fast_tlb_gen = FTLB_GEN;             /* Current tag generation */
+#if KL
+uint32   fast_tlb_smask;                      /* Section bits used in tags */
+
+#define FTLB_TAG(addr)  (fast_tlb_gen | ((sect & fast_tlb_smask) << 9) | \
+                                            (((addr) & RMASK) >> 9))
+#else
+#define FTLB_TAG(addr)  (fast_tlb_gen | (((addr) & RMASK) >> 9))
+#endif
+
+void fast_tlb_flush(void);
+#endif
 #if BBN
 int     exec_map;                             /* Enable executive mapping */
 int     next_write;                           /* Clear next write mapping */
@@ -1320,6 +1353,7 @@ t_stat dev_pag(uint32 dev, uint64 *data) {
             u_tlb[i] = 0;
         page_enable = (*data & 020000) != 0;
         t20_page = (*data & 040000) != 0;
+        fast_tlb_flush();
         sim_debug(DEBUG_CONO, &cpu_dev, "CONO PAG %012llo\n", *data);
         break;
 
@@ -1341,6 +1375,7 @@ t_stat dev_pag(uint32 dev, uint64 *data) {
               for(i = 0; i < 8; i++)
                  u_tlb[page+i] = 0;
            }
+           fast_tlb_flush();
         } else {
             res = *data;
             if (res & SMASK) {
@@ -1366,6 +1401,7 @@ t_stat dev_pag(uint32 dev, uint64 *data) {
                 }
                 for (;i < 546; i++)
                    u_tlb[i] = 0;
+                fast_tlb_flush();
            }
            sim_debug(DEBUG_DATAIO, &cpu_dev,
                     "DATAO PAG %012llo ebr=%06o ubr=%06o\n",
@@ -1726,6 +1762,7 @@ t_stat dev_pag(uint32 dev, uint64 *data) {
             for (;i < 546; i++)
                u_tlb[i] = 0;
             page_enable = (res & 020000) != 0;
+            fast_tlb_flush();
         }
         if (res & SMASK) {
             ub_ptr = ((res >> 18) & 017777) << 9;
@@ -1736,6 +1773,7 @@ t_stat dev_pag(uint32 dev, uint64 *data) {
             user_addr_cmp = (res & BIT4) != 0;
             small_user =    (res & BIT3) != 0;
             fm_sel = (uint8)(res >> 29) & 060;
+            fast_tlb_flush();
        }
        pag_reload = 0;
        sim_debug(DEBUG_DATAIO, &cpu_dev,
@@ -2029,12 +2067,64 @@ sim_debug(DEBUG_DATAIO, &cpu_dev, "Rl=%06o Pl=%06o, Rh=%06o, Ph=%06o\n", Rl, Pl,
 }
 #endif
 
+#if KI | KL
+/*
+ * Invalidate all host TLB entries.
+ */
+void
+fast_tlb_flush(void)
+{
+    fast_tlb_gen += FTLB_GEN;
+    if (fast_tlb_gen == 0) {         /* Wrapped, clear out old tags */
+        memset(fast_tlb, 0, sizeof(fast_tlb));
+        fast_tlb_gen = FTLB_GEN;
+    }
+#if KL
+    /* Sections are only part of the translation for extended TOPS 20 */
+    fast_tlb_smask = (QKLB && t20_page) ? 07777 : 0;
+#endif
+}
+
+/*
+ * Remember a translation in the host TLB.
+ */
+static void
+fast_tlb_fill(int uf, t_addr addr, t_addr loc, int flags, int lpage)
+{
+    FAST_TLB   *ft = &fast_tlb[uf][(RMASK & addr) >> 9];
+
+    if ((loc | 0777) >= MEMSIZE)
+        return;
+    ft->tag = FTLB_TAG(addr);
+    ft->flags = flags;
+    ft->last_page = lpage;
+    ft->mem = &M[loc & ~0777];
+}
+
+/*
+ * Invalidate the host TLB entries for the e_tlb/u_tlb page pair being
+ * refilled.  u_tlb entries 01000 and up hold exec pages 340-377.
+ */
+static void
+fast_tlb_inval(int uf, int page)
+{
+    if (page & 01000) {
+        uf = 0;
+        page -= 01000 - 0340;
+    }
+    fast_tlb[uf][page & 0776].tag = 0;
+    fast_tlb[uf][page | 1].tag = 0;
+}
+#endif
+
 #if KL
 int
 load_tlb(int uf, int page, int wr)
 {
     uint64  data;
 
+    fast_tlb_inval(uf, page);
+
 #if KL_ITS
     if (QITS && t20_page) {
         uint64     dbr;
@@ -2305,10 +2395,13 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
     int      uf = (FLAGS & USER) != 0;
     int      pub = (FLAGS & PUBLIC) != 0;
     int      upmp = 0;
+    int      plain = !flag && !pub && (xct_flag == 0 || fetch);
 
     /* If paging is not enabled, address is direct */
     if (!page_enable) {
         *loc = addr;
+        if (plain)
+            fast_tlb_fill(uf, addr, addr, FTLB_WRITE, -1);
         return 1;
     }
 
@@ -2434,6 +2527,7 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
 
     /* Check for access error */
     if ((data & KL_PAG_A) == 0 || (wr & ((data & KL_PAG_W) == 0))) {
+        fast_tlb_flush();
 #if KL_ITS
         if (QITS) {
             /* Remap the flag bits */
@@ -2481,6 +2575,9 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
     /* If fetching from public page, set public flag */
     if (fetch && ((data & KL_PAG_P) != 0))
         FLAGS |= PUBLIC;
+    if (plain && !upmp)
+        fast_tlb_fill(uf, addr, *loc, ((data & KL_PAG_W) ? FTLB_WRITE : 0) |
+                                      ((data & KL_PAG_P) ? FTLB_PUBLIC : 0), -1);
     return 1;
 }
 
@@ -2519,6 +2616,20 @@ int Mem_read(int flag, int cur_context, int fetch) {
         }
         MB = get_reg(AB);
     } else {
+        FAST_TLB *ft = &fast_tlb[(FLAGS & USER) != 0][(RMASK & AB) >> 9];
+
+        /* Try host TLB first */
+        if (ft->tag == FTLB_TAG(AB) && !flag && (xct_flag == 0 || fetch) &&
+            (FLAGS & PUBLIC) == 0 && AB != brk_addr &&
+            (!modify || (ft->flags & FTLB_WRITE))) {
+            if (fetch && (ft->flags & FTLB_PUBLIC))
+                FLAGS |= PUBLIC;
+            if (sim_brk_summ && sim_brk_test(AB, SWMASK('R')))
+                watch_stop = 1;
+            sim_interval--;
+            MB = ft->mem[AB & 0777];
+            return 0;
+        }
         if (!page_lookup(AB, flag, &addr, 0, cur_context, fetch))
             return 1;
         if (addr >= MEMSIZE) {
@@ -2557,6 +2668,17 @@ int Mem_write(int flag, int cur_context) {
         }
         set_reg(AB, MB);
     } else {
+        FAST_TLB *ft = &fast_tlb[(FLAGS & USER) != 0][(RMASK & AB) >> 9];
+
+        /* Try host TLB first */
+        if (ft->tag == FTLB_TAG(AB) && (ft->flags & FTLB_WRITE) && !flag &&
+            xct_flag == 0 && (FLAGS & PUBLIC) == 0 && AB != brk_addr) {
+            if (sim_brk_summ && sim_brk_test(AB, SWMASK('W')))
+                watch_stop = 1;
+            sim_interval--;
+            ft->mem[AB & 0777] = MB;
+            return 0;
+        }
         if (!page_lookup(AB, flag, &addr, 1, cur_context, 0))
             return 1;
         if (addr >= MEMSIZE) {
@@ -2761,6 +2883,7 @@ load_tlb(int uf, int page)
     if (base) {
         data = e_tlb[page];
         if (data == 0) {
+           fast_tlb_inval(0, page);
            data = M[eb_ptr + (page >> 1)];
            e_tlb[page & 0776] = RMASK & (data >> 18);
            e_tlb[page | 1] = RMASK & data;
@@ -2771,6 +2894,7 @@ load_tlb(int uf, int page)
     } else {
         data = u_tlb[page];
         if (data == 0) {
+           fast_tlb_inval(1, page);
            data = M[ub_ptr + (page >> 1)];
            u_tlb[page & 01776] = RMASK & (data >> 18);
            u_tlb[page | 1] = RMASK & data;
@@ -2800,6 +2924,7 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
     int      page = (RMASK & addr) >> 9;
     int      uf = (FLAGS & USER) != 0;
     int      pub = (FLAGS & PUBLIC) != 0;
+    int      plain = !flag && !pub && xct_flag == 0;
 
     if (page_fault)
         return 0;
@@ -2807,6 +2932,8 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
     /* If paging is not enabled, address is direct */
     if (!page_enable) {
         *loc = addr;
+        if (plain)
+            fast_tlb_fill(uf, addr, addr, FTLB_WRITE, -1);
         return 1;
     }
 
@@ -2850,6 +2977,8 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
             page_fault = 1;
             return !wr;
         }
+        if (plain)
+            fast_tlb_fill(uf, addr, addr, FTLB_WRITE, -1);
         return 1;
     }
     data = load_tlb(uf, page);
@@ -2878,6 +3007,9 @@ int page_lookup(t_addr addr, int flag, t_addr *loc, int wr, int cur_context, int
     /* If fetching from public page, set public flag */
     if (fetch && ((data & KI_PAG_P) != 0))
         FLAGS |= PUBLIC;
+    if (plain)
+        fast_tlb_fill(uf, addr, *loc, ((data & KI_PAG_W) ? FTLB_WRITE : 0) |
+                                      ((data & KI_PAG_P) ? FTLB_PUBLIC : 0), last_page);
     return 1;
 }
 
@@ -2919,7 +3051,25 @@ int Mem_read(int flag, int cur_context, int fetch) {
         }
         MB = get_reg(AB);
     } else {
+        FAST_TLB *ft;
 read:
+        ft = &fast_tlb[(FLAGS & USER) != 0][(RMASK & AB) >> 9];
+        /* Try host TLB first */
+        if (ft->tag == FTLB_TAG(AB) && !flag && xct_flag == 0 && !page_fault &&
+            (FLAGS & PUBLIC) == 0 && ((ft->flags & FTLB_WRITE) ||
+                         (!modify && !(BYF5 && (IR & 06) == 6)))) {
+            if (ft->last_page >= 0) {          /* Mapped, account for TLB */
+                sim_interval--;
+                last_page = ft->last_page;
+            }
+            if (fetch && (ft->flags & FTLB_PUBLIC))
+                FLAGS |= PUBLIC;
+            if (sim_brk_summ && sim_brk_test(AB, SWMASK('R')))
+                watch_stop = 1;
+            sim_interval--;
+            MB = ft->mem[AB & 0777];
+            return 0;
+        }
         if (!page_lookup(AB, flag, &addr, 0, cur_context, fetch))
             return 1;
         if (addr >= MEMSIZE) {
@@ -2958,7 +3108,22 @@ int Mem_write(int flag, int cur_context) {
         }
         set_reg(AB, MB);
     } else {
+        FAST_TLB *ft;
 write:
+        ft = &fast_tlb[(FLAGS & USER) != 0][(RMASK & AB) >> 9];
+        /* Try host TLB first */
+        if (ft->tag == FTLB_TAG(AB) && (ft->flags & FTLB_WRITE) && !flag &&
+            xct_flag == 0 && !page_fault && (FLAGS & PUBLIC) == 0) {
+            if (ft->last_page >= 0) {          /* Mapped, account for TLB */
+                sim_interval--;
+                last_page = ft->last_page;
+            }
+            if (sim_brk_summ && sim_brk_test(AB, SWMASK('W')))
+                watch_stop = 1;
+            sim_interval--;
+            ft->mem[AB & 0777] = MB;
+            return 0;
+        }
         if (!page_lookup(AB, flag, &addr, 1, cur_context, 0))
             return 1;
         if (addr >= MEMSIZE) {
@@ -3994,6 +4159,11 @@ if (sim_step != 0) {
 if ((reason = build_dev_tab ()) != SCPE_OK)            /* build, chk dib_tab */
     return reason;
 
+#if KI | KL
+/* Memory or paging state may have been changed from the console */
+fast_tlb_flush();
+#endif
+
 
 /* Main instruction fetch/decode loop: check clock queue, intr, trap, bkpt */
    f_load_pc = 1;
@@ -4679,6 +4849,7 @@ unasign:
                   dbr2 = MB;
                   for (f = 0; f < 512; f++)
                       u_tlb[f] = 0;
+                  fast_tlb_flush();
                   break;
               }
               goto unasign;
@@ -10126,6 +10297,7 @@ fm_sel = small_user = user_addr_cmp = page_enable = 0;
 fm_sel = prev_ctx = user_addr_cmp = page_enable = t20_page = 0;
 sect = cur_sect = pc_sect = 0;
 #endif
+fast_tlb_flush();
 #endif
 #if BBN
 exec_map = 0;
@@ -327,6 +327,7 @@ t_stat cpu_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw);
 t_stat cpu_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw);
 t_stat cpu_reset (DEVICE *dptr);
 t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs);
+void *cpu_mem_region (DEVICE *dptr, UNIT *uptr);
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_hist (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_show_virt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
@@ -693,6 +694,13 @@ t_value pdp11_pc_value (void)
 return (t_value)PC;
 }
 
+const char *pdp11_pc_mode (void)
+{
+static const char *modes[] = {"Kernel", "Supervisor", "Illegal", "User"};
+
+return modes[cm & 3];
+}
+
 t_stat sim_instr (void)
 {
 int abortval, i;
@@ -700,6 +708,7 @@ volatile int32 trapea;                                  /* used by setjmp */
 InstHistory *hst_ent = NULL;
 
 sim_vm_pc_value = &pdp11_pc_value;
+sim_vm_pc_mode = &pdp11_pc_mode;
 
 /* Restore register state
 
@@ -3375,6 +3384,7 @@ if (M == NULL) {                    /* First time init */
                     SWMASK ('W')|SWMASK ('X');
     sim_brk_type_desc = cpu_breakpoints;
     sim_vm_is_subroutine_call = &cpu_is_pc_a_subroutine_call;
+    sim_vm_mem_region = &cpu_mem_region;
     sim_clock_precalibrate_commands = pdp11_clock_precalibrate_commands;
     auto_config(NULL, 0);           /* do an initial auto configure */
     }
@@ -3496,6 +3506,19 @@ if (addr < IOPAGEBASE)
 return iopageW ((int32) val, addr, WRITEC);
 }
 
+/* Memory region for SAVE and RESTORE */
+
+void *cpu_mem_region (DEVICE *dptr, UNIT *uptr)
+{
+#if defined (UC15)
+return NULL;                                            /* memory is in the PDP-15 */
+#else
+if (dptr != &cpu_dev)
+    return NULL;
+return (void *) M;
+#endif
+}
+
 /* Set R, SP register display addresses */
 
 void set_r_display (int32 rs, int32 cm)
@@ -249,11 +249,40 @@ return uba_last;
      trimmed to 18b.
    - In a Qbus configuration, the map is always disabled.
      Device addresses are trimmed to 22b.
+
+   Transfers to and from memory are done in runs: the map is consulted
+   once per map page and the run is copied with memcpy.  Memory is an
+   array of host order words, so word transfers are always copied in
+   bulk; byte transfers are copied in bulk only on little endian hosts.
+   NXM is reported at the same byte (word) as an element by element
+   transfer would report it.
 */
 
+#if defined (UC15)
+#define MAP_BULK_W      FALSE                           /* UC15 memory is shared */
+#define MAP_BULK_B      FALSE
+#else
+#define MAP_BULK_W      TRUE                            /* words in bulk */
+#define MAP_BULK_B      sim_end                         /* bytes if little endian */
+#endif
+
+/* Length of the run starting at bus address ba (mapped to memory address
+   ma) which stays within one map page and within memory */
+
+static uint32 Map_Run (uint32 ba, uint32 ma, uint32 lim)
+{
+uint32 run = UBM_PAGSIZE - UBM_GETOFF (ba);             /* rest of map page */
+
+if (run > (lim - ba))                                   /* past end of xfer? */
+    run = lim - ba;
+if (run > (MEMSIZE - ma))                               /* past end of mem? */
+    run = (uint32)(MEMSIZE - ma);
+return run;
+}
+
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
 {
-uint32 alim, lim, ma;
+uint32 alim, lim, ma, run;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -272,6 +301,19 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = ba & BUSMASK;                                      /* trim address */
 lim = ba + bc;
 if (cpu_bme) {                                          /* map enabled? */
+    if (MAP_BULK_B) {
+        while (ba < lim) {                              /* by map pages */
+            ma = Map_Addr (ba);                         /* map addr */
+            if (!ADDR_IS_MEM (ma))                      /* NXM? err */
+                return (lim - ba);
+            run = Map_Run (ba, ma, lim);
+            memcpy (buf, ((uint8 *) M) + ma, run);      /* get bytes */
+            uba_last = ma + run - 1;
+            buf = buf + run;
+            ba = ba + run;
+            }
+        return 0;
+        }
     for ( ; ba < lim; ba++) {                           /* by bytes */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
@@ -286,8 +328,12 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba++) {                          /* by bytes */
-        *buf++ = (uint8) RdMemB (ba);                   /* get byte */
+    if (MAP_BULK_B)
+        memcpy (buf, ((uint8 *) M) + ba, alim - ba);    /* get bytes */
+    else {
+        for ( ; ba < alim; ba++) {                      /* by bytes */
+            *buf++ = (uint8) RdMemB (ba);               /* get byte */
+            }
         }
     return (lim - alim);
     }
@@ -295,7 +341,7 @@ else {                                                  /* physical */
 
 int32 Map_ReadW (uint32 ba, int32 bc, uint16 *buf)
 {
-uint32 alim, lim, ma;
+uint32 alim, lim, ma, run;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -315,6 +361,19 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = (ba & BUSMASK) & ~01;                              /* trim, align addr */
 lim = ba + (bc & ~01);
 if (cpu_bme) {                                          /* map enabled? */
+    if (MAP_BULK_W) {
+        while (ba < lim) {                              /* by map pages */
+            ma = Map_Addr (ba);                         /* map addr */
+            if (!ADDR_IS_MEM (ma))                      /* NXM? err */
+                return (lim - ba);
+            run = Map_Run (ba, ma, lim);
+            memcpy (buf, M + (ma >> 1), run);           /* get words */
+            uba_last = ma + run - 2;
+            buf = buf + (run >> 1);
+            ba = ba + run;
+            }
+        return 0;
+        }
     for (; ba < lim; ba = ba + 2) {                     /* by words */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
@@ -329,8 +388,12 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba = ba + 2) {                   /* by words */
-        *buf++ = (uint16) RdMemW (ba);
+    if (MAP_BULK_W)
+        memcpy (buf, M + (ba >> 1), alim - ba);         /* get words */
+    else {
+        for ( ; ba < alim; ba = ba + 2) {               /* by words */
+            *buf++ = (uint16) RdMemW (ba);
+            }
         }
     return (lim - alim);
     }
@@ -338,7 +401,7 @@ else {                                                  /* physical */
 
 int32 Map_WriteB (uint32 ba, int32 bc, const uint8 *buf)
 {
-uint32 alim, lim, ma;
+uint32 alim, lim, ma, run;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -354,6 +417,19 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = ba & BUSMASK;                                      /* trim address */
 lim = ba + bc;
 if (cpu_bme) {                                          /* map enabled? */
+    if (MAP_BULK_B) {
+        while (ba < lim) {                              /* by map pages */
+            ma = Map_Addr (ba);                         /* map addr */
+            if (!ADDR_IS_MEM (ma))                      /* NXM? err */
+                return (lim - ba);
+            run = Map_Run (ba, ma, lim);
+            memcpy (((uint8 *) M) + ma, buf, run);      /* put bytes */
+            uba_last = ma + run - 1;
+            buf = buf + run;
+            ba = ba + run;
+            }
+        return 0;
+        }
     for ( ; ba < lim; ba++) {                           /* by bytes */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
@@ -368,8 +444,12 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba++) {                          /* by bytes */
-        WrMemB (ba, ((uint16) *buf++));
+    if (MAP_BULK_B)
+        memcpy (((uint8 *) M) + ba, buf, alim - ba);    /* put bytes */
+    else {
+        for ( ; ba < alim; ba++) {                      /* by bytes */
+            WrMemB (ba, ((uint16) *buf++));
+            }
         }
     return (lim - alim);
     }
@@ -377,7 +457,7 @@ else {                                                  /* physical */
 
 int32 Map_WriteW (uint32 ba, int32 bc, const uint16 *buf)
 {
-uint32 alim, lim, ma;
+uint32 alim, lim, ma, run;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -395,6 +475,19 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = (ba & BUSMASK) & ~01;                              /* trim, align addr */
 lim = ba + (bc & ~01);
 if (cpu_bme) {                                          /* map enabled? */
+    if (MAP_BULK_W) {
+        while (ba < lim) {                              /* by map pages */
+            ma = Map_Addr (ba);                         /* map addr */
+            if (!ADDR_IS_MEM (ma))                      /* NXM? err */
+                return (lim - ba);
+            run = Map_Run (ba, ma, lim);
+            memcpy (M + (ma >> 1), buf, run);           /* put words */
+            uba_last = ma + run - 2;
+            buf = buf + (run >> 1);
+            ba = ba + run;
+            }
+        return 0;
+        }
     for (; ba < lim; ba = ba + 2) {                     /* by words */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
@@ -409,8 +502,12 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba = ba + 2) {                   /* by words */
-        WrMemW (ba, *buf++);
+    if (MAP_BULK_W)
+        memcpy (M + (ba >> 1), buf, alim - ba);         /* put words */
+    else {
+        for ( ; ba < alim; ba = ba + 2) {               /* by words */
+            WrMemW (ba, *buf++);
+            }
         }
     return (lim - alim);
     }
@@ -734,6 +734,8 @@ t_stat xq_show_stats (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
   fprintf(st, fmt, "Recv Overrun:",xq->var->stats.recv_overrun);
   fprintf(st, fmt, "ReadQ count:", xq->var->ReadQ.count);
   fprintf(st, fmt, "ReadQ high:",  xq->var->ReadQ.high);
+  fprintf(st, fmt, "ReadQ big:",   xq->var->ReadQ.oversize.gets);
+  fprintf(st, fmt, "ReadQ big max:", xq->var->ReadQ.oversize.high);
   eth_show_dev(st, xq->var->etherface);
   return SCPE_OK;
 }
@@ -136,6 +136,7 @@ typedef struct {
     uint8 *buf;                                         /* unit buffer */
     int32 buf_ptr;                                      /* current buffer pointer */
     int32 buf_len;                                      /* current buffer length */
+    t_bool dma_act;                                     /* DMA requested */
     SCSI_BUS bus;                                       /* SCSI bus state */
     } CTLR;
 
@@ -150,6 +151,7 @@ void rz_setint (CTLR *rz, uint32 flags);
 void rz_clrint (CTLR *rz);
 void rz_sw_reset (CTLR *rz);
 void rz_ack (CTLR *rz);
+void rz_ready (SCSI_BUS *bus);
 int32 rz_parity (int32 val, int32 odd);
 const char *rz_description (DEVICE *dptr);
 
@@ -536,8 +538,10 @@ switch (rg) {
                 rz_setint (rz, STS_BSYERR);             /* no, error */
                 }
             }
-        if ((data & MODE_DMA) == 0)                     /* clearing DMA */
+        if ((data & MODE_DMA) == 0) {                   /* clearing DMA */
             rz->status = rz->status & ~STS_DMAEND;
+            rz->dma_act = FALSE;
+            }
         rz->mode = data;
         if (((rz->icmd & ICMD_BSY) == 0) && (rz->bus.target < 0))
             rz->mode = rz->mode & ~MODE_DMA;            /* DMA can only be set when BSY is set */
@@ -556,6 +560,7 @@ switch (rg) {
 
     case 5:                                             /* SCS_DMA_SEND */
         uptr = dptr->units + rz->bus.target;
+        rz->dma_act = TRUE;
         sim_activate (uptr, 50);
         break;
 
@@ -564,6 +569,7 @@ switch (rg) {
 
     case 7:                                             /* SCS_DMA_IRCV */
         uptr = dptr->units + rz->bus.target;
+        rz->dma_act = TRUE;
         sim_activate (uptr, 50);
         break;
 
@@ -663,6 +669,11 @@ DEVICE *dptr = rz_devmap[uptr->cnum];
 int32 dma_len;
 uint32 old_phase;
 
+if (!rz->dma_act)                                       /* no DMA requested? */
+    return SCPE_OK;
+if (scsi_busy (&rz->bus))                               /* target busy? */
+    return SCPE_OK;                                     /* wait for rz_ready */
+rz->dma_act = FALSE;
 old_phase = rz->bus.phase;
 if (rz->dcount == 0)
     dma_len = DMA_SIZE;                                 /* full buffer */
@@ -701,6 +712,27 @@ rz_update_status (rz);
 return SCPE_OK;
 }
 
+/* Target has finished a transfer and is ready to continue */
+
+void rz_ready (SCSI_BUS *bus)
+{
+CTLR *rz;
+DEVICE *dptr;
+int32 ctlr;
+
+for (ctlr = 0; ctlr < RZ_NUMCT; ctlr++) {
+    rz = rz_ctxmap[ctlr];
+    if (&rz->bus == bus)
+        break;
+    }
+if (ctlr == RZ_NUMCT)                                   /* not found??? */
+    return;
+dptr = rz_devmap[ctlr];
+if (rz->dma_act)                                        /* DMA waiting? */
+    sim_activate (dptr->units + bus->target, 50);
+rz_update_status (rz);
+}
+
 t_stat rz_isvc (UNIT *uptr)
 {
 CTLR *rz = rz_ctxmap[uptr->cnum];
@@ -763,6 +795,7 @@ rz->daddr = 0;
 rz->daddr_low = FALSE;
 rz->ddir = 0;
 rz->buf_ptr = 0;
+rz->dma_act = FALSE;
 scsi_reset (&rz->bus);
 }
 
@@ -789,6 +822,7 @@ r = scsi_init (&rz->bus, DMA_SIZE);                     /* init SCSI bus */
 if (r != SCPE_OK)
     return r;
 rz->bus.dptr = dptr;                                    /* set bus device */
+rz->bus.ready = &rz_ready;                              /* set ready routine */
 for (i = 0; i < (RZ_NUMDR + 1); i++) {                  /* init units */
     uptr = dptr->units + i;
     uptr->cnum = ctlr;                                  /* set ctrl index */
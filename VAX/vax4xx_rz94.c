@@ -114,6 +114,7 @@ t_stat rz_reset (DEVICE *dptr);
 void rz_sw_reset (void);
 t_stat rz_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr);
 void rz_cmd (uint32 cmd);
+void rz_ready (SCSI_BUS *bus);
 t_stat rz_set_type (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat rz_show_type (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 const char *rz_description (DEVICE *dptr);
@@ -406,11 +407,23 @@ SET_IRQL;
 
 t_stat rz_svc (UNIT *uptr)
 {
+if (uptr != &rz_unit[8])                                /* target unit I/O event? */
+    return SCPE_OK;
+if (scsi_busy (&rz_bus))                                /* target busy? */
+    return SCPE_OK;                                     /* wait for rz_ready */
 rz_stat |= STS_INT;
 SET_INT (SC);
 return SCPE_OK;
 }
 
+/* Target has finished a transfer and is requesting service */
+
+void rz_ready (SCSI_BUS *bus)
+{
+rz_int |= INT_BUSSV;
+sim_activate (&rz_unit[8], 50);
+}
+
 void rz_setint (uint32 flag)
 {
 rz_int |= flag;
@@ -670,6 +683,8 @@ switch (cmd & 0x7f) {
                 if (cmd & 0x80) {                       /* DMA */
                     while ((rz_bus.phase == old_phase) && (rz_txc != 0)) {
                         txc = scsi_read (&rz_bus, &rz_buf[0], rz_txc);
+                        if (txc == 0)                   /* no data available? */
+                            break;
                         RZ_WRITEB (rz_dma, txc, &rz_buf[0]);
                         rz_txc -= txc;
                         }
@@ -798,6 +813,7 @@ r = scsi_init (&rz_bus, RZ_MAXFR);                      /* init SCSI bus */
 if (r != SCPE_OK)
     return r;
 rz_bus.dptr = dptr;                                     /* set bus device */
+rz_bus.ready = &rz_ready;                               /* set ready routine */
 for (i = 0; i < 8; i++) {
     uptr = dptr->units + i;
     if (i == RZ_SCSI_ID)                                /* initiator ID? */
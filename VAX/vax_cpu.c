@@ -311,6 +311,7 @@ extern int32 sys_model;
 
 t_stat cpu_reset (DEVICE *dptr);
 t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs);
+const char *cpu_pc_mode (void);
 t_stat cpu_ex (t_value *vptr, t_addr exta, UNIT *uptr, int32 sw);
 t_stat cpu_dep (t_value val, t_addr exta, UNIT *uptr, int32 sw);
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
@@ -322,6 +323,7 @@ t_stat cpu_show_idle (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_set_instruction_set (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_instruction_set (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 const char *cpu_description (DEVICE *dptr);
+void *cpu_mem_region (DEVICE *dptr, UNIT *uptr);
 int32 cpu_get_vsw (int32 sw);
 static SIM_INLINE int32 get_istr (int32 lnt, int32 acc);
 int32 ReadOcta (int32 va, int32 *opnd, int32 j, int32 acc);
@@ -1555,7 +1557,7 @@ for ( ;; ) {
 /* Optionally record instruction history */
 
     if (hst_lnt) {
-        int32 lim;
+        int32 lim, pa, t;
         t_value wd;
         InstHistory *h = &hst[hst_p];
 
@@ -1567,12 +1569,21 @@ for ( ;; ) {
         lim = PC - fault_PC;
         if ((uint32) lim > INST_SIZE)
             lim = INST_SIZE;
-        for (i = 0; i < lim; i++) {
-            if ((cpu_ex (&wd, fault_PC + i, &cpu_unit, SWMASK ('V'))) == SCPE_OK)
-                h->inst[i] = (uint8) wd;
-            else {
-                h->inst[0] = h->inst[1] = 0xFF;
-                break;
+        if ((lim > 0) &&                                /* in one page of memory? */
+            ((VA_GETOFF (fault_PC) + lim) <= (VA_M_OFF + 1)) &&
+            ((pa = Test (fault_PC, RD, &t)) >= 0) &&
+            ADDR_IS_MEM (pa + lim - 1)) {
+            for (i = 0; i < lim; i++, pa++)             /* copy from memory */
+                h->inst[i] = (uint8) (M[pa >> 2] >> ((pa & 3) << 3));
+            }
+        else {
+            for (i = 0; i < lim; i++) {
+                if ((cpu_ex (&wd, fault_PC + i, &cpu_unit, SWMASK ('V'))) == SCPE_OK)
+                    h->inst[i] = (uint8) wd;
+                else {
+                    h->inst[0] = h->inst[1] = 0xFF;
+                    break;
+                    }
                 }
             }
         if (hst_switches & SWMASK('T'))
@@ -3321,6 +3332,8 @@ if (M == NULL) {                        /* first time init? */
     vax_init();
     sim_brk_types = sim_brk_dflt = SWMASK ('E');
     sim_vm_is_subroutine_call = cpu_is_pc_a_subroutine_call;
+    sim_vm_pc_mode = cpu_pc_mode;
+    sim_vm_mem_region = cpu_mem_region;
     sim_clock_precalibrate_commands = vax_clock_precalibrate_commands;
     sim_vm_initial_ips = SIM_INITIAL_IPS;
     pcq_r = find_reg ("PCQ", NULL, dptr);
@@ -3347,6 +3360,17 @@ static const char *cpu_next_caveats =
 "locations due to a trap, stack unwind or any other reason, instruction\n"
 "execution will continue until some other reason causes execution to stop.\n";
 
+/* Processor mode for the PC profiler */
+
+const char *cpu_pc_mode (void)
+{
+static const char *modes[] = {"Kernel", "Executive", "Supervisor", "User"};
+
+if (PSL & PSL_IS)
+    return "Interrupt";
+return modes[PSL_GETCUR (PSL)];
+}
+
 t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs)
 {
 #define MAX_SUB_RETURN_SKIP 9
@@ -3427,6 +3451,16 @@ if (ADDR_IS_ROM (addr)) {
 return SCPE_NXM;
 }
 
+/* Memory region for SAVE and RESTORE - byte addressed, so only when
+   memory is in VAX byte order (little endian host) */
+
+void *cpu_mem_region (DEVICE *dptr, UNIT *uptr)
+{
+if ((dptr != &cpu_dev) || !sim_end)
+    return NULL;
+return (void *) M;
+}
+
 /* Memory allocation */
 
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
@@ -781,6 +781,45 @@ return 0;                                               /* q can't be empty */
 #define MVC_M_STATE     3
 #define MVC_V_CC        2
 
+/* Map a string operand byte for the page chunked fast paths
+
+   The byte at va is translated as Read or Write would, but without
+   faulting.  If it is in main memory, returns a host pointer to it and
+   sets *lnt to the bytes left in its page, so each page is translated
+   once.  Returns NULL on a translation error, for I/O space, or on a
+   big endian host; the caller then drops back to its element at a time
+   loop, which takes any fault at the same reference, with the same
+   registers, as it always has.
+*/
+
+static uint8 *str_map (uint32 va, int32 acc, int32 *lnt)
+{
+int32 vpn, tbi, stat = PR_OK;
+uint32 pa;
+TLBENT xpte;
+
+if (!sim_end)                                           /* M is lw, need LE */
+    return NULL;
+mchk_va = va;
+if (mapen) {                                            /* mapping on? */
+    vpn = VA_GETVPN (va);
+    tbi = VA_GETTBI (vpn);
+    xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
+    if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
+        ((acc & TLB_WACC) && ((xpte.pte & TLB_M) == 0))) {
+        xpte = fill (va, L_BYTE, acc, &stat);           /* fill if needed */
+        if (stat != PR_OK)                              /* error? no fault */
+            return NULL;
+        }
+    pa = (xpte.pte & TLB_PFN) | VA_GETOFF (va);         /* get phys addr */
+    }
+else pa = va & PAMASK;
+if (!ADDR_IS_MEM (pa))                                  /* I/O space? */
+    return NULL;
+*lnt = VA_PAGSIZE - VA_GETOFF (va);                     /* bytes left in page */
+return ((uint8 *) M) + pa;
+}
+
 /* MOVC3, MOVC5
 
    if PSL<fpd> = 0 and MOVC3,
@@ -808,6 +847,8 @@ int32 op_movc (int32 *opnd, int32 movc5, int32 acc)
 {
 int32 i, cc, fill, wd;
 int32 j, lnt, mlnt[3];
+int32 sl, dl;
+uint8 *sp, *dp;
 static const int32 looplnt[3] = { L_BYTE, L_LONG, L_BYTE };
 
 if (PSL & PSL_FPD) {                                    /* FPD set? */
@@ -859,6 +900,27 @@ else {
 switch (R[5] & MVC_M_STATE) {                           /* case on state */
 
     case MVC_FRWD:                                      /* move forward */
+        while (R[2] > 0) {                              /* page chunks */
+            if (((sp = str_map (R[1], RA, &sl)) == NULL) ||
+                ((dp = str_map (R[3], WA, &dl)) == NULL))
+                break;                                  /* use loop */
+            lnt = (sl < dl)? sl: dl;
+            if (lnt > R[2])
+                lnt = R[2];
+            j = (R[3] + lnt) & 03;                      /* end within a lw? */
+            if ((lnt > ((4 - R[3]) & 03)) && (j != 0) && ((R[2] - lnt + j) >= 4))
+                lnt = lnt - j;                          /* end at lw, as loop */
+            if (lnt == 0) {                             /* lw crosses src page */
+                wd = Read (R[1], L_LONG, RA);           /* move it as loop does */
+                Write (R[3], wd, L_LONG, WA);
+                lnt = L_LONG;
+                }
+            else memmove (dp, sp, lnt);
+            R[1] = R[1] + lnt;                          /* inc src addr */
+            R[3] = R[3] + lnt;                          /* inc dst addr */
+            R[2] = R[2] - lnt;                          /* dec move lnt */
+            extra_bytes = extra_bytes + (lnt >> 2);
+            }
         mlnt[0] = (4 - R[3]) & 3;                       /* length to align */
         if (mlnt[0] > R[2])                             /* cant exceed total */
             mlnt[0] = R[2];
@@ -877,6 +939,29 @@ switch (R[5] & MVC_M_STATE) {                           /* case on state */
         goto FILL;                                      /* check for fill */
 
     case MVC_BACK:                                      /* move backward */
+        while (R[2] > 0) {                              /* page chunks */
+            if (((sp = str_map (R[1] - 1, RA, &sl)) == NULL) ||
+                ((dp = str_map (R[3] - 1, WA, &dl)) == NULL))
+                break;                                  /* use loop */
+            sl = VA_PAGSIZE - sl + 1;                   /* bytes below, incl */
+            dl = VA_PAGSIZE - dl + 1;
+            lnt = (sl < dl)? sl: dl;
+            if (lnt > R[2])
+                lnt = R[2];
+            j = (R[3] - lnt) & 03;                      /* end within a lw? */
+            if ((lnt > (R[3] & 03)) && (j != 0) && ((R[2] - lnt) >= j))
+                lnt = lnt - (4 - j);                    /* end at lw, as loop */
+            if (lnt == 0) {                             /* lw crosses src page */
+                wd = Read (R[1] - L_LONG, L_LONG, RA);  /* move it as loop does */
+                Write (R[3] - L_LONG, wd, L_LONG, WA);
+                lnt = L_LONG;
+                }
+            else memmove (dp - (lnt - 1), sp - (lnt - 1), lnt);
+            R[1] = R[1] - lnt;                          /* dec src addr */
+            R[3] = R[3] - lnt;                          /* dec dst addr */
+            R[2] = R[2] - lnt;                          /* dec move lnt */
+            extra_bytes = extra_bytes + (lnt >> 2);
+            }
         mlnt[0] = R[3] & 03;                            /* length to align */
         if (mlnt[0] > R[2])                             /* cant exceed total */
             mlnt[0] = R[2];
@@ -900,6 +985,15 @@ switch (R[5] & MVC_M_STATE) {                           /* case on state */
         if (R[4] <= 0)                                  /* any fill? */
             break;
         R[5] = R[5] | MVC_FILL;                         /* set state */
+        while (R[4] > 0) {                              /* page chunks */
+            if ((dp = str_map (R[3], WA, &dl)) == NULL)
+                break;                                  /* use loop */
+            lnt = (dl < R[4])? dl: R[4];
+            memset (dp, fill & BMASK, lnt);
+            R[3] = R[3] + lnt;                          /* inc dst addr */
+            R[4] = R[4] - lnt;                          /* dec fill lnt */
+            extra_bytes = extra_bytes + (lnt >> 2);
+            }
         mlnt[0] = (4 - R[3]) & 3;                       /* length to align */
         if (mlnt[0] > R[4])                             /* cant exceed total */
             mlnt[0] = R[4];
@@ -953,6 +1047,8 @@ return cc;
 int32 op_cmpc (int32 *opnd, int32 cmpc5, int32 acc)
 {
 int32 cc, s1, s2, fill;
+int32 i, n, l;
+uint8 *p1, *p2;
 
 if (PSL & PSL_FPD) {                                    /* FPD set? */
     SETPC (fault_PC + STR_GETDPC (R[0]));               /* reset PC */
@@ -974,6 +1070,43 @@ else {
     PSL = PSL | PSL_FPD;
     }
 R[2] = R[2] & STR_LNMASK;                               /* mask src2len */
+while (((R[0] | R[2]) & STR_LNMASK) != 0) {             /* page chunks */
+    n = R[0] & STR_LNMASK;                              /* shorter of the */
+    if ((n == 0) || ((R[2] != 0) && (R[2] < n)))        /* remaining strings */
+        n = R[2];
+    p1 = p2 = NULL;
+    if (R[0] & STR_LNMASK) {                            /* src1? map */
+        if ((p1 = str_map (R[1], RA, &l)) == NULL)
+            break;                                      /* use loop */
+        if (l < n)
+            n = l;
+        }
+    if (R[2]) {                                         /* src2? map */
+        if ((p2 = str_map (R[3], RA, &l)) == NULL)
+            break;
+        if (l < n)
+            n = l;
+        }
+    if (p1 && p2) {                                     /* both, compare */
+        if (memcmp (p1, p2, n) == 0)
+            i = n;
+        else for (i = 0; p1[i] == p2[i]; i++) ;
+        }
+    else if (p1)                                        /* src1 vs fill */
+        for (i = 0; (i < n) && (p1[i] == (fill & BMASK)); i++) ;
+    else for (i = 0; (i < n) && (p2[i] == (fill & BMASK)); i++) ;
+    if (p1) {                                           /* skip equal bytes */
+        R[0] = (R[0] & ~STR_LNMASK) | ((R[0] - i) & STR_LNMASK);
+        R[1] = R[1] + i;
+        }
+    if (p2) {
+        R[2] = (R[2] - i) & STR_LNMASK;
+        R[3] = R[3] + i;
+        }
+    extra_bytes = extra_bytes + i;
+    if (i < n)                                          /* differ? loop sets cc */
+        break;
+    }
 for (s1 = s2 = 0; ((R[0] | R[2]) & STR_LNMASK) != 0; extra_bytes++) {
     if (R[0] & STR_LNMASK)                              /* src1? read */
         s1 = Read (R[1], L_BYTE, RA);
@@ -1013,6 +1146,8 @@ return cc;
 int32 op_locskp (int32 *opnd, int32 skpc, int32 acc)
 {
 int32 c, match;
+int32 i, n;
+uint8 *p, *q;
 
 if (PSL & PSL_FPD) {                                    /* FPD set? */
     SETPC (fault_PC + STR_GETDPC (R[0]));               /* reset PC */
@@ -1024,6 +1159,23 @@ else {
     R[1] = opnd[2];                                     /* src addr */
     PSL = PSL | PSL_FPD;
     }
+while ((R[0] & STR_LNMASK) != 0) {                      /* page chunks */
+    if ((p = str_map (R[1], RA, &n)) == NULL)
+        break;                                          /* use loop */
+    if (n > (R[0] & STR_LNMASK))
+        n = R[0] & STR_LNMASK;
+    if (skpc)                                           /* skip matches */
+        for (i = 0; (i < n) && (p[i] == (match & BMASK)); i++) ;
+    else {                                              /* find match */
+        q = (uint8 *) memchr (p, match & BMASK, n);
+        i = q? (int32) (q - p): n;
+        }
+    R[0] = (R[0] & ~STR_LNMASK) | ((R[0] - i) & STR_LNMASK);
+    R[1] = R[1] + i;
+    extra_bytes = extra_bytes + i;
+    if (i < n)                                          /* found? loop ends */
+        break;
+    }
 for ( ; (R[0] & STR_LNMASK) != 0; extra_bytes++ ) {    /* loop thru string */
     c = Read (R[1], L_BYTE, RA);                        /* get src byte */
     if ((c == match) ^ skpc)                            /* match & locc? */
@@ -1053,6 +1205,8 @@ return (R[0]? 0: CC_Z);                                 /* set cc's */
 int32 op_scnspn (int32 *opnd, int32 spanc, int32 acc)
 {
 int32 c, t, mask;
+int32 i, n, l;
+uint8 *p, *tbl = NULL;
 
 if (PSL & PSL_FPD) {                                    /* FPD set? */
     SETPC (fault_PC + STR_GETDPC (R[0]));               /* reset PC */
@@ -1065,6 +1219,25 @@ else {
     R[0] = STR_PACK (mask, opnd[0]);                    /* srclen + FPD data */
     PSL = PSL | PSL_FPD;
     }
+while ((R[0] & STR_LNMASK) != 0) {                      /* page chunks */
+    if ((p = str_map (R[1], RA, &n)) == NULL)
+        break;                                          /* use loop */
+    if (tbl == NULL) {                                  /* table not mapped? */
+        if ((VA_GETOFF (R[3]) + 256) > VA_PAGSIZE)      /* crosses page? */
+            break;
+        if ((tbl = str_map (R[3] + p[0], RA, &l)) == NULL)
+            break;
+        tbl = tbl - p[0];                               /* table base */
+        }
+    if (n > (R[0] & STR_LNMASK))
+        n = R[0] & STR_LNMASK;
+    for (i = 0; (i < n) && ((((tbl[p[i]] & mask) != 0) ^ spanc) == 0); i++) ;
+    R[0] = (R[0] & ~STR_LNMASK) | ((R[0] - i) & STR_LNMASK);
+    R[1] = R[1] + i;
+    extra_bytes = extra_bytes + i;
+    if (i < n)                                          /* found? loop ends */
+        break;
+    }
 for ( ; (R[0] & STR_LNMASK) != 0; extra_bytes++ ) {    /* loop thru string */
     c = Read (R[1], L_BYTE, RA);                        /* get byte */
     t = Read (R[3] + c, L_BYTE, RA);                    /* get table ent */
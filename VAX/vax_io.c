@@ -758,13 +758,41 @@ return SCPE_OK;
    Map_ReadW    -       fetch word buffer from memory
    Map_WriteB   -       store byte buffer into memory
    Map_WriteW   -       store word buffer into memory
+
+   On a little endian host memory holds the VAX byte order, so buffers
+   are copied with memcpy a map page at a time, at any alignment.  The
+   map is consulted at the same addresses as an element by element
+   transfer, so NXM and invalid map entries are reported identically.
 */
 
+/* Copy a buffer between Qbus space and memory, a map page at a time */
+
+static int32 qba_map_bulk (uint32 ba, int32 bc, uint8 *buf, t_bool wr)
+{
+int32 i, run;
+uint32 ma;
+
+for (i = 0; i < bc; i = i + run) {                      /* by map pages */
+    if (!qba_map_addr (ba + i, &ma))                    /* inv or NXM? */
+        return (bc - i);
+    run = VA_PAGSIZE - VA_GETOFF (ma);                  /* rest of page */
+    if (run > (bc - i))
+        run = bc - i;
+    if (wr)
+        memcpy (((uint8 *) M) + ma, buf + i, run);
+    else
+        memcpy (buf + i, ((uint8 *) M) + ma, run);
+    }
+return 0;
+}
+
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
 {
 int32 i;
 uint32 ma, dat;
 
+if (sim_end)                                            /* little endian host? */
+    return qba_map_bulk (ba, bc, buf, FALSE);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i++, buf++) {              /* by bytes */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -799,6 +827,8 @@ uint32 ma,dat;
 
 ba = ba & ~01;
 bc = bc & ~01;
+if (sim_end)                                            /* little endian host? */
+    return qba_map_bulk (ba, bc, (uint8 *) buf, FALSE);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i = i + 2, buf++) {        /* by words */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -829,6 +859,8 @@ int32 Map_WriteB (uint32 ba, int32 bc, const uint8 *buf)
 int32 i;
 uint32 ma, dat;
 
+if (sim_end)                                            /* little endian host? */
+    return qba_map_bulk (ba, bc, (uint8 *) buf, TRUE);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i++, buf++) {              /* by bytes */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -863,6 +895,8 @@ uint32 ma, dat;
 
 ba = ba & ~01;
 bc = bc & ~01;
+if (sim_end)                                            /* little endian host? */
+    return qba_map_bulk (ba, bc, (uint8 *) buf, TRUE);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i = i + 2, buf++) {        /* by words */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
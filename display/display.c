@@ -322,59 +322,64 @@ static struct display displays[] = {
  */
 
 /*
- * Each point on the display is represented by a "struct point".  When
- * a point isn't dark (intensity > 0), it is linked into a circular,
- * doubly linked delta queue (a priority queue where "delay"
- * represents the time difference from the previous entry (if any) in
- * the queue.
+ * Each point on the display is represented by a "struct point" in a
+ * dense plane of xpixels*ypixels entries.  All points are aged
+ * refresh_rate times/second, each time moved to the next
+ * (logarithmically) lower intensity level, and every point which is
+ * not dark (ttl > 0) ages exactly refresh_interval DELAY_UNITs after it
+ * was last intensified or aged.
  *
- * All points are aged refresh_rate times/second, each time moved to the
- * next (logarithmically) lower intensity level.  When display_age() is
- * called, only the entries which have expired are processed.  Calling
- * display_age() often allows spreading out the workload.
+ * Since the period is the same for every point, a lit point always ages
+ * at the same phase (time modulo refresh_interval) as when it was last
+ * intensified.  Lit points are therefore kept in a timing wheel of
+ * refresh_interval slots, each holding a packed array of the
+ * coordinates of the points which age at that phase.  Aging a slot is a
+ * sequential sweep of its array; a point only moves to another slot
+ * when it is intensified again, and is dropped from its slot when it
+ * goes dark.  When display_age() is called, only the slots for the
+ * elapsed DELAY_UNITs are processed.  Calling display_age() often
+ * allows spreading out the workload.
  *
  * An alternative would be to have intensity levels represent linear
  * decreases in intensity, and have the decay time at each level change.
  * Inverting the decay function for a multi-component phosphor may be
  * tricky, and the two different colors would need different time tables.
- * Furthermore, it would require finding the correct location in the
- * queue when adding a point (currently only need to add points at end)
  */
 
 /*
- * 12 bytes/entry on 32-bit system when REFRESH_RATE > 15
- * (requires 3MB for 512x512 display).
+ * 8 bytes/entry (requires 2MB for 512x512 display).
  */
 
 typedef unsigned short delay_t;
 #define DELAY_T_MAX USHRT_MAX
 
 struct point {
-    struct point *next;         /* next entry in queue */
-    struct point *prev;         /* prev entry in queue */
-    delay_t delay;              /* delta T in DELAY_UNITs */
-    unsigned char ttl;          /* zero means off, not linked in */
+    unsigned int index;         /* position in slot's point array */
+    delay_t slot;               /* aging phase; valid when ttl != 0 */
+    unsigned char ttl;          /* zero means off, not in a slot */
     unsigned char level : 7;    /* intensity level */
     unsigned char color : 1;    /* for VR20 (two colors) */
 };
 
-static struct point *points;    /* allocated array of points */
-static struct point _head;
-#define head (&_head)
+/* a timing wheel slot: packed (Y<<16)|X of the points aging at this phase */
+struct slot {
+    unsigned int *xy;
+    unsigned int count;
+    unsigned int size;
+};
 
-/*
- * time span of all entries in queue
- * should never exceed refresh_interval
- * (should be possible to make this a delay_t)
- */
-static long queue_interval;
+static struct point *points;    /* allocated array of points */
+static struct slot *slots;      /* refresh_interval timing wheel slots */
+static int now_slot;            /* slot for the current time */
+static long lit_points;         /* total points in all slots */
 
 /* convert X,Y to a "struct point *" */
 #define P(X,Y) (points + (X) + ((Y)*(size_t)xpixels))
 
-/* convert "struct point *" to X and Y */
-#define X(P) (((P) - points) % xpixels)
-#define Y(P) (((P) - points) / xpixels)
+/* packed slot entries */
+#define XY(X,Y) ((((unsigned int)(Y)) << 16) | (unsigned int)(X))
+#define XY_X(XY) ((int)((XY) & 0xffff))
+#define XY_Y(XY) ((int)((XY) >> 16))
 
 static int initialized = 0;
 static void *device = NULL;  /* Current display device. */
@@ -426,45 +431,83 @@ display_lp_radius(int r)
 }
 
 /*
- * from display_age and display_point
- * since all points age at the same rate,
- * only adds points at end of list.
+ * from intensify: add a point to the slot for the current time,
+ * so that it next ages refresh_interval DELAY_UNITs from now.
  */
-static void
-queue_point(struct point *p)
+static int
+slot_point(struct point *p, int x, int y)
 {
-    int d;
+    struct slot *sp = &slots[now_slot];
 
-    d = refresh_interval - queue_interval;
-    queue_interval += d;
-    /* queue_interval should now be == refresh_interval */
+    if (sp->count == sp->size) {
+        unsigned int size = sp->size ? 2*sp->size : 64;
+        unsigned int *xy = (unsigned int *)realloc(sp->xy, size*sizeof(*xy));
 
-#ifdef PARANOIA
-    if (p->ttl == 0 || p->ttl > MAXTTL)
-    printf("queuing %d,%d level %d!\n", X(p), Y(p), p->level);
-    if (d > DELAY_T_MAX)
-    printf("queuing %d,%d delay %d!\n", X(p), Y(p), d);
-    if (queue_interval > DELAY_T_MAX)
-    printf("queue_interval (%d) > DELAY_T_MAX (%d)\n",
-           (int)queue_interval, DELAY_T_MAX);
-#endif /* PARANOIA defined */
+        if (!xy)
+            return 0;
+        sp->xy = xy;
+        sp->size = size;
+        }
+    p->slot = (delay_t)now_slot;
+    p->index = sp->count;
+    sp->xy[sp->count++] = XY(x, y);
+    ++lit_points;
+    return 1;
+}
 
-    p->next = head;
-    p->prev = head->prev;
+/*
+ * remove a point from its slot; the last entry in
+ * the slot's array takes its place.
+ */
+static void
+unslot_point(struct point *p)
+{
+    struct slot *sp = &slots[p->slot];
+    unsigned int xy = sp->xy[--sp->count];
 
-    head->prev->next = p;
-    head->prev = p;
+    if (p->index != sp->count) {
+        sp->xy[p->index] = xy;
+        P(XY_X(xy), XY_Y(xy))->index = p->index;
+        }
+    --lit_points;
+}
 
-    p->delay = d;
+/*
+ * age every point in a slot by one level, dropping
+ * those which have gone dark.
+ */
+static void
+age_slot(struct slot *sp)
+{
+    unsigned int i, xy;
+    struct point *p;
+
+    for (i = 0; i < sp->count; ) {
+        xy = sp->xy[i];
+        p = P(XY_X(xy), XY_Y(xy));
+#ifdef PARANOIA
+        if (p->ttl == 0)
+            printf("BUG: age %d,%d ttl zero\n", XY_X(xy), XY_Y(xy));
+#endif /* PARANOIA defined */
+        ws_display_point(XY_X(xy), XY_Y(xy), colors[p->color][p->level][--p->ttl]);
+        if (p->ttl == 0) {          /* turned it off; swap in the last entry */
+            xy = sp->xy[--sp->count];
+            sp->xy[i] = xy;
+            P(XY_X(xy), XY_Y(xy))->index = i;
+            --lit_points;
+            }
+        else
+            ++i;
+        }
 }
-
+
 /*
  * Return true if the display is blank, i.e. no active points in list.
  */
 int
 display_is_blank(void)
 {
-    return head->next == head;
+    return lit_points == 0;
 }
 
 /*
@@ -633,7 +676,6 @@ int
 display_age(int t,          /* simulated us since last call */
         int slowdown)       /* slowdown to simulated speed */
 {
-    struct point *p;
     static int elapsed = 0;
     static int refresh_elapsed = 0; /* in units of DELAY_UNIT bounded by refresh_interval */
     int changed;
@@ -659,52 +701,36 @@ display_age(int t,          /* simulated us since last call */
         refresh_elapsed = 0;
         }
 
-    while ((p = head->next) != head) {
-        int x, y;
-
-        /* look at oldest entry */
-        if (p->delay > t) {         /* further than our reach? */
-            p->delay -= t;          /* update head */
-            queue_interval -= t;    /* update span */
-            break;                  /* quit */
+    /* visit the slot for each elapsed DELAY_UNIT */
+    while (t > 0 && lit_points > 0) {
+        if (++now_slot == refresh_interval)
+            now_slot = 0;
+        --t;
+        if (slots[now_slot].count) {
+            age_slot(&slots[now_slot]);
+            changed = 1;
             }
-
-        x = X(p);
-        y = Y(p);
-#ifdef PARANOIA
-        if (p->ttl == 0)
-            printf("BUG: age %d,%d ttl zero\n", x, y);
-#endif /* PARANOIA defined */
-
-        /* dequeue point */
-        p->prev->next = p->next;
-        p->next->prev = p->prev;
-
-        t -= p->delay;              /* lessen our reach */
-        queue_interval -= p->delay; /* update queue span */
-
-        ws_display_point(x, y, colors[p->color][p->level][--p->ttl]);
-        changed = 1;
-
-        /* queue it back up, unless we just turned it off! */
-        if (p->ttl > 0)
-            queue_point(p);
         }
+    /* nothing lit; just keep track of the current phase */
+    now_slot = (int)((now_slot + (long)t) % refresh_interval);
     return changed;
 } /* display_age */
 
 /* here from window system */
 void
 display_repaint(void) {
+    struct slot *sp;
     struct point *p;
-    int x, y;
+    unsigned int i, xy;
     /*
-     * bottom to top, left to right.
+     * only lit points need painting
      */
-    for (p = points, y = 0; y < ypixels; y++)
-        for (x = 0; x < xpixels; p++, x++)
-            if (p->ttl)
-                ws_display_point(x, y, colors[p->color][p->level][p->ttl-1]);
+    for (sp = slots; sp < slots + refresh_interval; sp++)
+        for (i = 0; i < sp->count; i++) {
+            xy = sp->xy[i];
+            p = P(XY_X(xy), XY_Y(xy));
+            ws_display_point(XY_X(xy), XY_Y(xy), colors[p->color][p->level][p->ttl-1]);
+            }
     ws_sync();
 }
 
@@ -728,14 +754,9 @@ intensify(int x,            /* 0..xpixels */
                x, y, p->level, p->ttl, level);
 #endif /* LOUD defined */
 
-        /* unlink from delta queue */
-        p->prev->next = p->next;
-
-        if (p->next == head)
-            queue_interval -= p->delay;
-        else
-            p->next->delay += p->delay;
-        p->next->prev = p->prev;
+        /* remove from its slot, unless already aging at this phase */
+        if (p->slot != now_slot)
+            unslot_point(p);
         }
 
     bleed = 0;              /* no bleeding for now */
@@ -752,6 +773,15 @@ intensify(int x,            /* 0..xpixels */
      * this allows a dim beam to suck light out of
      * a recently drawn bright spot!!
      */
+    if (p->ttl == 0 || p->slot != now_slot) {
+        if (!slot_point(p, x, y)) {
+            if (p->ttl)     /* no room to keep it aging; put it out */
+                ws_display_point(x, y, ws_color_black());
+            p->ttl = 0;
+            return bleed;
+            }
+        }
+
     if (p->ttl != MAXTTL || p->level != level || p->color != color) {
         p->ttl = MAXTTL;
         p->level = level;
@@ -759,7 +789,6 @@ intensify(int x,            /* 0..xpixels */
         ws_display_point(x, y, colors[p->color][p->level][p->ttl-1]);
         }
 
-    queue_point(p);         /* put at end of list */
     return bleed;
 }
 
@@ -905,9 +934,6 @@ display_init(enum display_type type, int sf, void *dptr)
         goto failed;
         }
 
-    /* Initialize display list */
-    head->next = head->prev = head;
-
     display_type = type;
     scale = sf;
 
@@ -954,7 +980,7 @@ display_init(enum display_type type, int sf, void *dptr)
         refresh_interval = 1;
         }
 
-    /* point lifetime in DELAY_UNITs will not fit in p->delay field! */
+    /* timing wheel slot will not fit in p->slot field! */
     if (refresh_interval > DELAY_T_MAX) {
         /* increase DELAY_UNIT? */
         fprintf(stderr, "bad refresh_interval %d > DELAY_T_MAX %d\r\n",
@@ -978,6 +1004,14 @@ display_init(enum display_type type, int sf, void *dptr)
     if (!points)
         goto failed;
 
+    slots = (struct slot *)calloc((size_t)refresh_interval, sizeof(struct slot));
+    if (!slots) {
+        free (points);
+        goto failed;
+        }
+    now_slot = 0;
+    lit_points = 0;
+
     if (!ws_init(dp->name, xpixels, ypixels, ncolors, dptr))
         goto failed;
 
@@ -999,12 +1033,17 @@ display_init(enum display_type type, int sf, void *dptr)
 void
 display_close(void *dptr)
 {
+    int i;
+
     if (!initialized)
         return;
 
     if (device != dptr)
         return;
 
+    for (i = 0; i < refresh_interval; i++)
+        free (slots[i].xy);
+    free (slots);
     free (points);
     ws_shutdown();
 
@@ -36,6 +36,7 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <string.h>
+#include <time.h>
 #include "sim_frontpanel.h"
 #include <signal.h>
 
@@ -97,13 +98,26 @@ unsigned long long simulation_time;
 
 int update_display = 1;
 
+/* Achieved display callback rate */
+int callback_count = 0;
+int callbacks_per_second = 0;
+time_t callback_second = 0;
+
 int debug = 0;
 
 
 static void
 DisplayCallback (PANEL *panel, unsigned long long sim_time, void *context)
 {
+time_t now = time (NULL);
+
 simulation_time = sim_time;
+++callback_count;
+if (now != callback_second) {       /* new second? */
+    callbacks_per_second = callback_count;
+    callback_count = 0;
+    callback_second = now;
+    }
 update_display = 1;
 }
 
@@ -115,7 +129,7 @@ static const char *states[] = {"Halt", "Run "};
 
 buf1[sizeof(buf1)-1] = buf2[sizeof(buf2)-1] = buf3[sizeof(buf3)-1] = buf4[sizeof(buf4)-1] = 0;
 sprintf (buf1, "%4s PC: %08X   SP: %08X   AP: %08X   FP: %08X  @PC: %08X\n", states[sim_panel_get_state (panel)], PC, SP, AP, FP, atPC);
-sprintf (buf2, "PSL: %08X                               Instructions Executed: %lld\n", PSL, simulation_time);
+sprintf (buf2, "PSL: %08X        Updates/sec: %4d        Instructions Executed: %lld\n", PSL, callbacks_per_second, simulation_time);
 sprintf (buf3, "R0:%08X  R1:%08X  R2:%08X  R3:%08X   R4:%08X   R5:%08X\n", R0, R1, R2, R3, R4, R5);
 sprintf (buf4, "R6:%08X  R7:%08X  R8:%08X  R9:%08X  R10:%08X  R11:%08X\n", R6, R7, R8, R9, R10, R11);
 #if defined(_WIN32)
@@ -427,7 +441,7 @@ if (sim_panel_get_registers (panel, NULL)) {
     printf ("Error getting register data: %s\n", sim_panel_get_error());
     goto Done;
     }
-if (sim_panel_set_display_callback_interval (panel, &DisplayCallback, NULL, 200000)) {
+if (sim_panel_set_display_callback_interval (panel, &DisplayCallback, NULL, 1000000/60)) {
     printf ("Error setting automatic display callback: %s\n", sim_panel_get_error());
     goto Done;
     }
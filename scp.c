@@ -246,6 +246,10 @@
 #include <dlfcn.h>
 #endif
 
+#if defined(HAVE_ZLIB)                                  /* SAVE -Z support */
+#include <zlib.h>
+#endif
+
 #ifndef MAX
 #define MAX(a,b)  (((a) >= (b)) ? (a) : (b))
 #endif
@@ -271,6 +275,8 @@
 #define SRBSIZ          1024                            /* save/restore buffer */
 #define SIM_BRK_INILNT  4096                            /* bpt tbl length */
 #define SIM_BRK_ALLTYP  0xFFFFFFFB
+#define SIM_BRK_PG_V    4                               /* bpt filter page size (log2) */
+#define SIM_BRK_PG_N    4096                            /* bpt filter page slots */
 #define UPDATE_SIM_TIME                                         \
     if (1) {                                                    \
         int32 _x;                                               \
@@ -448,8 +454,10 @@ void (*sim_vm_sprint_addr) (char *buf, DEVICE *dptr, t_addr addr) = NULL;
 void (*sim_vm_fprint_addr) (FILE *st, DEVICE *dptr, t_addr addr) = NULL;
 t_addr (*sim_vm_parse_addr) (DEVICE *dptr, CONST char *cptr, CONST char **tptr) = NULL;
 t_value (*sim_vm_pc_value) (void) = NULL;
+const char *(*sim_vm_pc_mode) (void) = NULL;
 t_bool (*sim_vm_is_subroutine_call) (t_addr **ret_addrs) = NULL;
 t_bool (*sim_vm_fprint_stopped) (FILE *st, t_stat reason) = NULL;
+void *(*sim_vm_mem_region) (DEVICE *dptr, UNIT *uptr) = NULL;
 const char *sim_vm_release = NULL;
 const char *sim_vm_release_message = NULL;
 const char **sim_clock_precalibrate_commands = NULL;
@@ -464,6 +472,9 @@ t_stat set_dev_enbdis (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat set_dev_debug (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat set_unit_enbdis (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat set_unit_append (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat set_unit_cache (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat set_dev_profile (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat set_dev_symbols (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat ssh_break (FILE *st, const char *cptr, int32 flg);
 t_stat show_cmd_fi (FILE *ofile, int32 flag, CONST char *cptr);
 t_stat show_config (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
@@ -474,6 +485,8 @@ t_stat show_show_commands (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST
 t_stat show_log_names (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_radix (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_debug (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat show_unit_cache (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat show_dev_profile (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_logicals (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_modifiers (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_show_commands (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
@@ -495,6 +508,9 @@ t_stat sim_rest (FILE *rfile);
 /* Breakpoint package */
 
 t_stat sim_brk_init (void);
+static void sim_brk_rehash (void);
+static t_stat _sim_brk_clr (t_addr loc, int32 sw, t_bool rebuild);
+static void sim_brk_rebuild (void);
 t_stat sim_brk_set (t_addr loc, int32 sw, int32 ncnt, CONST char *act);
 t_stat sim_brk_clr (t_addr loc, int32 sw);
 t_stat sim_brk_clrall (int32 sw);
@@ -549,6 +565,8 @@ t_stat dep_addr (int32 flag, const char *cptr, t_addr addr, DEVICE *dptr,
 void fprint_fields (FILE *stream, t_value before, t_value after, BITFIELD* bitdefs);
 t_stat step_svc (UNIT *ptr);
 t_stat runlimit_svc (UNIT *ptr);
+t_stat profile_svc (UNIT *ptr);
+static t_stat sim_int_profile_reset (DEVICE *dptr);
 t_stat expect_svc (UNIT *ptr);
 t_stat flush_svc (UNIT *ptr);
 t_stat shift_args (char *do_arg[], size_t arg_count);
@@ -563,6 +581,7 @@ void int_handler (int signal);
 t_stat set_prompt (int32 flag, CONST char *cptr);
 t_stat set_runlimit (int32 flag, CONST char *cptr);
 t_stat sim_set_asynch (int32 flag, CONST char *cptr);
+t_stat sim_set_queue (int32 flag, CONST char *cptr);
 static const char *_get_dbg_verb (uint32 dbits, DEVICE* dptr, UNIT *uptr);
 static t_stat sim_sanity_check_register_declarations (void);
 static t_stat _sim_debug_flush (void);
@@ -589,6 +608,7 @@ uint32 sim_internal_device_count = 0;
 int32 sim_opt_out = 0;
 volatile t_bool sim_is_running = FALSE;
 t_bool sim_processing_event = FALSE;
+static t_uint64 sim_events_processed = 0;               /* event service routines dispatched */
 uint32 sim_brk_summ = 0;
 uint32 sim_brk_types = 0;
 BRKTYPTAB *sim_brk_type_desc = NULL;                /* type descriptions */
@@ -601,6 +621,9 @@ BRKTAB **sim_brk_tab = NULL;
 int32 sim_brk_ent = 0;
 int32 sim_brk_lnt = 0;
 int32 sim_brk_ins = 0;
+static BRKTAB **sim_brk_hash = NULL;                /* bpt hash (list heads, NULL = empty) */
+static uint32 sim_brk_hash_bits = 0;                /* log2 of hash table size */
+static uint32 sim_brk_pgmap[SIM_BRK_PG_N];          /* bpt types set per page slot */
 int32 sim_quiet = 0;
 int32 sim_show_message = 1;                         /* the message display status of the currently open do file */
 int32 sim_step = 0;
@@ -617,6 +640,14 @@ size_t *sim_sub_instr_off = NULL;   /* offsets in substitution buffer where orig
 static double sim_time;
 static uint32 sim_rtime;
 static int32 noqueue_time;
+#define SIM_QUEUE_LIST  0                               /* delta encoded linked list */
+#define SIM_QUEUE_HEAP  1                               /* binary heap on absolute time */
+static int32 sim_queue_mode = SIM_QUEUE_HEAP;           /* event scheduler in use */
+static UNIT **sim_heap = NULL;                          /* event heap */
+static int32 sim_heap_count = 0;                        /* active entries in heap */
+static int32 sim_heap_size = 0;                         /* allocated heap entries */
+static double sim_heap_base = 0.0;                      /* queue time while heap is empty */
+static t_uint64 sim_heap_seq = 0;                       /* next activation sequence */
 volatile t_bool stop_cpu = FALSE;
 volatile t_bool sigterm_received = FALSE;
 static unsigned int sim_stop_sleep_ms = 250;
@@ -701,6 +732,20 @@ DEVICE sim_runlimit_dev = {
     NULL, NULL, NULL, NULL, NULL, NULL,
     sim_int_runlimit_description};
 
+static const char *sim_int_profile_description (DEVICE *dptr)
+{
+return "PC profile sampler";
+}
+
+static UNIT sim_profile_unit = { UDATA (&profile_svc, UNIT_IDLE, 0) };
+DEVICE sim_profile_dev = {
+    "INT-PROFILE", &sim_profile_unit, NULL, NULL, 
+    1, 0, 0, 0, 0, 0, 
+    NULL, NULL, &sim_int_profile_reset, NULL, NULL, NULL, 
+    NULL, DEV_NOSAVE, 0, 
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    sim_int_profile_description};
+
 static const char *sim_int_expect_description (DEVICE *dptr)
 {
 return "Expect facility";
@@ -745,6 +790,7 @@ const char *sim_savename = sim_name;      /* Simulator Name used in SAVE/RESTORE
 /* Tables and strings */
 
 const char save_vercur[] = "V4.0";
+const char save_ver41[] = "V4.1";                       /* V4.0 with -Z or -I memory blocks */
 const char save_ver40[] = "V4.0";
 const char save_ver35[] = "V3.5";
 const char save_ver32[] = "V3.2";
@@ -992,6 +1038,21 @@ static const char simh_help1[] =
       " to a file.  This includes the contents of main memory and all registers,\n"
       " and the I/O connections of devices:\n\n"
       "++SAVE <filename>\n\n"
+      "4Switches\n"
+      " Switches can influence the output and behavior of the SAVE command\n\n"
+      "++-Z      Compresses memory contents (when built with zlib)\n"
+      "++-I      Incremental save: memory which hasn't changed since the last\n"
+      "++++SAVE or RESTORE is not written again\n\n"
+      " Compressed and incremental saves are written in the V4.1 save format,\n"
+      " which simulators that predate these switches refuse to restore.\n\n"
+      " An incremental save can only be restored when memory holds the state\n"
+      " it was taken against, so the earlier saved state must be restored\n"
+      " first:\n\n"
+      "++SAVE base.sav\n"
+      "++SAVE -I step1.sav\n"
+      "++...\n"
+      "++RESTORE base.sav\n"
+      "++RESTORE step1.sav\n\n"
 #define HLP_RESTORE     "*Commands Saving_and_Restoring_State RESTORE"
       "3RESTORE\n"
       " The RESTORE command (abbreviation REST, alternately GET) restores a\n"
@@ -1005,6 +1066,8 @@ static const char simh_help1[] =
       "\n"
       "4Notes:\n"
       " 1) SAVE file format compresses zeroes to minimize file size.\n"
+      "    SAVE -Z and SAVE -I files can't be restored by earlier simulator\n"
+      "    versions.\n"
       " 2) The simulator can't restore active incoming telnet sessions to\n"
       " multiplexer devices, but the listening ports will be restored across a\n"
       " save/restore.\n"
@@ -1375,6 +1438,15 @@ static const char simh_help1[] =
       " The size of the circular memory buffer that is used is specified on\n"
       " the SET DEBUG command line, for example:\n\n"
       "++SET DEBUG -B <sizeinMB> <debug-destination>\n\n"
+      "5-Z\n"
+      " The -Z switch causes debug messages to be recorded in a compact binary\n"
+      " form rather than formatted as they occur.  Messages are placed in memory\n"
+      " buffers and written to the debug file by a background thread, which\n"
+      " greatly reduces the cost of leaving debugging enabled.  The file can be\n"
+      " rendered as text later with:\n\n"
+      "++SHOW DEBUG DECODE <debug-file>\n\n"
+      " Duplicate successive lines are not summarized in the decoded output.\n"
+      " The -Z switch can't be combined with -B.\n"
 #define HLP_SET_BREAK  "*Commands SET Breakpoints"
       "3Breakpoints\n"
       "+SET BREAK <list>            set breakpoints\n"
@@ -1423,6 +1495,16 @@ static const char simh_help1[] =
       "3Asynch\n"
       "+SET ASYNCH                  enable asynchronous I/O\n"
       "+SET NOASYNCH                disable asynchronous I/O\n"
+#define HLP_SET_QUEUE "*Commands SET Queue"
+      "3Queue\n"
+      " The event queue can be maintained by one of two schedulers.  The HEAP\n"
+      " scheduler (the default) keeps pending events in a binary heap ordered\n"
+      " by absolute event time, so activating and canceling events costs\n"
+      " O(log n) in the number of pending events.  The LIST scheduler keeps\n"
+      " events on a linked list with delta encoded times.  Both schedulers fire\n"
+      " events in exactly the same order.\n\n"
+      "+SET QUEUE HEAP              use the heap event scheduler\n"
+      "+SET QUEUE LIST              use the linked list event scheduler\n"
 #define HLP_SET_ENVIRON "*Commands SET Environment"
       "3Environment\n"
       "4Explicitily Changing a Variable\n"
@@ -1512,8 +1594,18 @@ static const char simh_help1[] =
       "+SET <dev> DEBUG{=arg}       set device debug flags\n"
       "+SET <dev> NODEBUG={arg}     clear device debug flags\n"
       "+SET <dev> arg{,arg...}      set device parameters (see show modifiers)\n"
+      "+SET {-T} CPU PROFILE{=n}    sample the PC every n instructions (-T usecs)\n"
+      "+SET CPU NOPROFILE           stop sampling the PC\n"
+      "+SET CPU SYMBOLS=file        load a map or symbol file for profile reports\n"
+      "+SET CPU NOSYMBOLS           discard profile symbols\n"
       "+SET <unit> ENABLED          enable unit\n"
       "+SET <unit> DISABLED         disable unit\n"
+      "+SET <unit> CACHE{=size}     enable disk unit sector cache (size in K or M)\n"
+      "+SET <unit> NOCACHE          disable disk unit sector cache\n"
+      "+SET <unit> WRITEBACK        hold disk writes in the cache until flushed\n"
+      "+SET <unit> WRITETHROUGH     write through to the disk immediately\n"
+      "+SET <unit> MMAP             access a fixed size disk container via mmap\n"
+      "+SET <unit> NOMMAP           access the disk container with file I/O\n"
       "+SET <unit> arg{,arg...}     set unit parameters (see show modifiers)\n"
       "+HELP <dev> SET              displays the device specific set commands\n"
       "++++++++                     available\n";
@@ -1542,7 +1634,9 @@ static const char simh_help2[] =
       "+sh{ow} <dev> NAMES          show device logical name\n"
       "+sh{ow} <dev> SHOW           show device SHOW commands\n"
       "+sh{ow} <dev> {arg,...}      show device parameters\n"
+      "+sh{ow} {-A|-F} CPU PROFILE  show PC profile (-F flamegraph folded format)\n"
       "+sh{ow} <unit> {arg,...}     show unit parameters\n"
+      "+sh{ow} <unit> CACHE         show disk unit sector cache\n"
       "+sh{ow} ethernet             show ethernet devices\n"
       "+sh{ow} serial               show serial devices\n"
       "+sh{ow} multiplexer {dev}    show open multiplexer device info\n"
@@ -1554,6 +1648,7 @@ static const char simh_help2[] =
       "+sh{ow} on                   show on condition actions\n"
       "+sh{ow} do                   show do nesting state\n"
       "+sh{ow} runlimit             show execution limit states\n"
+      "+sh{ow} debug decode <file>  display a binary (SET DEBUG -Z) debug file\n"
       "+h{elp} <dev> show           displays the device specific show commands\n"
       "++++++++                     available\n"
 #define HLP_SHOW_CONFIG         "*Commands SHOW"
@@ -2431,7 +2526,64 @@ static const char simh_help2[] =
 #define HLP_DISKINFO    "*Commands DISKINFO"
       "2Disk Container Information\n"
       " Information about a Disk Container can be displayed with the DISKINFO command:\n\n"
-      "++DISKINFO container-spec    show information about a disk container\n\n";
+      "++DISKINFO container-spec    show information about a disk container\n\n"
+#define HLP_BENCHMARK   "*Commands Measuring_Simulator_Performance"
+      "2Measuring Simulator Performance\n"
+      " The BENCHMARK command executes another command (usually GO, RUN, BOOT or\n"
+      " CONTINUE) and reports how much work the simulator performed while that\n"
+      " command executed:\n\n"
+      "++BENCHMARK name command {arguments}\n\n"
+      " Once the command completes and its normal output has been displayed, a\n"
+      " single line of name=value pairs is displayed:\n\n"
+      "++BENCHMARK name=<name> simulator=\"<simulator>\" status=<n> seconds=<n>\n"
+      "+++instructions=<n> units=<units> ips=<n> events=<n> eps=<n>\n"
+      "+++disk_read_bytes=<n> disk_write_bytes=<n> disk_bytes_per_sec=<n>\n"
+      "+++tape_read_bytes=<n> tape_write_bytes=<n> tape_bytes_per_sec=<n>\n"
+      "+++net_read_packets=<n> net_read_bytes=<n> net_write_packets=<n>\n"
+      "+++net_write_bytes=<n> net_bytes_per_sec=<n>\n"
+      "+++mux_read_chars=<n> mux_write_chars=<n> mux_chars_per_sec=<n>\n\n"
+      " All values appear on the one line.  The instruction count is measured\n"
+      " in the simulator's own time units (%C), events are\n"
+      " device service routines dispatched, and the data totals include all\n"
+      " disk, tape, Ethernet and terminal multiplexer devices.  Rates are per\n"
+      " second of host wall clock time, so throttling and idling should be\n"
+      " disabled when the results will be compared.\n\n"
+      " The status of the benchmarked command is the status of the BENCHMARK\n"
+      " command, so ON and IF conditions can be used as usual.\n\n"
+      " Benchmark scripts for individual simulators are kept in their tests\n"
+      " directories as <simulator>_bench.ini and are run by \"make benchmarks\".\n\n"
+      "3Example\n"
+      "++BENCHMARK ehkaa GO\n\n"
+      "2Profiling Guest Code\n"
+      " The simulator can sample the program counter of the simulated CPU while\n"
+      " it runs to find where the guest software spends its time:\n\n"
+      "++SET CPU PROFILE{=n}        sample every n %C (default 10000)\n"
+      "++SET -T CPU PROFILE{=n}     sample every n usecs of host time (default 1000)\n"
+      "++SET CPU NOPROFILE          stop sampling\n\n"
+      " Each SET CPU PROFILE command discards the samples of any earlier profile.\n"
+      " Samples are only taken while instructions are executing and are kept\n"
+      " after sampling stops.  Simulators which know the processor mode (for\n"
+      " example the VAX and PDP-11) record it with each sample.\n\n"
+      " Addresses are reported by symbol and by module when a linker map or\n"
+      " symbol file has been loaded:\n\n"
+      "++SET CPU SYMBOLS=file\n"
+      "++SET CPU NOSYMBOLS\n\n"
+      " VMS LINK maps, RSX TKB maps and TOPS-20 LINK symbol maps are recognized.\n"
+      " Any other file is read as one symbol per line, either \"value name\" or\n"
+      " \"name value\" in the CPU's address radix, or the \"value type name\" lines\n"
+      " produced by nm.\n\n"
+      " The results are displayed with:\n\n"
+      "++SHOW CPU PROFILE           hottest symbols and modules\n"
+      "++SHOW -A CPU PROFILE        all symbols and modules\n"
+      "++SHOW -F CPU PROFILE        folded \"mode;module;symbol count\" lines\n\n"
+      " The -F output can be written to a file with SHOW @file -F CPU PROFILE and\n"
+      " is the input expected by flamegraph tools.\n\n"
+      "3Example\n"
+      "++SET CPU SYMBOLS=SYS.MAP\n"
+      "++SET CPU PROFILE=5000\n"
+      "++RUNLIMIT 1 MINUTES\n"
+      "++GO\n"
+      "++SHOW CPU PROFILE\n\n";
 
 
 static CTAB cmd_table[] = {
@@ -2508,6 +2660,7 @@ static CTAB cmd_table[] = {
     { "TESTLIB",    &test_lib_cmd,  0,          HLP_TESTLIB,    NULL, NULL },
     { "DISKINFO",   &sim_disk_info_cmd,  0,     HLP_DISKINFO,   NULL, NULL },
     { "ZAPTYPE",    &sim_disk_info_cmd,  1,     NULL,           NULL, NULL },
+    { "BENCHMARK",  &benchmark_cmd, 0,          HLP_BENCHMARK,  NULL, NULL },
     { NULL,         NULL,           0,          NULL,           NULL, NULL }
     };
 
@@ -2528,6 +2681,7 @@ static CTAB set_glob_tab[] = {
     { "CLOCKS",     &sim_set_timers,            1, HLP_SET_CLOCK },
     { "ASYNCH",     &sim_set_asynch,            1, HLP_SET_ASYNCH },
     { "NOASYNCH",   &sim_set_asynch,            0, HLP_SET_ASYNCH },
+    { "QUEUE",      &sim_set_queue,             0, HLP_SET_QUEUE },
     { "ENVIRONMENT", &sim_set_environment,      1, HLP_SET_ENVIRON },
     { "ON",         &set_on,                    1, HLP_SET_ON },
     { "NOON",       &set_on,                    0, HLP_SET_ON },
@@ -2556,6 +2710,10 @@ static C1TAB set_dev_tab[] = {
     { "NODEBUG",    &set_dev_debug,     0 },
     { "APPEND",     &set_unit_append,   0 },
     { "EOF",        &set_unit_append,   0 },
+    { "PROFILE",    &set_dev_profile,   1 },
+    { "NOPROFILE",  &set_dev_profile,   0 },
+    { "SYMBOLS",    &set_dev_symbols,   1,  NULL,   C1TAB_NC },
+    { "NOSYMBOLS",  &set_dev_symbols,   0 },
     { NULL,         NULL,               0 }
     };
 
@@ -2566,6 +2724,12 @@ static C1TAB set_unit_tab[] = {
     { "NODEBUG",    &set_dev_debug,     2+0 },
     { "APPEND",     &set_unit_append,   0 },
     { "EOF",        &set_unit_append,   0 },
+    { "CACHE",      &set_unit_cache,    DK_CACHE_SET_SIZE },
+    { "NOCACHE",    &set_unit_cache,    DK_CACHE_SET_NONE },
+    { "WRITEBACK",  &set_unit_cache,    DK_CACHE_SET_WRITEBACK },
+    { "WRITETHROUGH", &set_unit_cache,  DK_CACHE_SET_WRITETHRU },
+    { "MMAP",       &set_unit_cache,    DK_CACHE_SET_MMAP },
+    { "NOMMAP",     &set_unit_cache,    DK_CACHE_SET_NOMMAP },
     { NULL,         NULL,               0 }
     };
 
@@ -2610,11 +2774,13 @@ static SHTAB show_dev_tab[] = {
     { "MODIFIERS",  &show_dev_modifiers,        0 },
     { "NAMES",      &show_dev_logicals,         0 },
     { "SHOW",       &show_dev_show_commands,    0 },
+    { "PROFILE",    &show_dev_profile,          0 },
     { NULL,         NULL,                       0 }
     };
 
 static SHTAB show_unit_tab[] = {
     { "DEBUG",      &show_dev_debug,            1 },
+    { "CACHE",      &show_unit_cache,           0 },
     { NULL, NULL, 0 }
     };
 
@@ -2749,6 +2915,7 @@ sim_register_internal_device (&sim_expect_dev);
 sim_register_internal_device (&sim_step_dev);
 sim_register_internal_device (&sim_flush_dev);
 sim_register_internal_device (&sim_runlimit_dev);
+sim_register_internal_device (&sim_profile_dev);
 
 if ((stat = sim_ttinit ()) != SCPE_OK) {
     fprintf (stderr, "Fatal terminal initialization error\n%s\n",
@@ -5569,6 +5736,11 @@ while (*cptr != 0) {                                    /* do all mods */
         }                                               /* end for */
     if (!mptr || (mptr->mask == 0)) {                   /* no match? */
         if ((glbr = find_c1tab (ctbr, gbuf))) {         /* global match? */
+            if (cvptr && (glbr->flags & C1TAB_NC)) {
+                get_glyph_nc (svptr, gbuf, ',');        /* value keeps its case */
+                if ((cvptr = strchr (gbuf, '=')))
+                    *cvptr++ = 0;
+                }
             r = glbr->action (dptr, uptr, glbr->arg, cvptr);    /* do global */
             if (r != SCPE_OK)
                 return r;
@@ -5735,6 +5907,15 @@ if (0 == sim_fseek (uptr->fileref, 0, SEEK_END)) {
 return sim_messagef (SCPE_IERR, "%s Can't seek to end of file: %s - %s\n", sim_uname (uptr), uptr->filename, strerror (errno));
 }
 
+/* Set unit disk sector cache (CACHE{=size}, NOCACHE, WRITEBACK, WRITETHROUGH, MMAP, NOMMAP) */
+
+t_stat set_unit_cache (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+if (DEV_TYPE (dptr) != DEV_DISK)
+    return sim_messagef (SCPE_NOFNC, "%s is not a disk device.\n", sim_uname (uptr));
+return sim_disk_set_cache (uptr, flag, cptr, NULL);
+}
+
 /* Show command */
 
 t_stat show_cmd (int32 flag, CONST char *cptr)
@@ -6353,6 +6534,8 @@ t_stat show_queue (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST
 {
 DEVICE *dptr;
 UNIT *uptr;
+UNIT **entries;
+int32 i, cnt;
 MEMFILE buf;
 
 memset (&buf, 0, sizeof (buf));
@@ -6367,7 +6550,9 @@ else {
 
     fprintf (st, "%s event queue status, time = %.0f, executing %s %s/sec\n",
              sim_name, sim_time, sim_fmt_numeric (inst_per_sec), sim_vm_interval_units);
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
+    cnt = sim_qlist (&entries);
+    for (i = 0; i < cnt; i++) {
+        uptr = entries[i];
         if (uptr == &sim_step_unit)
             fprintf (st, "  Step timer");
         else
@@ -6392,7 +6577,9 @@ else {
                                             (*tim) ? " (" : "", tim, (*tim) ? ")" : "",
                                             (uptr->flags & UNIT_IDLE) ? " (Idle capable)" : "");
         }
+    free (entries);
     }
+fprintf (st, "event queue scheduler: %s\n", (sim_queue_mode == SIM_QUEUE_HEAP) ? "HEAP" : "LIST");
 sim_show_clock_queues (st, dnotused, unotused, flag, cptr);
 #if defined (SIM_ASYNCH_IO)
 pthread_mutex_lock (&sim_asynch_lock);
@@ -6446,6 +6633,20 @@ fprintf (st, "Radix=%d\n", dptr->dradix);
 return SCPE_OK;
 }
 
+t_stat show_unit_cache (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+t_stat r;
+
+if (cptr && (*cptr != 0))
+    return SCPE_2MARG;
+if (DEV_TYPE (dptr) != DEV_DISK)
+    return sim_messagef (SCPE_NOFNC, "%s is not a disk device.\n", sim_uname (uptr));
+fprintf (st, "%s: ", sim_uname (uptr));
+r = sim_disk_show_cache (st, uptr, 0, NULL);
+fprintf (st, "\n");
+return r;
+}
+
 t_stat show_dev_debug (FILE *st, DEVICE *dptr, UNIT *uptr, int32 uflag, CONST char *cptr)
 {
 DEBTAB *dep;
@@ -7255,6 +7456,837 @@ t_stat set_runlimit (int32 flag, CONST char *cptr)
 return runlimit_cmd (flag, cptr);
 }
 
+/* Benchmark command
+
+   BENCHMARK name command {arguments}
+
+   The command is executed as if it had been typed by itself and then
+   the instructions, events and device data transferred while it ran
+   are reported on a single line of name=value pairs.
+*/
+
+typedef struct {
+    double      wall;                                   /* host seconds */
+    double      gtime;                                  /* simulator time */
+    t_uint64    events;
+    t_uint64    disk_rd, disk_wr;
+    t_uint64    tape_rd, tape_wr;
+    t_uint64    net_rd_pkts, net_rd, net_wr_pkts, net_wr;
+    t_uint64    mux_rd, mux_wr;
+    } BENCHMARK_TOTALS;
+
+static void benchmark_totals (BENCHMARK_TOTALS *t)
+{
+t->wall = sim_timenow_double ();
+t->gtime = sim_gtime ();
+t->events = sim_events_processed;
+sim_disk_data_totals (&t->disk_rd, &t->disk_wr);
+sim_tape_data_totals (&t->tape_rd, &t->tape_wr);
+eth_data_totals (&t->net_rd_pkts, &t->net_rd, &t->net_wr_pkts, &t->net_wr);
+tmxr_data_totals (&t->mux_rd, &t->mux_wr);
+}
+
+t_stat benchmark_cmd (int32 flag, CONST char *cptr)
+{
+char name[CBUFSIZE], gbuf[CBUFSIZE];
+CTAB *cmdp;
+t_stat stat;
+BENCHMARK_TOTALS s, e;
+double secs;
+
+cptr = get_glyph_nc (cptr, name, 0);                    /* get benchmark name */
+if (name[0] == '\0')
+    return sim_messagef (SCPE_2FARG, "Missing benchmark name\n");
+cptr = get_glyph_cmd (cptr, gbuf);                      /* get command glyph */
+if (gbuf[0] == '\0')
+    return sim_messagef (SCPE_2FARG, "Missing command to benchmark\n");
+cmdp = find_cmd (gbuf);
+if (cmdp == NULL)
+    return SCPE_UNK;
+if ((cmdp->action == &benchmark_cmd) ||
+    (cmdp->action == &return_cmd) ||
+    (cmdp->action == &goto_cmd))
+    return sim_messagef (SCPE_ARG, "Can't benchmark a %s command\n", cmdp->name);
+benchmark_totals (&s);
+sim_switches = 0;                                       /* init switches */
+stat = cmdp->action (cmdp->arg, cptr);                  /* execute */
+benchmark_totals (&e);
+if (!(stat & SCPE_NOMESSAGE) && sim_show_message) {     /* display command status as usual */
+    if (cmdp->message)
+        cmdp->message (NULL, SCPE_BARE_STATUS (stat));
+    else
+        if (SCPE_BARE_STATUS (stat) >= SCPE_BASE)
+            sim_printf ("%s\n", sim_error_text (stat));
+    }
+secs = e.wall - s.wall;
+if (secs <= 0.0)
+    secs = 0.000001;
+sim_printf ("BENCHMARK name=%s simulator=\"%s\" status=%d seconds=%.3f", name, sim_name, SCPE_BARE_STATUS (stat), secs);
+sim_printf (" instructions=%.0f units=%s ips=%.0f", e.gtime - s.gtime, sim_vm_interval_units, (e.gtime - s.gtime) / secs);
+sim_printf (" events=%" LL_FMT "u eps=%.0f", e.events - s.events, (e.events - s.events) / secs);
+sim_printf (" disk_read_bytes=%" LL_FMT "u disk_write_bytes=%" LL_FMT "u disk_bytes_per_sec=%.0f",
+            e.disk_rd - s.disk_rd, e.disk_wr - s.disk_wr, ((e.disk_rd - s.disk_rd) + (e.disk_wr - s.disk_wr)) / secs);
+sim_printf (" tape_read_bytes=%" LL_FMT "u tape_write_bytes=%" LL_FMT "u tape_bytes_per_sec=%.0f",
+            e.tape_rd - s.tape_rd, e.tape_wr - s.tape_wr, ((e.tape_rd - s.tape_rd) + (e.tape_wr - s.tape_wr)) / secs);
+sim_printf (" net_read_packets=%" LL_FMT "u net_read_bytes=%" LL_FMT "u net_write_packets=%" LL_FMT "u net_write_bytes=%" LL_FMT "u net_bytes_per_sec=%.0f",
+            e.net_rd_pkts - s.net_rd_pkts, e.net_rd - s.net_rd, e.net_wr_pkts - s.net_wr_pkts, e.net_wr - s.net_wr, ((e.net_rd - s.net_rd) + (e.net_wr - s.net_wr)) / secs);
+sim_printf (" mux_read_chars=%" LL_FMT "u mux_write_chars=%" LL_FMT "u mux_chars_per_sec=%.0f\n",
+            e.mux_rd - s.mux_rd, e.mux_wr - s.mux_wr, ((e.mux_rd - s.mux_rd) + (e.mux_wr - s.mux_wr)) / secs);
+return stat | SCPE_NOMESSAGE;                           /* status already displayed */
+}
+
+/* Sampling PC profiler
+
+   SET CPU PROFILE{=n} samples the PC every n instructions (SET -T CPU
+   PROFILE{=n} every n microseconds of host time).  Each sample is counted
+   in a hash table keyed by the PC and, when the simulator provides a
+   sim_vm_pc_mode routine, by the processor mode.  SET CPU SYMBOLS=file
+   loads a linker map or symbol list which SHOW CPU PROFILE uses to report
+   hot spots by symbol and by module.
+*/
+
+#define PROF_DFLT_INSTR     10000                       /* default sample interval */
+#define PROF_DFLT_USECS     1000                        /* default sample interval -T */
+#define PROF_REPORT_TOP     20                          /* rows reported without -A */
+#define PROF_MAX_MODES      8                           /* distinct processor modes */
+#define PROF_MOD_SEARCH     32                          /* module ranges searched back */
+
+typedef struct {
+    t_addr      pc;
+    uint32      mode;                                   /* 1 based mode index, 0 = none */
+    uint32      count;                                  /* 0 = free slot */
+    } PROF_BIN;
+
+typedef struct {
+    t_addr      addr;
+    char        *name;
+    const char  *module;                                /* defining module or NULL */
+    } PROF_SYM;
+
+typedef struct {
+    t_addr      base;
+    t_addr      end;                                    /* inclusive */
+    const char  *name;
+    } PROF_MOD;
+
+typedef struct {                                        /* symbol file being loaded */
+    PROF_SYM    *syms;
+    uint32      sym_count;
+    uint32      sym_size;
+    PROF_MOD    *mods;
+    uint32      mod_count;
+    uint32      mod_size;
+    char        **names;                                /* module name strings */
+    uint32      name_count;
+    } PROF_SYMTAB;
+
+typedef struct {
+    uint32      mode;
+    int32       sym;                                    /* symbol index or -1 */
+    t_addr      pc;
+    const char  *module;
+    t_uint64    count;
+    } PROF_ROW;
+
+static t_bool prof_enabled = FALSE;
+static uint32 prof_interval = 0;
+static int32 prof_switches = 0;
+static PROF_BIN *prof_bins = NULL;
+static uint32 prof_bins_size = 0;                       /* power of 2 */
+static uint32 prof_bins_used = 0;
+static t_uint64 prof_samples = 0;
+static const char *prof_modes[PROF_MAX_MODES];
+static uint32 prof_mode_count = 0;
+
+static PROF_SYM *prof_syms = NULL;
+static uint32 prof_sym_count = 0;
+static uint32 prof_sym_size = 0;
+static PROF_MOD *prof_mods = NULL;
+static uint32 prof_mod_count = 0;
+static uint32 prof_mod_size = 0;
+static char **prof_names = NULL;                        /* module name strings */
+static uint32 prof_name_count = 0;
+static char prof_sym_file[CBUFSIZE] = "";
+static const char *prof_sym_format = "";
+
+
+static uint32 _prof_hash (t_addr pc, uint32 mode)
+{
+uint32 h = (uint32)pc ^ (uint32)(((t_uint64)pc) >> 32);
+
+h = (h ^ (mode << 28)) * 2654435761u;
+return h ^ (h >> 15);
+}
+
+static void _prof_insert (PROF_BIN *bins, uint32 size, t_addr pc, uint32 mode, uint32 count)
+{
+uint32 i = _prof_hash (pc, mode) & (size - 1);
+
+while (bins[i].count && ((bins[i].pc != pc) || (bins[i].mode != mode)))
+    i = (i + 1) & (size - 1);
+bins[i].pc = pc;
+bins[i].mode = mode;
+bins[i].count += count;
+}
+
+static void _prof_count (t_addr pc, uint32 mode)
+{
+uint32 i;
+
+if ((prof_bins_used + 1) * 4 >= prof_bins_size * 3) {  /* grow at 75% full */
+    uint32 size = prof_bins_size ? 2 * prof_bins_size : 4096;
+    PROF_BIN *bins = (PROF_BIN *)calloc (size, sizeof (*bins));
+
+    if (bins == NULL)
+        return;
+    for (i = 0; i < prof_bins_size; i++)
+        if (prof_bins[i].count)
+            _prof_insert (bins, size, prof_bins[i].pc, prof_bins[i].mode, prof_bins[i].count);
+    free (prof_bins);
+    prof_bins = bins;
+    prof_bins_size = size;
+    }
+i = _prof_hash (pc, mode) & (prof_bins_size - 1);
+while (prof_bins[i].count && ((prof_bins[i].pc != pc) || (prof_bins[i].mode != mode)))
+    i = (i + 1) & (prof_bins_size - 1);
+if (prof_bins[i].count == 0) {
+    prof_bins[i].pc = pc;
+    prof_bins[i].mode = mode;
+    ++prof_bins_used;
+    }
+++prof_bins[i].count;
+++prof_samples;
+}
+
+static uint32 _prof_mode_index (const char *mode)
+{
+uint32 i;
+
+if (mode == NULL)
+    return 0;
+for (i = 0; i < prof_mode_count; i++)
+    if ((prof_modes[i] == mode) || (strcmp (prof_modes[i], mode) == 0))
+        return i + 1;
+if (prof_mode_count == PROF_MAX_MODES)
+    return 0;
+prof_modes[prof_mode_count++] = mode;
+return prof_mode_count;
+}
+
+static void _prof_clear (void)
+{
+free (prof_bins);
+prof_bins = NULL;
+prof_bins_size = prof_bins_used = 0;
+prof_samples = 0;
+prof_mode_count = 0;
+}
+
+static t_stat _prof_schedule (UNIT *uptr)
+{
+if (prof_switches & SWMASK ('T'))
+    return sim_activate_after (uptr, prof_interval);
+return sim_activate (uptr, (int32)prof_interval);
+}
+
+/* Unit service for the profiler, take a sample and schedule the next one */
+
+t_stat profile_svc (UNIT *uptr)
+{
+t_value pc;
+
+/* As with the debug -P switch, the PC register isn't necessarily current
+   while instructions are executing, so sim_vm_pc_value is preferred. */
+if (sim_vm_pc_value)
+    pc = (*sim_vm_pc_value)();
+else
+    pc = get_rval (sim_PC, 0);
+_prof_count ((t_addr)pc, sim_vm_pc_mode ? _prof_mode_index ((*sim_vm_pc_mode)()) : 0);
+return _prof_schedule (uptr);
+}
+
+static t_stat sim_int_profile_reset (DEVICE *dptr)
+{
+if (prof_enabled)
+    return _prof_schedule (dptr->units);
+return SCPE_OK;
+}
+
+/* Set CPU profiling (PROFILE{=n}, NOPROFILE) */
+
+t_stat set_dev_profile (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+uint32 interval = (sim_switches & SWMASK ('T')) ? PROF_DFLT_USECS : PROF_DFLT_INSTR;
+t_stat r;
+
+if (dptr != sim_devices[0])
+    return sim_messagef (SCPE_NOFNC, "Profiling is only available for the %s device\n", sim_dname (sim_devices[0]));
+if (!flag) {                                            /* NOPROFILE? */
+    if (cptr)
+        return SCPE_ARG;
+    prof_enabled = FALSE;
+    return sim_cancel (&sim_profile_unit);              /* samples stay for SHOW */
+    }
+if (cptr && *cptr) {
+    interval = (uint32)get_uint (cptr, 10, 0x7FFFFFFF, &r);
+    if ((r != SCPE_OK) || (interval == 0))
+        return sim_messagef (SCPE_ARG, "Invalid profile sample interval: %s\n", cptr);
+    }
+sim_cancel (&sim_profile_unit);
+_prof_clear ();                                         /* start a new profile */
+prof_interval = interval;
+prof_switches = sim_switches & SWMASK ('T');
+prof_enabled = TRUE;
+return _prof_schedule (&sim_profile_unit);
+}
+
+/* Symbol and map files
+
+   The format is recognized from the file contents:
+
+   VMS      LINK map.  Module address ranges come from the Program Section
+            Synopsis and symbols from Symbols By Value or Symbols By Name.
+            Values are 8 hex digits.
+   RSX      TKB map.  Module address ranges come from the module lines of
+            the Program Section Allocation Synopsis and from the section
+            lines which follow a TITLE: in the File Contents.  Symbols are
+            "name value" pairs (6 octal digits with an optional -R) which
+            are attributed to the module of the preceding TITLE:.
+   TOPS-20  LINK symbol map.  "name from start to end" lines give module
+            ranges and "name value {attributes}" pairs give symbols in
+            the current module.  Values are octal.
+   Plain    One symbol per line as "value name", "name value" or the
+            "value type name" form produced by nm, in the address radix
+            of the CPU.
+*/
+
+static char *_prof_strdup (const char *str)
+{
+char *s = (char *)malloc (strlen (str) + 1);
+
+if (s)
+    strcpy (s, str);
+return s;
+}
+
+static const char *_prof_module_name (PROF_SYMTAB *st, const char *name)
+{
+uint32 i;
+char **names;
+
+for (i = st->name_count; i > 0; i--)                    /* recent names are most likely */
+    if (strcmp (st->names[i - 1], name) == 0)
+        return st->names[i - 1];
+names = (char **)realloc (st->names, (st->name_count + 1) * sizeof (*names));
+if (names == NULL)
+    return NULL;
+st->names = names;
+if ((st->names[st->name_count] = _prof_strdup (name)) == NULL)
+    return NULL;
+return st->names[st->name_count++];
+}
+
+static void _prof_add_sym (PROF_SYMTAB *st, t_addr addr, const char *name, const char *module)
+{
+if (st->sym_count == st->sym_size) {
+    uint32 size = st->sym_size ? 2 * st->sym_size : 1024;
+    PROF_SYM *syms = (PROF_SYM *)realloc (st->syms, size * sizeof (*syms));
+
+    if (syms == NULL)
+        return;
+    st->syms = syms;
+    st->sym_size = size;
+    }
+if ((st->syms[st->sym_count].name = _prof_strdup (name)) == NULL)
+    return;
+st->syms[st->sym_count].addr = addr;
+st->syms[st->sym_count].module = module;
+++st->sym_count;
+}
+
+static void _prof_add_mod (PROF_SYMTAB *st, t_addr base, t_addr end, const char *name)
+{
+if ((name == NULL) || (end < base))
+    return;
+if (st->mod_count == st->mod_size) {
+    uint32 size = st->mod_size ? 2 * st->mod_size : 256;
+    PROF_MOD *mods = (PROF_MOD *)realloc (st->mods, size * sizeof (*mods));
+
+    if (mods == NULL)
+        return;
+    st->mods = mods;
+    st->mod_size = size;
+    }
+st->mods[st->mod_count].base = base;
+st->mods[st->mod_count].end = end;
+st->mods[st->mod_count].name = name;
+++st->mod_count;
+}
+
+static void _prof_free_symtab (PROF_SYMTAB *st)
+{
+uint32 i;
+
+for (i = 0; i < st->sym_count; i++)
+    free (st->syms[i].name);
+for (i = 0; i < st->name_count; i++)
+    free (st->names[i]);
+free (st->syms);
+free (st->mods);
+free (st->names);
+memset (st, 0, sizeof (*st));
+}
+
+static void _prof_free_symbols (void)
+{
+PROF_SYMTAB st;
+
+st.syms = prof_syms;
+st.sym_count = prof_sym_count;
+st.sym_size = prof_sym_size;
+st.mods = prof_mods;
+st.mod_count = prof_mod_count;
+st.mod_size = prof_mod_size;
+st.names = prof_names;
+st.name_count = prof_name_count;
+_prof_free_symtab (&st);
+prof_syms = NULL;
+prof_mods = NULL;
+prof_names = NULL;
+prof_sym_count = prof_sym_size = 0;
+prof_mod_count = prof_mod_size = 0;
+prof_name_count = 0;
+prof_sym_file[0] = '\0';
+prof_sym_format = "";
+}
+
+/* Convert a value token, an optional -suffix (-R, -*) is ignored.
+   A non zero digits requires exactly that many digits. */
+
+static t_bool _prof_value (const char *tok, uint32 radix, size_t digits, t_addr *val)
+{
+CONST char *end;
+size_t len = strcspn (tok, "-");
+
+if ((len == 0) || (digits && (len != digits)))
+    return FALSE;
+*val = (t_addr)strtotv (tok, &end, radix);
+return (end == tok + len);
+}
+
+static t_bool _prof_is_name (const char *tok)
+{
+return (sim_isalpha (tok[0]) || (tok[0] == '$') || (tok[0] == '.') ||
+        (tok[0] == '%') || (tok[0] == '_'));
+}
+
+static int _prof_tokens (char *line, char **tok, int max)
+{
+int n = 0;
+
+while (n < max) {
+    while (sim_isspace (*line))
+        ++line;
+    if (*line == '\0')
+        break;
+    tok[n++] = line;
+    while (*line && !sim_isspace (*line))
+        ++line;
+    if (*line)
+        *line++ = '\0';
+    }
+return n;
+}
+
+static int _prof_sym_cmp (const void *pa, const void *pb)
+{
+const PROF_SYM *a = (const PROF_SYM *)pa;
+const PROF_SYM *b = (const PROF_SYM *)pb;
+
+if (a->addr != b->addr)
+    return (a->addr < b->addr) ? -1 : 1;
+return strcmp (a->name, b->name);
+}
+
+static int _prof_mod_cmp (const void *pa, const void *pb)
+{
+const PROF_MOD *a = (const PROF_MOD *)pa;
+const PROF_MOD *b = (const PROF_MOD *)pb;
+
+if (a->base != b->base)
+    return (a->base < b->base) ? -1 : 1;
+return (a->end < b->end) ? -1 : (a->end > b->end);
+}
+
+#define PROF_FMT_PLAIN      0
+#define PROF_FMT_VMS        1
+#define PROF_FMT_RSX        2
+#define PROF_FMT_TOPS20     3
+
+static t_stat _prof_load_symbols (const char *filename)
+{
+static const char *fmt_names[] = {"plain", "VMS LINK map", "RSX TKB map", "TOPS-20 LINK map"};
+FILE *f;
+char line[1024], *tok[64];
+int ntok, i, fmt = PROF_FMT_PLAIN;
+int vms_section = 0;                                    /* 1 synopsis, 2 by value, 3 by name */
+const char *module = NULL;
+t_addr val = 0, end = 0;
+uint32 j, k;
+DEVICE *cdptr = sim_devices[0];
+PROF_SYMTAB st;                                         /* new tables */
+
+f = sim_fopen (filename, "r");
+if (f == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't open symbol file %s: %s\n", filename, strerror (errno));
+while ((fmt == PROF_FMT_PLAIN) && fgets (line, sizeof (line), f)) {
+    if (strstr (line, "Program Section Synopsis") || strstr (line, "Symbols By Value") ||
+        strstr (line, "Symbols By Name"))
+        fmt = PROF_FMT_VMS;
+    else if (strstr (line, "GLOBAL SYMBOLS") || strstr (line, "TASK ATTRIBUTES") ||
+             strstr (line, "PROGRAM SECTION ALLOCATION"))
+        fmt = PROF_FMT_RSX;
+    else if (strstr (line, "LINK symbol map"))
+        fmt = PROF_FMT_TOPS20;
+    }
+rewind (f);
+memset (&st, 0, sizeof (st));
+while (fgets (line, sizeof (line), f)) {
+    t_bool indented = sim_isspace (line[0]);
+
+    if (fmt == PROF_FMT_VMS) {
+        if (strchr (line, '!')) {                       /* section title box */
+            if (strstr (line, "Program Section Synopsis"))
+                vms_section = 1;
+            else if (strstr (line, "Symbols By Value"))
+                vms_section = 2;
+            else if (strstr (line, "Symbols By Name"))
+                vms_section = 3;
+            else if (strstr (line, "Synopsis") || strstr (line, "Symbol") || strstr (line, "Key for"))
+                vms_section = 0;
+            continue;
+            }
+        }
+    ntok = _prof_tokens (line, tok, 64);
+    switch (fmt) {
+
+    case PROF_FMT_VMS:
+        if ((vms_section == 1) && indented && (ntok >= 3) &&       /* module contribution */
+            _prof_value (tok[1], 16, 8, &val) && _prof_value (tok[2], 16, 8, &end))
+            _prof_add_mod (&st, val, end, _prof_module_name (&st, tok[0]));
+        else if (vms_section == 2) {                    /* value R-sym R-sym ... */
+            t_bool have_val = FALSE;
+
+            for (i = 0; i < ntok; i++) {
+                if (_prof_value (tok[i], 16, 8, &val))
+                    have_val = TRUE;
+                else if (have_val) {
+                    const char *name = tok[i];
+
+                    if ((strlen (name) > 2) && (name[1] == '-'))
+                        name += 2;                      /* drop R-, X-, U- flags */
+                    if (_prof_is_name (name))
+                        _prof_add_sym (&st, val, name, NULL);
+                    }
+                }
+            }
+        else if (vms_section == 3) {                    /* sym value-R sym value ... */
+            for (i = 0; i + 1 < ntok; i++)
+                if (_prof_is_name (tok[i]) && _prof_value (tok[i + 1], 16, 8, &val)) {
+                    _prof_add_sym (&st, val, tok[i], NULL);
+                    ++i;
+                    }
+            }
+        break;
+
+    case PROF_FMT_RSX:
+        for (i = 0; i + 1 < ntok; i++)
+            if (strcmp (tok[i], "TITLE:") == 0)
+                module = _prof_module_name (&st, tok[i + 1]);
+        if ((ntok >= 4) && indented &&                  /* synopsis module line */
+            _prof_value (tok[0], 8, 6, &val) && _prof_value (tok[1], 8, 6, &end) &&
+            (tok[2][strlen (tok[2]) - 1] == '.') && _prof_is_name (tok[3])) {
+            if (end)
+                _prof_add_mod (&st, val, val + end - 1, _prof_module_name (&st, tok[3]));
+            break;
+            }
+        if ((ntok >= 3) && (tok[0][0] == '<') && module &&     /* section of a file */
+            _prof_value (tok[1], 8, 6, &val) && _prof_value (tok[2], 8, 6, &end)) {
+            _prof_add_mod (&st, val, end, module);
+            break;
+            }
+        for (i = 0; i + 1 < ntok; i++)
+            if (_prof_is_name (tok[i]) && (tok[i][strlen (tok[i]) - 1] != ':') &&
+                _prof_value (tok[i + 1], 8, 6, &val)) {
+                _prof_add_sym (&st, val, tok[i], module);
+                ++i;
+                }
+        break;
+
+    case PROF_FMT_TOPS20:
+        if ((ntok >= 5) && (sim_strcasecmp (tok[1], "from") == 0) &&
+            (sim_strcasecmp (tok[3], "to") == 0) &&
+            _prof_value (tok[2], 8, 0, &val) && _prof_value (tok[4], 8, 0, &end)) {
+            module = _prof_module_name (&st, tok[0]);
+            _prof_add_mod (&st, val, end, module);
+            break;
+            }
+        for (i = 0; i + 1 < ntok; i++)
+            if (_prof_is_name (tok[i]) && _prof_value (tok[i + 1], 8, 0, &val)) {
+                _prof_add_sym (&st, val, tok[i], module);
+                ++i;
+                }
+        break;
+
+    default:                                            /* plain */
+        if ((ntok >= 2) && _prof_value (tok[0], cdptr->aradix, 0, &val) && _prof_is_name (tok[ntok - 1]))
+            _prof_add_sym (&st, val, tok[ntok - 1], NULL);
+        else if ((ntok == 2) && _prof_is_name (tok[0]) && _prof_value (tok[1], cdptr->aradix, 0, &val))
+            _prof_add_sym (&st, val, tok[0], NULL);
+        break;
+        }
+    }
+fclose (f);
+if (st.sym_count == 0) {                                /* keep the current symbols */
+    _prof_free_symtab (&st);
+    return sim_messagef (SCPE_ARG, "No symbols found in %s\n", filename);
+    }
+qsort (st.syms, st.sym_count, sizeof (*st.syms), _prof_sym_cmp);
+for (j = k = 1; j < st.sym_count; j++) {                /* drop duplicates */
+    if ((st.syms[j].addr == st.syms[k - 1].addr) &&
+        (strcmp (st.syms[j].name, st.syms[k - 1].name) == 0)) {
+        if (st.syms[k - 1].module == NULL)
+            st.syms[k - 1].module = st.syms[j].module;
+        free (st.syms[j].name);
+        }
+    else
+        st.syms[k++] = st.syms[j];
+    }
+st.sym_count = k;
+if (st.mod_count)
+    qsort (st.mods, st.mod_count, sizeof (*st.mods), _prof_mod_cmp);
+_prof_free_symbols ();                                  /* replace the old tables */
+prof_syms = st.syms;
+prof_sym_count = st.sym_count;
+prof_sym_size = st.sym_size;
+prof_mods = st.mods;
+prof_mod_count = st.mod_count;
+prof_mod_size = st.mod_size;
+prof_names = st.names;
+prof_name_count = st.name_count;
+strlcpy (prof_sym_file, filename, sizeof (prof_sym_file));
+prof_sym_format = fmt_names[fmt];
+sim_messagef (SCPE_OK, "%u symbols and %u module ranges loaded from %s (%s)\n",
+              prof_sym_count, prof_mod_count, filename, prof_sym_format);
+return SCPE_OK;
+}
+
+/* Set CPU profile symbols (SYMBOLS=file, NOSYMBOLS) */
+
+t_stat set_dev_symbols (DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+if (dptr != sim_devices[0])
+    return sim_messagef (SCPE_NOFNC, "Profiling is only available for the %s device\n", sim_dname (sim_devices[0]));
+if (!flag) {                                            /* NOSYMBOLS? */
+    if (cptr)
+        return SCPE_ARG;
+    _prof_free_symbols ();
+    return SCPE_OK;
+    }
+if ((cptr == NULL) || (*cptr == '\0'))
+    return sim_messagef (SCPE_2FARG, "Missing symbol file name\n");
+return _prof_load_symbols (cptr);
+}
+
+/* Find the symbol at or below an address */
+
+static int32 _prof_find_sym (t_addr addr)
+{
+int32 lo = 0, hi = (int32)prof_sym_count - 1, mid;
+
+if ((hi < 0) || (addr < prof_syms[0].addr))
+    return -1;
+while (lo < hi) {
+    mid = (lo + hi + 1) / 2;
+    if (prof_syms[mid].addr <= addr)
+        lo = mid;
+    else
+        hi = mid - 1;
+    }
+return lo;
+}
+
+/* Find the module containing an address, from the map's address ranges
+   or failing that from the module which defines the nearest symbol */
+
+static const char *_prof_find_module (t_addr addr, int32 sym)
+{
+int32 lo = 0, hi = (int32)prof_mod_count - 1, mid, i;
+
+if ((hi >= 0) && (addr >= prof_mods[0].base)) {
+    while (lo < hi) {
+        mid = (lo + hi + 1) / 2;
+        if (prof_mods[mid].base <= addr)
+            lo = mid;
+        else
+            hi = mid - 1;
+        }
+    for (i = lo; (i >= 0) && (i > lo - PROF_MOD_SEARCH); i--)
+        if ((addr >= prof_mods[i].base) && (addr <= prof_mods[i].end))
+            return prof_mods[i].name;
+    }
+return (sym >= 0) ? prof_syms[sym].module : NULL;
+}
+
+static int _prof_row_key_cmp (const void *pa, const void *pb)
+{
+const PROF_ROW *a = (const PROF_ROW *)pa;
+const PROF_ROW *b = (const PROF_ROW *)pb;
+
+if (a->mode != b->mode)
+    return (a->mode < b->mode) ? -1 : 1;
+if (a->sym != b->sym)
+    return (a->sym < b->sym) ? -1 : 1;
+if ((a->sym < 0) && (a->pc != b->pc))
+    return (a->pc < b->pc) ? -1 : 1;
+return 0;
+}
+
+static int _prof_row_module_cmp (const void *pa, const void *pb)
+{
+const PROF_ROW *a = (const PROF_ROW *)pa;
+const PROF_ROW *b = (const PROF_ROW *)pb;
+
+if (a->module == b->module)
+    return 0;
+if ((a->module == NULL) || (b->module == NULL))
+    return (a->module == NULL) ? 1 : -1;
+return strcmp (a->module, b->module);
+}
+
+static int _prof_row_count_cmp (const void *pa, const void *pb)
+{
+const PROF_ROW *a = (const PROF_ROW *)pa;
+const PROF_ROW *b = (const PROF_ROW *)pb;
+
+if (a->count != b->count)
+    return (a->count > b->count) ? -1 : 1;
+return _prof_row_key_cmp (pa, pb);
+}
+
+/* Merge rows which compare equal, returns the new row count */
+
+static uint32 _prof_merge (PROF_ROW *rows, uint32 n, int (*cmp)(const void *, const void *))
+{
+uint32 i, k;
+
+if (n == 0)
+    return 0;
+qsort (rows, n, sizeof (*rows), cmp);
+for (i = k = 1; i < n; i++) {
+    if (cmp (&rows[i], &rows[k - 1]) == 0)
+        rows[k - 1].count += rows[i].count;
+    else
+        rows[k++] = rows[i];
+    }
+qsort (rows, k, sizeof (*rows), _prof_row_count_cmp);
+return k;
+}
+
+static const char *_prof_location (DEVICE *dptr, const PROF_ROW *row, char *buf)
+{
+if (row->sym >= 0)
+    return prof_syms[row->sym].name;
+sprint_val (buf, (t_value)row->pc, dptr->aradix, dptr->awidth, PV_RZRO);
+return buf;
+}
+
+/* Show CPU profile
+
+   SHOW CPU PROFILE displays the hottest symbols (or addresses when no
+   symbols are loaded) and modules, -A displays all of them and -F writes
+   "mode;module;symbol count" lines for flamegraph tools. */
+
+t_stat show_dev_profile (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+PROF_ROW *rows, *mods;
+uint32 i, n, nmods, top;
+double cum = 0.0;
+char buf[CBUFSIZE];
+
+if (dptr != sim_devices[0])
+    return sim_messagef (SCPE_NOFNC, "Profiling is only available for the %s device\n", sim_dname (sim_devices[0]));
+if (cptr && (*cptr != 0))
+    return SCPE_2MARG;
+if (!(sim_switches & SWMASK ('F'))) {
+    fprintf (st, "Profile %s", prof_enabled ? "sampling" : "not sampling");
+    if (prof_interval)
+        fprintf (st, " every %u %s", prof_interval, (prof_switches & SWMASK ('T')) ? "usecs" : sim_vm_interval_units);
+    fprintf (st, ", %" LL_FMT "u samples at %u distinct addresses\n", prof_samples, prof_bins_used);
+    if (prof_sym_count)
+        fprintf (st, "Symbols: %u symbols and %u module ranges from %s (%s)\n",
+                 prof_sym_count, prof_mod_count, prof_sym_file, prof_sym_format);
+    }
+if (prof_samples == 0)
+    return SCPE_OK;
+rows = (PROF_ROW *)malloc (2 * prof_bins_used * sizeof (*rows));
+if (rows == NULL)
+    return SCPE_MEM;
+for (i = n = 0; i < prof_bins_size; i++) {
+    if (prof_bins[i].count == 0)
+        continue;
+    rows[n].mode = prof_bins[i].mode;
+    rows[n].pc = prof_bins[i].pc;
+    rows[n].sym = _prof_find_sym (prof_bins[i].pc);
+    rows[n].module = _prof_find_module (prof_bins[i].pc, rows[n].sym);
+    rows[n].count = prof_bins[i].count;
+    ++n;
+    }
+mods = rows + n;
+memcpy (mods, rows, n * sizeof (*rows));
+nmods = _prof_merge (mods, n, _prof_row_module_cmp);
+n = _prof_merge (rows, n, _prof_row_key_cmp);
+if (sim_switches & SWMASK ('F')) {                      /* folded stacks */
+    for (i = 0; i < n; i++) {
+        if (rows[i].mode)
+            fprintf (st, "%s;", prof_modes[rows[i].mode - 1]);
+        if (prof_mod_count || (rows[i].module != NULL))
+            fprintf (st, "%s;", rows[i].module ? rows[i].module : "?");
+        fprintf (st, "%s %" LL_FMT "u\n", _prof_location (dptr, &rows[i], buf), rows[i].count);
+        }
+    free (rows);
+    return SCPE_OK;
+    }
+top = ((sim_switches & SWMASK ('A')) || (n < PROF_REPORT_TOP)) ? n : PROF_REPORT_TOP;
+fprintf (st, "\n  Samples      %%   Cum %%  %s%s\n", prof_mode_count ? "Mode        " : "",
+         prof_sym_count ? "Symbol (Module)" : "Address");
+for (i = 0; i < top; i++) {
+    double pct = (100.0 * rows[i].count) / prof_samples;
+
+    cum += pct;
+    fprintf (st, "%9" LL_FMT "u %6.2f%% %6.2f%%  ", rows[i].count, pct, cum);
+    if (prof_mode_count)
+        fprintf (st, "%-11s ", rows[i].mode ? prof_modes[rows[i].mode - 1] : "");
+    fprintf (st, "%s", _prof_location (dptr, &rows[i], buf));
+    if (rows[i].module)
+        fprintf (st, " (%s)", rows[i].module);
+    fprintf (st, "\n");
+    }
+if (top < n)
+    fprintf (st, "  ... %u more\n", n - top);
+if ((nmods > 1) || ((nmods == 1) && (mods[0].module != NULL))) {
+    top = ((sim_switches & SWMASK ('A')) || (nmods < PROF_REPORT_TOP)) ? nmods : PROF_REPORT_TOP;
+    fprintf (st, "\n  Samples      %%  Module\n");
+    for (i = 0; i < top; i++)
+        fprintf (st, "%9" LL_FMT "u %6.2f%%  %s\n", mods[i].count, (100.0 * mods[i].count) / prof_samples,
+                 mods[i].module ? mods[i].module : "?");
+    if (top < nmods)
+        fprintf (st, "  ... %u more\n", nmods - top);
+    }
+free (rows);
+return SCPE_OK;
+}
+
 t_stat show_runlimit (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
 {
 if (sim_runlimit_enabled) {
@@ -7848,26 +8880,198 @@ fclose (sfile);
 return r;
 }
 
-t_stat sim_save (FILE *sfile)
-{
-void *mbuf;
-int32 l, t;
-uint32 i, j, device_count;
-t_addr k, high;
-t_value val;
-t_stat r;
-t_bool zeroflg;
-size_t sz;
-DEVICE *dptr;
-UNIT *uptr;
-REG *rptr;
+/* Memory save and restore
 
-#define WRITE_I(xx) sim_fwrite (&(xx), sizeof (xx), 1, sfile)
+   Memory-like units are saved in blocks of up to SRBSIZ elements of
+   SZ_D (dptr) bytes (little endian in the file).  Each block starts
+   with a count:
 
-/* Don't make changes below without also changing save_vercur above */
+        count > 0                       count elements follow
+        count < 0                       -count zero elements
+        0, SR_BLK_DEFLATE, count, size  size bytes of deflated elements
+        0, SR_BLK_SAME, count, hash     count elements unchanged since the
+                                        previous save or restore
+
+   A VM can supply sim_vm_mem_region to return the host memory holding a
+   unit's contents: capac/aincr elements of SZ_D (dptr) bytes in host
+   byte order, the same values examine and deposit access with
+   SIM_SW_REST.  Blocks are then moved directly rather than one
+   examine or deposit per element.
+
+   The hash of each block written or restored is kept by unit so that
+   SAVE -I can recognize the blocks which haven't changed.
+*/
+
+#define SR_BLK_DEFLATE  1                               /* deflated block */
+#define SR_BLK_SAME     2                               /* unchanged block */
+
+struct sim_mem_hashes {
+    UNIT                *uptr;
+    uint32              blocks;                         /* number of blocks */
+    t_uint64            *hash;                          /* hash by block (0 = unknown) */
+    };
+
+static struct sim_mem_hashes *sim_mem_hash_tab = NULL;
+static int32 sim_mem_hash_count = 0;
+
+static t_uint64 *sim_mem_hashes (UNIT *uptr, uint32 blocks)
+{
+struct sim_mem_hashes *h = NULL;
+int32 i;
+
+for (i = 0; i < sim_mem_hash_count; i++) {
+    if (sim_mem_hash_tab[i].uptr == uptr) {
+        h = &sim_mem_hash_tab[i];
+        break;
+        }
+    }
+if (h == NULL) {
+    struct sim_mem_hashes *tab = (struct sim_mem_hashes *)realloc (sim_mem_hash_tab, (sim_mem_hash_count + 1) * sizeof (*tab));
+
+    if (tab == NULL)
+        return NULL;
+    sim_mem_hash_tab = tab;
+    h = &sim_mem_hash_tab[sim_mem_hash_count++];
+    memset (h, 0, sizeof (*h));
+    h->uptr = uptr;
+    }
+if (h->blocks != blocks) {                              /* memory size changed? */
+    free (h->hash);
+    h->hash = (t_uint64 *)calloc (blocks, sizeof (*h->hash));
+    h->blocks = (h->hash != NULL) ? blocks : 0;
+    }
+return h->hash;
+}
+
+/* Hash of a block in file byte order, never 0 */
+
+static t_uint64 sim_mem_hash (const uint8 *blk, size_t len)
+{
+t_uint64 h = 0xCBF29CE484222325ULL;
+t_uint64 w;
+size_t i;
+
+for (i = 0; i + sizeof (w) <= len; i += sizeof (w)) {
+    memcpy (&w, blk + i, sizeof (w));
+    if (!sim_end)
+        sim_buf_swap_data (&w, sizeof (w), 1);
+    h = (h ^ w) * 0x100000001B3ULL;
+    h = h ^ (h >> 29);
+    }
+for ( ; i < len; i++)
+    h = (h ^ blk[i]) * 0x100000001B3ULL;
+return (h == 0) ? 1 : h;
+}
+
+/* Get the block of memory starting at k in file byte order
+
+   Returns a pointer to the block (in the unit's memory region or in
+   mbuf) and the number of elements in it.
+*/
+
+static const uint8 *sim_mem_get_block (DEVICE *dptr, UNIT *uptr, void *region, t_addr k, t_addr high,
+                                       void *mbuf, int32 *count, t_stat *stat)
+{
+size_t sz = SZ_D (dptr);
+t_value val;
+int32 l;
+
+*stat = SCPE_OK;
+if (region != NULL) {
+    t_addr left = (high - k + dptr->aincr - 1) / dptr->aincr;
+    const uint8 *blk = ((const uint8 *)region) + (k / dptr->aincr) * sz;
+
+    *count = (left < SRBSIZ) ? (int32)left : SRBSIZ;
+    if (sim_end)
+        return blk;
+    sim_buf_copy_swapped (mbuf, blk, sz, *count);
+    return (const uint8 *)mbuf;
+    }
+for (l = 0; (l < SRBSIZ) && (k < high); l++, k = k + (dptr->aincr)) {
+    *stat = dptr->examine (&val, k, uptr, SIM_SW_REST);
+    if (*stat != SCPE_OK)
+        return NULL;
+    SZ_STORE (sz, val, mbuf, l);
+    }
+*count = l;
+if (!sim_end)
+    sim_buf_swap_data (mbuf, sz, l);
+return (const uint8 *)mbuf;
+}
+
+/* Store a block of memory starting at k from file byte order data
+   (NULL for zeroes)
+*/
+
+static t_stat sim_mem_put_block (DEVICE *dptr, UNIT *uptr, void *region, t_addr k,
+                                 uint8 *blk, int32 count)
+{
+size_t sz = SZ_D (dptr);
+t_value val = 0;
+t_stat r;
+int32 j;
+
+if (region != NULL) {
+    uint8 *mem = ((uint8 *)region) + (k / dptr->aincr) * sz;
+
+    if (blk == NULL)
+        memset (mem, 0, count * sz);
+    else
+        sim_buf_copy_swapped (mem, blk, sz, count);
+    return SCPE_OK;
+    }
+if ((blk != NULL) && !sim_end)
+    sim_buf_swap_data (blk, sz, count);
+for (j = 0; j < count; j++, k = k + (dptr->aincr)) {
+    if (blk != NULL) {
+        SZ_LOAD (sz, val, blk, j);                      /* saved value */
+        }
+    r = dptr->deposit (val, k, uptr, SIM_SW_REST);
+    if (r != SCPE_OK)
+        return r;
+    }
+return SCPE_OK;
+}
+
+static t_bool sim_mem_is_zero (const uint8 *blk, size_t len)
+{
+size_t i;
+
+for (i = 0; i < len; i++)
+    if (blk[i])
+        return FALSE;
+return TRUE;
+}
+
+t_stat sim_save (FILE *sfile)
+{
+void *mbuf, *region;
+const uint8 *blk;
+uint8 *zbuf = NULL;
+int32 l, t;
+uint32 i, j, b, device_count;
+t_addr k, high;
+t_value val;
+t_stat r;
+t_uint64 hash, *hashes;
+size_t sz;
+DEVICE *dptr;
+UNIT *uptr;
+REG *rptr;
+t_bool compress = ((sim_switches & SWMASK ('Z')) != 0);
+t_bool incremental = ((sim_switches & SWMASK ('I')) != 0);
+
+#define WRITE_I(xx) sim_fwrite (&(xx), sizeof (xx), 1, sfile)
+
+#if !defined (HAVE_ZLIB)
+if (compress)
+    return sim_messagef (SCPE_NOFNC, "Compressed SAVE requires a simulator built with zlib\n");
+#endif
+
+/* Don't make changes below without also changing save_vercur above */
 
 fprintf (sfile, "%s\n%s\n%s\n%s\n%s\n%.0f\n",
-    save_vercur,                                        /* [V2.5] save format */
+    (compress || incremental) ? save_ver41 : save_vercur,/* [V2.5] save format */
     sim_savename,                                       /* sim name */
     sim_si64, sim_sa64, eth_capabilities(),             /* [V3.5] options */
     sim_time);                                          /* [V3.2] sim time */
@@ -7932,32 +9136,69 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
              ((high = uptr->capac) != 0)) {             /* memory-like unit? */
             WRITE_I (high);                             /* [V2.5] write size */
             sz = SZ_D (dptr);
-            if ((mbuf = calloc (SRBSIZ, sz)) == NULL) {
+            region = (sim_vm_mem_region != NULL) ? sim_vm_mem_region (dptr, uptr) : NULL;
+            hashes = sim_mem_hashes (uptr, (uint32)((((high + dptr->aincr - 1) / dptr->aincr) + SRBSIZ - 1) / SRBSIZ));
+            mbuf = calloc (SRBSIZ, sz);
+#if defined (HAVE_ZLIB)
+            if (compress)
+                zbuf = (uint8 *)malloc (compressBound ((uLong)(SRBSIZ * sz)));
+#endif
+            if ((mbuf == NULL) || (compress && (zbuf == NULL))) {
+                free (mbuf);
+                free (zbuf);
                 fclose (sfile);
                 return SCPE_MEM;
                 }
-            for (k = 0; k < high; ) {                   /* loop thru mem */
-                zeroflg = TRUE;
-                for (l = 0; (l < SRBSIZ) && (k < high); l++,
-                     k = k + (dptr->aincr)) {           /* check for 0 block */
-                    r = dptr->examine (&val, k, uptr, SIM_SW_REST);
-                    if (r != SCPE_OK) {
-                        free (mbuf);
-                        return r;
-                        }
-                    if (val) zeroflg = FALSE;
-                    SZ_STORE (sz, val, mbuf, l);
-                    }                                   /* end for l */
-                if (zeroflg) {                          /* all zero's? */
-                    l = -l;                             /* invert block count */
-                    WRITE_I (l);                        /* write only count */
+            for (k = 0, b = 0; k < high; b++) {         /* loop thru mem */
+                blk = sim_mem_get_block (dptr, uptr, region, k, high, mbuf, &l, &r);
+                if (blk == NULL) {
+                    free (mbuf);
+                    free (zbuf);
+                    return r;
                     }
-                else {
+                k = k + l * dptr->aincr;
+                hash = sim_mem_hash (blk, l * sz);
+                if (sim_mem_is_zero (blk, l * sz)) {    /* all zero's? */
+                    t = -l;                             /* invert block count */
+                    WRITE_I (t);                        /* write only count */
+                    }
+                else if (incremental && hashes && (hashes[b] == hash)) {
+                    t = 0;                              /* unchanged block */
+                    WRITE_I (t);
+                    t = SR_BLK_SAME;
+                    WRITE_I (t);
                     WRITE_I (l);                        /* block count */
-                    sim_fwrite (mbuf, sz, l, sfile);
+                    WRITE_I (hash);
+                    }
+                else {
+#if defined (HAVE_ZLIB)
+                    uLongf zlen = compressBound ((uLong)(l * sz));
+
+                    if (compress &&
+                        (compress2 (zbuf, &zlen, blk, (uLong)(l * sz), Z_BEST_SPEED) == Z_OK) &&
+                        (zlen < l * sz)) {
+                        t = 0;                          /* deflated block */
+                        WRITE_I (t);
+                        t = SR_BLK_DEFLATE;
+                        WRITE_I (t);
+                        WRITE_I (l);                    /* block count */
+                        t = (int32)zlen;
+                        WRITE_I (t);                    /* deflated size */
+                        sim_fwrite (zbuf, 1, zlen, sfile);
+                        }
+                    else
+#endif
+                        {
+                        WRITE_I (l);                    /* block count */
+                        sim_fwrite (blk, 1, l * sz, sfile);
+                        }
                     }
+                if (hashes)
+                    hashes[b] = hash;
                 }                                       /* end for k */
             free (mbuf);                                /* dealloc buffer */
+            free (zbuf);
+            zbuf = NULL;
             }                                           /* end if mem */
         else {                                          /* no memory */
             high = 0;                                   /* write 0 */
@@ -8020,9 +9261,11 @@ char **attnames = NULL;
 UNIT **attunits = NULL;
 int32 *attswitches = NULL;
 int32 attcnt = 0;
-void *mbuf;
+void *mbuf, *region;
+uint8 *zbuf;
 int32 j, blkcnt, limit, unitno, time, flg;
-uint32 us, depth;
+uint32 us, depth, b;
+t_uint64 hash, *hashes;
 t_addr k, high, old_capac;
 t_value val, mask;
 t_stat r;
@@ -8053,7 +9296,8 @@ if (fstat (fileno (rfile), &rstat)) {
     }
 READ_S (buf);                                           /* [V2.5+] read version */
 v40 = v35 = v32 = FALSE;
-if (strcmp (buf, save_ver40) == 0)                      /* version 4.0? */
+if ((strcmp (buf, save_ver41) == 0) ||                  /* version 4.1 (-Z or -I)? */
+    (strcmp (buf, save_ver40) == 0))                    /* version 4.0? */
     v40 = v35 = v32 = TRUE;
 else if (strcmp (buf, save_ver35) == 0)                 /* version 3.5? */
     v35 = v32 = TRUE;
@@ -8063,7 +9307,7 @@ else if (strcmp (buf, save_ver30) != 0) {               /* version 3.0? */
     sim_printf ("Invalid file version: %s\n", buf);
     return SCPE_INCOMP;
     }
-if ((strcmp (buf, save_ver40) != 0) && (!sim_quiet) && (!suppress_warning)) {
+if (!v40 && (!sim_quiet) && (!suppress_warning)) {
     sim_printf ("warning - attempting to restore a saved simulator image in %s image format.\n", buf);
     warned = TRUE;
     }
@@ -8237,36 +9481,90 @@ for ( ;; ) {                                            /* device loop */
                 sim_printf ("\n");
                 }
             sz = SZ_D (dptr);                           /* allocate buffer */
-            if ((mbuf = calloc (SRBSIZ, sz)) == NULL) {
+            region = (sim_vm_mem_region != NULL) ? sim_vm_mem_region (dptr, uptr) : NULL;
+            hashes = sim_mem_hashes (uptr, (uint32)((((high + dptr->aincr - 1) / dptr->aincr) + SRBSIZ - 1) / SRBSIZ));
+            mbuf = calloc (SRBSIZ, sz);
+            zbuf = (uint8 *)calloc (SRBSIZ, sz);
+            if ((mbuf == NULL) || (zbuf == NULL)) {
+                free (mbuf);
+                free (zbuf);
                 r = SCPE_MEM;
                 goto Cleanup_Return;
                 }
-            for (k = 0; k < high; ) {                   /* loop thru mem */
-                if (sim_fread (&blkcnt, sizeof (blkcnt), 1, rfile) == 0) {/* block count */
-                    free (mbuf);
-                    r = SCPE_IOERR;
-                    goto Cleanup_Return;
+            for (k = 0, b = 0; k < high; b++) {         /* loop thru mem */
+                const uint8 *blk = (const uint8 *)mbuf;
+                int32 type = 0, zlen;
+#if defined (HAVE_ZLIB)
+                uLongf zsize;
+#endif
+
+                r = SCPE_IOERR;
+                if (sim_fread (&blkcnt, sizeof (blkcnt), 1, rfile) == 0)/* block count */
+                    break;
+                if (blkcnt == 0) {                      /* [V4.0+] encoded block? */
+                    if ((sim_fread (&type, sizeof (type), 1, rfile) == 0) ||
+                        (sim_fread (&limit, sizeof (limit), 1, rfile) == 0))
+                        break;
                     }
-                if (blkcnt < 0)                         /* compressed? */
-                    limit = -blkcnt;
-                else limit = (int32)sim_fread (mbuf, sz, blkcnt, rfile);
-                if (limit <= 0) {                       /* invalid or err? */
-                    free (mbuf);
-                    r = SCPE_IOERR;
-                    goto Cleanup_Return;
+                else
+                    limit = (blkcnt < 0) ? -blkcnt : blkcnt;
+                if ((limit <= 0) || (limit > SRBSIZ) ||   /* invalid? */
+                    (((high - k + dptr->aincr - 1) / dptr->aincr) < (t_addr)limit))
+                    break;
+                if (blkcnt < 0)                         /* zero block */
+                    blk = NULL;
+                else if (blkcnt > 0) {                  /* plain block */
+                    if (fread (mbuf, sz, limit, rfile) != (size_t)limit)
+                        break;
+                    }
+                else if (type == SR_BLK_DEFLATE) {      /* deflated block */
+                    if ((sim_fread (&zlen, sizeof (zlen), 1, rfile) == 0) ||
+                        (zlen <= 0) || (zlen > (int32)(SRBSIZ * sz)) ||
+                        (fread (zbuf, 1, zlen, rfile) != (size_t)zlen))
+                        break;
+#if defined (HAVE_ZLIB)
+                    zsize = (uLongf)(limit * sz);
+                    if ((uncompress ((Bytef *)mbuf, &zsize, zbuf, (uLong)zlen) != Z_OK) ||
+                        (zsize != limit * sz))
+                        break;
+#else
+                    r = sim_messagef (SCPE_NOFNC, "Can't restore compressed memory: %s%d (no zlib support)\n", sim_dname (dptr), unitno);
+                    break;
+#endif
                     }
-                for (j = 0; j < limit; j++, k = k + (dptr->aincr)) {
-                    if (blkcnt < 0)                     /* compressed? */
-                        val = 0;
-                    else SZ_LOAD (sz, val, mbuf, j);    /* saved value */
-                    r = dptr->deposit (val, k, uptr, SIM_SW_REST);
-                    if (r != SCPE_OK) {
-                        free (mbuf);
-                        goto Cleanup_Return;
+                else if (type == SR_BLK_SAME) {         /* unchanged block */
+                    if (sim_fread (&hash, sizeof (hash), 1, rfile) == 0)
+                        break;
+                    blk = sim_mem_get_block (dptr, uptr, region, k, k + limit * dptr->aincr, mbuf, &j, &r);
+                    if (blk == NULL)
+                        break;
+                    if (sim_mem_hash (blk, limit * sz) != hash) {
+                        r = sim_messagef (SCPE_INCOMP, "Incremental save doesn't match memory: %s%d\n"
+                                                       "Restore the save it was taken against first\n", sim_dname (dptr), unitno);
+                        break;
                         }
-                    }                                   /* end for j */
+                    if (hashes)
+                        hashes[b] = hash;
+                    k = k + limit * dptr->aincr;
+                    r = SCPE_OK;
+                    continue;
+                    }
+                else
+                    break;
+                if (hashes) {
+                    if (blk == NULL)
+                        memset (zbuf, 0, limit * sz);
+                    hashes[b] = sim_mem_hash ((blk == NULL) ? zbuf : blk, limit * sz);
+                    }
+                r = sim_mem_put_block (dptr, uptr, region, k, (uint8 *)blk, limit);
+                if (r != SCPE_OK)
+                    break;
+                k = k + limit * dptr->aincr;
                 }                                       /* end for k */
             free (mbuf);                                /* dealloc buffer */
+            free (zbuf);
+            if (k < high)                               /* incomplete? */
+                goto Cleanup_Return;
             }                                           /* end if high */
         }                                               /* end unit loop */
     for ( ;; ) {                                        /* register loop */
@@ -8588,6 +9886,7 @@ if (sim_log)                                            /* flush log if enabled
     fflush (sim_log);
 sim_throt_sched ();                                     /* set throttle */
 sim_start_timer_services ();                            /* enable wall clock timing */
+tmxr_start_poll ();                                     /* start asynch mux polling */
 
 do {
     t_addr *addrs;
@@ -11339,10 +12638,265 @@ return buf;
    and to see if further events need to be processed, or sim_interval
    reset to count the next one.
 
-   The event queue is maintained in clock order; entry timeouts are
-   RELATIVE to the time in the previous entry.
+   The event queue is maintained in clock order by one of two schedulers.
+   The LIST scheduler keeps the active units on a linked list where entry
+   timeouts are RELATIVE to the time in the previous entry.  The HEAP
+   scheduler keeps the active units in a binary min-heap ordered by
+   absolute queue time and then by activation sequence, so units due at
+   the same time fire in the order they were activated, exactly as they
+   do on the list.  In both cases sim_clock_queue points to the next unit
+   to fire and its time field holds the interval remaining until it fires
+   as of the last UPDATE_SIM_TIME.
+
+   Queue time advances with sim_interval but, like the delta encoded list,
+   snaps to an event's due time when that event is dispatched, so the two
+   schedulers produce identical sim_interval values.
+*/
+
+/* Heap scheduler support routines */
+
+static t_bool _sim_heap_before (UNIT *a, UNIT *b)
+{
+return ((a->q_time < b->q_time) ||
+        ((a->q_time == b->q_time) && (a->q_seq < b->q_seq)));
+}
+
+static void _sim_heap_place (int32 i, UNIT *uptr)
+{
+sim_heap[i] = uptr;
+uptr->q_index = i;
+}
+
+static void _sim_heap_up (int32 i)
+{
+UNIT *uptr = sim_heap[i];
+
+while (i > 0) {
+    int32 parent = (i - 1) / 2;
+
+    if (!_sim_heap_before (uptr, sim_heap[parent]))
+        break;
+    _sim_heap_place (i, sim_heap[parent]);
+    i = parent;
+    }
+_sim_heap_place (i, uptr);
+}
+
+static void _sim_heap_down (int32 i)
+{
+UNIT *uptr = sim_heap[i];
+
+while (1) {
+    int32 child = 2 * i + 1;
+
+    if (child >= sim_heap_count)
+        break;
+    if ((child + 1 < sim_heap_count) &&
+        _sim_heap_before (sim_heap[child + 1], sim_heap[child]))
+        ++child;
+    if (!_sim_heap_before (sim_heap[child], uptr))
+        break;
+    _sim_heap_place (i, sim_heap[child]);
+    i = child;
+    }
+_sim_heap_place (i, uptr);
+}
+
+static t_bool _sim_heap_contains (UNIT *uptr)
+{
+return ((uptr->q_index >= 0) && 
+        (uptr->q_index < sim_heap_count) && 
+        (sim_heap[uptr->q_index] == uptr));
+}
+
+/* Current queue time, valid immediately after UPDATE_SIM_TIME */
+
+static double _sim_heap_now (void)
+{
+if (sim_heap_count == 0)
+    return sim_heap_base;
+return sim_heap[0]->q_time - sim_heap[0]->time;
+}
+
+/* Publish the heap top as the head of the clock queue */
+
+static void _sim_heap_set_head (double now)
+{
+if (sim_heap_count == 0) {
+    sim_heap_base = now;
+    sim_clock_queue = QUEUE_LIST_END;
+    return;
+    }
+sim_clock_queue = sim_heap[0];
+sim_clock_queue->time = (int32)(sim_clock_queue->q_time - now);
+}
+
+static void _sim_heap_insert (UNIT *uptr, int32 event_time)
+{
+double now = _sim_heap_now ();
+
+if (sim_heap_count == sim_heap_size) {
+    sim_heap_size = (sim_heap_size == 0) ? 64 : 2 * sim_heap_size;
+    sim_heap = (UNIT **)realloc (sim_heap, sim_heap_size * sizeof (*sim_heap));
+    if (sim_heap == NULL) {
+        sim_printf ("Event heap allocation failed for %s\n", sim_uname (uptr));
+        abort ();
+        }
+    }
+uptr->q_time = now + event_time;
+uptr->q_seq = sim_heap_seq++;
+uptr->next = QUEUE_LIST_END;                            /* mark active */
+_sim_heap_place (sim_heap_count, uptr);
+_sim_heap_up (sim_heap_count++);
+_sim_heap_set_head (now);
+}
+
+static void _sim_heap_remove (UNIT *uptr, double now)
+{
+int32 i = uptr->q_index;
+UNIT *last = sim_heap[--sim_heap_count];
+
+if (last != uptr) {
+    _sim_heap_place (i, last);
+    _sim_heap_up (i);
+    _sim_heap_down (last->q_index);
+    }
+uptr->next = NULL;
+uptr->q_index = -1;
+_sim_heap_set_head (now);
+}
+
+static int _sim_heap_compare (const void *pa, const void *pb)
+{
+UNIT *a = *(UNIT * const *)pa;
+UNIT *b = *(UNIT * const *)pb;
+
+if (_sim_heap_before (a, b))
+    return -1;
+return _sim_heap_before (b, a) ? 1 : 0;
+}
+
+/* List scheduler insertion */
+
+static void _sim_list_insert (UNIT *uptr, int32 event_time)
+{
+UNIT *cptr, *prvptr;
+int32 accum;
+
+prvptr = NULL;
+accum = 0;
+for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
+    if (event_time < (accum + cptr->time))
+        break;
+    accum = accum + cptr->time;
+    prvptr = cptr;
+    }
+if (prvptr == NULL) {                                   /* insert at head */
+    cptr = uptr->next = sim_clock_queue;
+    sim_clock_queue = uptr;
+    }
+else {
+    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
+    prvptr->next = uptr;
+    }
+uptr->time = event_time - accum;
+if (cptr != QUEUE_LIST_END)
+    cptr->time = cptr->time - uptr->time;
+}
+
+/* sim_qlist - return the active units in the order they will fire
+
+   Inputs:
+        entries =       pointer to receive a malloc'ed array of units
+                        which the caller must free
+   Outputs:
+        count   =       number of entries in the array
+*/
+
+int32 sim_qlist (UNIT ***entries)
+{
+int32 cnt = sim_qcount ();
+UNIT *uptr;
+
+*entries = (UNIT **)calloc (cnt + 1, sizeof (**entries));
+if (*entries == NULL)
+    return 0;
+if (sim_queue_mode == SIM_QUEUE_HEAP) {
+    memcpy (*entries, sim_heap, cnt * sizeof (**entries));
+    qsort (*entries, cnt, sizeof (**entries), _sim_heap_compare);
+    }
+else {
+    cnt = 0;
+    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next)
+        (*entries)[cnt++] = uptr;
+    }
+return cnt;
+}
+
+/* sim_set_queue - select the event queue scheduler
+
+   Pending events are moved to the newly selected scheduler preserving
+   their due times and their relative order.
+*/
+
+t_stat sim_set_queue (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+int32 mode, cnt, i, accum;
+int32 *rtimes;
+UNIT **entries;
+double now;
+
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_2FARG;
+cptr = get_glyph (cptr, gbuf, 0);
+if (*cptr != 0)
+    return SCPE_2MARG;
+if (MATCH_CMD (gbuf, "HEAP") == 0)
+    mode = SIM_QUEUE_HEAP;
+else {
+    if (MATCH_CMD (gbuf, "LIST") == 0)
+        mode = SIM_QUEUE_LIST;
+    else
+        return sim_messagef (SCPE_ARG, "Unknown event queue scheduler: %s\n", gbuf);
+    }
+if (mode == sim_queue_mode)
+    return SCPE_OK;
+UPDATE_SIM_TIME;                                        /* update sim time */
+cnt = sim_qlist (&entries);
+rtimes = (int32 *)calloc (cnt + 1, sizeof (*rtimes));
+if ((entries == NULL) || (rtimes == NULL)) {
+    free (entries);
+    free (rtimes);
+    return SCPE_MEM;
+    }
+now = _sim_heap_now ();
+for (i = accum = 0; i < cnt; i++) {                     /* capture due times */
+    if (sim_queue_mode == SIM_QUEUE_HEAP)
+        rtimes[i] = (int32)(entries[i]->q_time - now);
+    else
+        rtimes[i] = accum = accum + entries[i]->time;
+    entries[i]->next = NULL;
+    entries[i]->time = 0;
+    entries[i]->q_index = -1;
+    }
+sim_clock_queue = QUEUE_LIST_END;
+sim_heap_count = 0;
+sim_queue_mode = mode;
+for (i = 0; i < cnt; i++) {                             /* requeue in firing order */
+    if (sim_queue_mode == SIM_QUEUE_HEAP)
+        _sim_heap_insert (entries[i], rtimes[i]);
+    else
+        _sim_list_insert (entries[i], rtimes[i]);
+    }
+free (entries);
+free (rtimes);
+if (!sim_quiet)
+    sim_printf ("Event queue using %s scheduler\n", (sim_queue_mode == SIM_QUEUE_HEAP) ? "HEAP" : "LIST");
+return SCPE_OK;
+}
 
-   sim_process_event - process event
+/* sim_process_event - process event
 
    Inputs:
         none
@@ -11371,8 +12925,12 @@ if (sim_clock_queue == QUEUE_LIST_END) {                /* queue empty? */
 sim_processing_event = TRUE;
 do {
     uptr = sim_clock_queue;                             /* get first */
-    sim_clock_queue = uptr->next;                       /* remove first */
-    uptr->next = NULL;                                  /* hygiene */
+    if (sim_queue_mode == SIM_QUEUE_HEAP)
+        _sim_heap_remove (uptr, uptr->q_time);          /* remove first */
+    else {
+        sim_clock_queue = uptr->next;                   /* remove first */
+        uptr->next = NULL;                              /* hygiene */
+        }
     sim_interval -= uptr->time;
     uptr->time = 0;
     if (sim_clock_queue != QUEUE_LIST_END)
@@ -11386,6 +12944,7 @@ do {
         }
     else {
         sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Processing Event for %s\n", sim_uname (uptr));
+        ++sim_events_processed;
         if (uptr->action != NULL)
             reason = uptr->action (uptr);
         else
@@ -11441,9 +13000,6 @@ return _sim_activate (uptr, event_time);
 
 t_stat _sim_activate (UNIT *uptr, int32 event_time)
 {
-UNIT *cptr, *prvptr;
-int32 accum;
-
 AIO_ACTIVATE (_sim_activate, uptr, event_time);
 if (sim_is_active (uptr))                               /* already active? */
     return SCPE_OK;
@@ -11451,25 +13007,10 @@ UPDATE_SIM_TIME;                                        /* update sim time */
 
 sim_debug (SIM_DBG_ACTIVATE, &sim_scp_dev, "Activating %s delay=%d\n", sim_uname (uptr), event_time);
 
-prvptr = NULL;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (event_time < (accum + cptr->time))
-        break;
-    accum = accum + cptr->time;
-    prvptr = cptr;
-    }
-if (prvptr == NULL) {                                   /* insert at head */
-    cptr = uptr->next = sim_clock_queue;
-    sim_clock_queue = uptr;
-    }
-else {
-    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
-    prvptr->next = uptr;
-    }
-uptr->time = event_time - accum;
-if (cptr != QUEUE_LIST_END)
-    cptr->time = cptr->time - uptr->time;
+if (sim_queue_mode == SIM_QUEUE_HEAP)
+    _sim_heap_insert (uptr, event_time);
+else
+    _sim_list_insert (uptr, event_time);
 sim_interval = sim_clock_queue->time;
 return SCPE_OK;
 }
@@ -11586,7 +13127,13 @@ UPDATE_SIM_TIME;                                        /* update sim time */
 sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Canceling Event for %s\n", sim_uname(uptr));
 nptr = QUEUE_LIST_END;
 
-if (sim_clock_queue == uptr) {
+if (sim_queue_mode == SIM_QUEUE_HEAP) {
+    if (_sim_heap_contains (uptr)) {
+        _sim_heap_remove (uptr, _sim_heap_now ());
+        uptr->time = 0;
+        }
+    }
+else if (sim_clock_queue == uptr) {
     nptr = sim_clock_queue = uptr->next;
     uptr->next = NULL;                                  /* hygiene */
     }
@@ -11645,6 +13192,12 @@ int32 _sim_activate_queue_time (UNIT *uptr)
 UNIT *cptr;
 int32 accum;
 
+if (sim_queue_mode == SIM_QUEUE_HEAP) {
+    if (!_sim_heap_contains (uptr))
+        return 0;
+    accum = (sim_interval > 0) ? sim_interval : 0;
+    return accum + (int32)(uptr->q_time - sim_heap[0]->q_time) + 1;
+    }
 accum = 0;
 for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
     if (cptr == sim_clock_queue) {
@@ -11681,7 +13234,6 @@ return _sim_activate_time (uptr);
 
 double sim_activate_time_usecs (UNIT *uptr)
 {
-UNIT *cptr;
 int32 accum;
 double result;
 
@@ -11689,17 +13241,9 @@ AIO_VALIDATE(uptr);
 result = sim_timer_activate_time_usecs (uptr);
 if (result >= 0)
     return result;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return 1.0 + uptr->usecs_remaining + ((1000000.0 * accum) / sim_timer_inst_per_sec ());
-    }
+accum = _sim_activate_queue_time (uptr);
+if (accum)
+    return 1.0 + uptr->usecs_remaining + ((1000000.0 * (accum - 1)) / sim_timer_inst_per_sec ());
 return 0.0;
 }
 
@@ -11737,6 +13281,8 @@ int32 sim_qcount (void)
 int32 cnt;
 UNIT *uptr;
 
+if (sim_queue_mode == SIM_QUEUE_HEAP)
+    return sim_heap_count;
 cnt = 0;
 for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next)
     cnt++;
@@ -11762,6 +13308,17 @@ return cnt;
    is the bitwise OR of all the type fields).  A simulator need only check for
    a breakpoint of type X if bit SWMASK('X') is set in sim_brk_summ.
 
+   Since sim_brk_test is called on every instruction once any breakpoint is
+   set, two derived structures keep the common no-hit case cheap.
+   sim_brk_pgmap is indexed by a hash of the address page (2**SIM_BRK_PG_V
+   addresses) and holds the OR of the types of all breakpoints falling in
+   the pages sharing that slot; a zero intersection with the requested types
+   rejects the address with a single load.  Addresses passing the filter are
+   looked up in sim_brk_hash, an open addressed (linear probe) table of
+   the breakpoint list heads, rather than by binary search.  A new
+   breakpoint is added to both as it is inserted; they are only rebuilt by
+   sim_brk_rehash when the hash table has to grow or breakpoints are cleared.
+
    The package contains the following public routines:
 
         sim_brk_init            initialize
@@ -11800,11 +13357,60 @@ if (sim_brk_tab == NULL)
     return SCPE_MEM;
 memset (sim_brk_tab, 0, sim_brk_lnt*sizeof (BRKTAB*));
 sim_brk_ent = sim_brk_ins = 0;
+sim_brk_rehash ();
 sim_brk_clract ();
 sim_brk_npc (0);
 return SCPE_OK;
 }
 
+/* Breakpoint hash and page filter */
+
+static uint32 sim_brk_hash_fn (t_addr loc)
+{
+uint32 h = (uint32)loc ^ (uint32)((loc >> 16) >> 16);   /* fold wide addresses */
+
+return (h * 2654435761u) >> (32 - sim_brk_hash_bits);   /* Fibonacci hash */
+}
+
+#define SIM_BRK_PG(loc) ((uint32)(((loc) >> SIM_BRK_PG_V) ^ ((loc) >> (SIM_BRK_PG_V + 12))) & (SIM_BRK_PG_N - 1))
+
+/* Enter a breakpoint list head in the hash and the page filter, replacing
+   any previous head for the same address */
+
+static void sim_brk_hash_add (BRKTAB *head)
+{
+uint32 h, mask = (1u << sim_brk_hash_bits) - 1;
+BRKTAB *bp;
+
+for (h = sim_brk_hash_fn (head->addr); sim_brk_hash[h] != NULL; h = (h + 1) & mask)
+    if (sim_brk_hash[h]->addr == head->addr)
+        break;
+sim_brk_hash[h] = head;
+for (bp = head; bp; bp = bp->next)
+    sim_brk_pgmap[SIM_BRK_PG (head->addr)] |= bp->typ;
+}
+
+static void sim_brk_rehash (void)
+{
+int32 i;
+uint32 bits;
+
+memset (sim_brk_pgmap, 0, sizeof (sim_brk_pgmap));
+for (bits = 4; (1u << bits) < (2 * (uint32)sim_brk_ent); bits++)
+    ;                                                   /* load factor <= 1/2 */
+if (bits != sim_brk_hash_bits) {
+    free (sim_brk_hash);
+    sim_brk_hash = (BRKTAB **) calloc ((size_t)1 << bits, sizeof (*sim_brk_hash));
+    sim_brk_hash_bits = (sim_brk_hash == NULL) ? 0 : bits;
+    }
+else
+    memset (sim_brk_hash, 0, ((size_t)1 << bits) * sizeof (*sim_brk_hash));
+if (sim_brk_hash == NULL)                               /* no memory? */
+    return;                                             /* binary search only */
+for (i = 0; i < sim_brk_ent; i++)
+    sim_brk_hash_add (sim_brk_tab[i]);
+}
+
 /* Search for a breakpoint in the sorted breakpoint table */
 
 BRKTAB *sim_brk_fnd (t_addr loc)
@@ -11840,8 +13446,20 @@ return NULL;
 
 BRKTAB *sim_brk_fnd_ex (t_addr loc, uint32 btyp, t_bool any_typ, uint32 spc)
 {
-BRKTAB *bp = sim_brk_fnd (loc);
+BRKTAB *bp;
+
+if (sim_brk_hash == NULL)                               /* no hash? */
+    bp = sim_brk_fnd (loc);                             /* binary search */
+else {
+    uint32 h, mask = (1u << sim_brk_hash_bits) - 1;
 
+    if (any_typ && ((sim_brk_pgmap[SIM_BRK_PG (loc)] & btyp) == 0))
+        return NULL;                                    /* filtered out */
+    for (h = sim_brk_hash_fn (loc); (bp = sim_brk_hash[h]) != NULL; h = (h + 1) & mask) {
+        if (bp->addr == loc)
+            break;
+        }
+    }
 while (bp) {
     if (any_typ ? ((bp->typ & btyp) && (bp->time_fired[spc] != sim_gtime())) : 
                   (bp->typ == btyp))
@@ -11889,6 +13507,11 @@ bp->cnt = 0;
 bp->act = NULL;
 for (i = 0; i < SIM_BKPT_N_SPC; i++)
     bp->time_fired[i] = -1.0;
+if ((sim_brk_hash == NULL) ||                           /* hash too full? */
+    ((1u << sim_brk_hash_bits) < (2 * (uint32)sim_brk_ent)))
+    sim_brk_rehash ();                                  /* grow it */
+else
+    sim_brk_hash_add (bp);                              /* new list head */
 return bp;
 }
 
@@ -11939,6 +13562,11 @@ return SCPE_OK;
 
 t_stat sim_brk_clr (t_addr loc, int32 sw)
 {
+return _sim_brk_clr (loc, sw, TRUE);
+}
+
+static t_stat _sim_brk_clr (t_addr loc, int32 sw, t_bool rebuild)
+{
 BRKTAB *bpl = NULL;
 BRKTAB *bp = sim_brk_fnd (loc);
 int32 i;
@@ -11968,6 +13596,19 @@ if (sim_brk_tab[sim_brk_ins] == NULL) {                 /* erased entry */
     for (i = sim_brk_ins; i < sim_brk_ent; i++)         /* shuffle remaining entries */
         sim_brk_tab[i] = sim_brk_tab[i+1];
     }
+if (rebuild)
+    sim_brk_rebuild ();
+return SCPE_OK;
+}
+
+/* Rebuild the lookup structures and the type summary after clearing */
+
+static void sim_brk_rebuild (void)
+{
+int32 i;
+BRKTAB *bp;
+
+sim_brk_rehash ();                                      /* rebuild lookup */
 sim_brk_summ = 0;                                       /* recalc summary */
 for (i = 0; i < sim_brk_ent; i++) {
     bp = sim_brk_tab[i];
@@ -11976,7 +13617,6 @@ for (i = 0; i < sim_brk_ent; i++) {
         bp = bp->next;
         }
     }
-return SCPE_OK;
 }
 
 /* Clear all breakpoints */
@@ -11989,11 +13629,12 @@ if (sw == 0)
     sw = SIM_BRK_ALLTYP;
 for (i = 0; i < sim_brk_ent;) {
     t_addr loc = sim_brk_tab[i]->addr;
-    sim_brk_clr (loc, sw);
+    _sim_brk_clr (loc, sw, FALSE);
     if ((i < sim_brk_ent) && 
         (loc == sim_brk_tab[i]->addr))
         ++i;
     }
+sim_brk_rebuild ();                                     /* once for all of them */
 return SCPE_OK;
 }
 
@@ -12307,6 +13948,16 @@ return msg;
         buf                     the buffer of output data which has been produced
         buf_ins                 the buffer insertion point for the next output data
         buf_size                the buffer size
+        matcher                 the literal rule matcher
+
+   Literal (non RegEx) rules are matched by a single Aho-Corasick automaton
+   built from all of the literal rules, so the cost of each byte of output
+   doesn't depend on the number of rules or on their lengths.  Each state
+   records the lowest numbered rule which matches when the state is
+   reached, which preserves the rule precedence of checking the rules in
+   order.  The automaton is discarded whenever the rules change and is
+   rebuilt (and primed with the data already in the buffer) when the next
+   output byte is checked.
 
    The package contains the following public routines:
 
@@ -12406,6 +14057,119 @@ for (i=start_rule; i<exp->size; i++)
 return NULL;
 }
 
+/* Literal rule matcher */
+
+#define EXP_ALPHABET    256
+
+struct EXPMATCH {
+    int32               states;                         /* number of states */
+    int32               state;                          /* current state */
+    int32               *next;                          /* transitions [states][EXP_ALPHABET] */
+    int32               *rule;                          /* lowest rule matched entering state (-1 if none) */
+    int32               regex_first;                    /* lowest numbered RegEx rule */
+    };
+
+static void sim_exp_free_matcher (EXPECT *exp)
+{
+if (exp->matcher == NULL)
+    return;
+free (exp->matcher->next);
+free (exp->matcher->rule);
+free (exp->matcher);
+exp->matcher = NULL;
+}
+
+static struct EXPMATCH *sim_exp_build_matcher (EXPECT *exp)
+{
+struct EXPMATCH *m = (struct EXPMATCH *)calloc (1, sizeof (*m));
+int32 *fail = NULL, *queue = NULL;
+int32 i, c, s, t, head, tail, states;
+uint32 j, total = 1;
+
+if (m == NULL)
+    return NULL;
+m->regex_first = exp->size;
+for (i = 0; i < exp->size; i++) {
+    if (exp->rules[i].switches & EXP_TYP_REGEX) {
+        if (m->regex_first == exp->size)
+            m->regex_first = i;
+        }
+    else
+        total += exp->rules[i].size;
+    }
+m->next = (int32 *)malloc (total * EXP_ALPHABET * sizeof (*m->next));
+m->rule = (int32 *)malloc (total * sizeof (*m->rule));
+fail = (int32 *)calloc (total, sizeof (*fail));
+queue = (int32 *)malloc (total * sizeof (*queue));
+if ((m->next == NULL) || (m->rule == NULL) || (fail == NULL) || (queue == NULL)) {
+    free (fail);
+    free (queue);
+    free (m->next);
+    free (m->rule);
+    free (m);
+    return NULL;
+    }
+for (j = 0; j < total * EXP_ALPHABET; j++)
+    m->next[j] = -1;
+m->rule[0] = -1;
+states = 1;
+for (i = 0; i < exp->size; i++) {                       /* build the trie */
+    EXPTAB *ep = &exp->rules[i];
+
+    if (ep->switches & EXP_TYP_REGEX)
+        continue;
+    for (j = s = 0; j < ep->size; j++) {
+        t = m->next[s * EXP_ALPHABET + ep->match[j]];
+        if (t < 0) {
+            t = states++;
+            m->rule[t] = -1;
+            m->next[s * EXP_ALPHABET + ep->match[j]] = t;
+            }
+        s = t;
+        }
+    if (m->rule[s] < 0)                                 /* first rule with this string wins */
+        m->rule[s] = i;
+    }
+head = tail = 0;
+for (c = 0; c < EXP_ALPHABET; c++) {                    /* depth 1 states fail to the root */
+    t = m->next[c];
+    if (t < 0)
+        m->next[c] = 0;
+    else {
+        fail[t] = 0;
+        queue[tail++] = t;
+        }
+    }
+while (head < tail) {                                   /* breadth first fill in */
+    s = queue[head++];
+    t = m->rule[fail[s]];                               /* inherit matches of the longest suffix */
+    if ((t >= 0) && ((m->rule[s] < 0) || (t < m->rule[s])))
+        m->rule[s] = t;
+    for (c = 0; c < EXP_ALPHABET; c++) {
+        t = m->next[s * EXP_ALPHABET + c];
+        if (t < 0)
+            m->next[s * EXP_ALPHABET + c] = m->next[fail[s] * EXP_ALPHABET + c];
+        else {
+            fail[t] = m->next[fail[s] * EXP_ALPHABET + c];
+            queue[tail++] = t;
+            }
+        }
+    }
+free (fail);
+free (queue);
+m->states = states;
+m->state = 0;
+/* Prime with the data collected since the last match */
+if (exp->buf_data > exp->buf_ins) {                     /* wrapped? */
+    for (j = exp->buf_size - (exp->buf_data - exp->buf_ins); j < exp->buf_size; j++)
+        m->state = m->next[m->state * EXP_ALPHABET + exp->buf[j]];
+    }
+for (j = exp->buf_ins - ((exp->buf_data > exp->buf_ins) ? exp->buf_ins : exp->buf_data); j < exp->buf_ins; j++)
+    m->state = m->next[m->state * EXP_ALPHABET + exp->buf[j]];
+sim_debug (exp->dbit, exp->dptr, "Built literal matcher with %d states for %d rules\n", states, exp->size);
+return m;
+}
+
 /* Clear (delete) an expect rule */
 
 t_stat sim_exp_clr_tab (EXPECT *exp, EXPTAB *ep)
@@ -12414,6 +14178,7 @@ int32 i;
 
 if (!ep)                                                /* not there? ok */
     return SCPE_OK;
+sim_exp_free_matcher (exp);                             /* rules are changing */
 free (ep->match);                                       /* deallocate match string */
 free (ep->match_pattern);                               /* deallocate the display format match string */
 free (ep->act);                                         /* deallocate action */
@@ -12460,6 +14225,7 @@ for (i=0; i<exp->size; i++) {
 free (exp->rules);
 exp->rules = NULL;
 exp->size = 0;
+sim_exp_free_matcher (exp);
 free (exp->buf);
 exp->buf = NULL;
 exp->buf_size = 0;
@@ -12522,6 +14288,7 @@ for (i=0; i<exp->size; i++) {                           /* Make sure this rule w
     }
 if (after && exp->size)
     return sim_messagef (SCPE_ARG, "Multiple concurrent EXPECT rules aren't valid when a HALTAFTER parameter is non-zero\n");
+sim_exp_free_matcher (exp);                             /* rules are changing */
 exp->rules = (EXPTAB *) realloc (exp->rules, sizeof (*exp->rules)*(exp->size + 1));
 ep = &exp->rules[exp->size];
 exp->size += 1;
@@ -12581,7 +14348,18 @@ if ((act != NULL) && (*act != 0)) {                     /* new action? */
 for (i=0; i<exp->size; i++) {
     uint32 compare_size = (exp->rules[i].switches & EXP_TYP_REGEX) ? MAX(10 * strlen(ep->match_pattern), 1024) : exp->rules[i].size;
     if (compare_size >= exp->buf_size) {
-        exp->buf = (uint8 *)realloc (exp->buf, compare_size + 2); /* Extra byte to null terminate regex compares */
+        uint8 *buf = (uint8 *)malloc (compare_size + 2); /* Extra byte to null terminate regex compares */
+        uint32 older = (exp->buf_data > exp->buf_ins) ? exp->buf_data - exp->buf_ins : 0;
+
+        if (buf == NULL)
+            return SCPE_MEM;
+        if (older)                                      /* unwrap the collected data */
+            memcpy (buf, &exp->buf[exp->buf_size - older], older);
+        if (exp->buf_ins)
+            memcpy (&buf[older], exp->buf, exp->buf_ins);
+        free (exp->buf);
+        exp->buf = buf;
+        exp->buf_ins += older;
         exp->buf_size = compare_size + 1;
         }
     }
@@ -12664,21 +14442,41 @@ return SCPE_OK;
 
 t_stat sim_exp_check (EXPECT *exp, uint8 data)
 {
-int32 i;
+int32 i, literal;
 EXPTAB *ep = NULL;
 int regex_checks = 0;
 char *tstr = NULL;
+struct EXPMATCH *m;
 
 if ((!exp) || (!exp->rules))                            /* Anying to check? */
     return SCPE_OK;
 
+if (exp->matcher == NULL) {                             /* Rules changed? */
+    exp->matcher = sim_exp_build_matcher (exp);
+    if (exp->matcher == NULL)
+        return SCPE_MEM;
+    }
+m = exp->matcher;
+m->state = m->next[m->state * EXP_ALPHABET + data];     /* Advance literal matcher */
+literal = m->rule[m->state];                            /* Lowest literal rule matched (-1 none) */
+
 exp->buf[exp->buf_ins++] = data;                        /* Save new data */
 exp->buf[exp->buf_ins] = '\0';                          /* Nul terminate for RegEx match */
 if (exp->buf_data < exp->buf_size)
     ++exp->buf_data;                                    /* Record amount of data in buffer */
 
-for (i=0; i < exp->size; i++) {
+i = ((literal >= 0) && (literal < m->regex_first)) ? literal : m->regex_first;
+for ( ; i < exp->size; i++) {
     ep = &exp->rules[i];
+    if (i == literal) {                                 /* Literal rule matched? */
+        if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
+            char *mstr = sim_encode_quoted_string (ep->match, ep->size);
+
+            sim_debug (exp->dbit, exp->dptr, "Matched Data: %s\n", mstr);
+            free (mstr);
+            }
+        break;
+        }
     if (ep->switches & EXP_TYP_REGEX) {
 #if defined (USE_REGEX)
         int *ovector = NULL;
@@ -12736,55 +14534,6 @@ for (i=0; i < exp->size; i++) {
         free (ovector);
 #endif
         }
-    else {
-        if (exp->buf_data < ep->size)                           /* Too little data to match yet? */
-            continue;                                           /* Yes, Try next one. */
-        if (exp->buf_ins < ep->size) {                          /* Match might stradle end of buffer */
-            /* 
-             * First compare the newly deposited data at the beginning 
-             * of buffer with the end of the match string
-             */
-            if (exp->buf_ins) {
-                if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                    char *estr = sim_encode_quoted_string (exp->buf, exp->buf_ins);
-                    char *mstr = sim_encode_quoted_string (&ep->match[ep->size-exp->buf_ins], exp->buf_ins);
-
-                    sim_debug (exp->dbit, exp->dptr, "Checking String[0:%d]: %s\n", exp->buf_ins, estr);
-                    sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                    free (estr);
-                    free (mstr);
-                    }
-                if (memcmp (exp->buf, &ep->match[ep->size-exp->buf_ins], exp->buf_ins)) /* Tail Match? */
-                    continue;                                   /* Nope, Try next one. */
-                }
-            if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                char *estr = sim_encode_quoted_string (&exp->buf[exp->buf_size-(ep->size-exp->buf_ins)], ep->size-exp->buf_ins);
-                char *mstr = sim_encode_quoted_string (ep->match, ep->size-exp->buf_ins);
-
-                sim_debug (exp->dbit, exp->dptr, "Checking String[%d:%d]: %s\n", exp->buf_size-(ep->size-exp->buf_ins), ep->size-exp->buf_ins, estr);
-                sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                free (estr);
-                free (mstr);
-                }
-            if (memcmp (&exp->buf[exp->buf_size-(ep->size-exp->buf_ins)], ep->match, ep->size-exp->buf_ins)) /* Front Match? */
-                continue;                                       /* Nope, Try next one. */
-            break;
-            }
-        else {
-            if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                char *estr = sim_encode_quoted_string (&exp->buf[exp->buf_ins-ep->size], ep->size);
-                char *mstr = sim_encode_quoted_string (ep->match, ep->size);
-
-                sim_debug (exp->dbit, exp->dptr, "Checking String[%d:%d]: %s\n", exp->buf_ins-ep->size, ep->size, estr);
-                sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                free (estr);
-                free (mstr);
-                }
-            if (memcmp (&exp->buf[exp->buf_ins-ep->size], ep->match, ep->size)) /* Whole string match? */
-                continue;                                       /* Nope, Try next one. */
-            break;
-            }
-        }
     }
 if (exp->buf_ins == exp->buf_size) {                    /* At end of match buffer? */
     if (regex_checks) {
@@ -12835,6 +14584,8 @@ if (i != exp->size) {                                   /* Found? */
         }
     /* Matched data is no longer available for future matching */
     exp->buf_data = exp->buf_ins = 0;
+    if (exp->matcher)
+        exp->matcher->state = 0;
     }
 free (tstr);
 return SCPE_OK;
@@ -13017,6 +14768,9 @@ while (len > 0) {
     }
 }
 
+static void _debt_text (const char *buf, size_t len);
+static void _debt_flush (void);
+
 /*
  * Optionally filter debug output to summarize duplicate debug lines
  */
@@ -13024,6 +14778,11 @@ static void _sim_debug_write_flush (const char *buf, size_t len, t_bool flush)
 {
 char *eol;
 
+if (sim_deb_switches & SWMASK ('Z')) {              /* binary trace? */
+    if (len > 0)
+        _debt_text (buf, len);                      /* record as text */
+    return;
+    }
 if (sim_deb_switches & SWMASK ('F')) {              /* filtering disabled? */
     if (len > 0)
         _debug_fwrite (buf, len);                   /* output now. */
@@ -13118,6 +14877,11 @@ if (sim_deb == NULL)                                    /* no debug? */
 
 _sim_debug_write_flush ("", 0, TRUE);
 
+if (sim_deb_switches & SWMASK ('Z')) {                  /* binary trace? */
+    _debt_flush ();                                     /* write what's recorded */
+    fflush (sim_deb);
+    return SCPE_OK;
+    }
 if (sim_deb == sim_log) {                               /* debug is log */
     fflush (sim_deb);                                   /* fflush is the best we can do */
     return SCPE_OK;
@@ -13166,28 +14930,36 @@ return some_match ? some_match : debtab_nomatch;
 
 /* Prints standard debug prefix unless previous call unterminated */
 
-static const char *sim_debug_prefix (uint32 dbits, DEVICE* dptr, UNIT* uptr)
+static void _sim_debug_format_prefix (char *buf, int32 switches, struct timespec *time_now, struct timespec *basetime,
+                                      double gtime, const char *pc_s, t_bool aux, const char *dname, const char *debug_type)
 {
-const char* debug_type = _get_dbg_verb (dbits, dptr, uptr);
 char tim_t[32] = "";
 char tim_a[32] = "";
-char pc_s[64] = "";
-struct timespec time_now;
 
-if (sim_deb_switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A'))) {
-    clock_gettime(CLOCK_REALTIME, &time_now);
-    if (sim_deb_switches & SWMASK ('R'))
-        sim_timespec_diff (&time_now, &time_now, &sim_deb_basetime);
-    if (sim_deb_switches & SWMASK ('T')) {
-        time_t tnow = (time_t)time_now.tv_sec;
+if (switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A'))) {
+    if (switches & SWMASK ('R'))
+        sim_timespec_diff (time_now, time_now, basetime);
+    if (switches & SWMASK ('T')) {
+        time_t tnow = (time_t)time_now->tv_sec;
         struct tm *now = localtime(&tnow);
 
-        sprintf(tim_t, "%02d:%02d:%02d.%03d ", now->tm_hour, now->tm_min, now->tm_sec, (int)(time_now.tv_nsec/1000000));
+        sprintf(tim_t, "%02d:%02d:%02d.%03d ", now->tm_hour, now->tm_min, now->tm_sec, (int)(time_now->tv_nsec/1000000));
         }
-    if (sim_deb_switches & SWMASK ('A')) {
-        sprintf(tim_t, "%" LL_FMT "d.%03d ", (LL_TYPE)(time_now.tv_sec), (int)(time_now.tv_nsec/1000000));
+    if (switches & SWMASK ('A')) {
+        sprintf(tim_t, "%" LL_FMT "d.%03d ", (LL_TYPE)(time_now->tv_sec), (int)(time_now->tv_nsec/1000000));
         }
     }
+sprintf(buf, "DBG(%s%s%.0f%s)%s> %s %s: ", tim_t, tim_a, gtime, pc_s, aux ? "+" : "", dname, debug_type);
+}
+
+static const char *sim_debug_prefix (uint32 dbits, DEVICE* dptr, UNIT* uptr)
+{
+const char* debug_type = _get_dbg_verb (dbits, dptr, uptr);
+char pc_s[64] = "";
+struct timespec time_now;
+
+if (sim_deb_switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A')))
+    clock_gettime(CLOCK_REALTIME, &time_now);
 if (sim_deb_switches & SWMASK ('P')) {
     t_value val;
     
@@ -13204,10 +14976,918 @@ if (sim_deb_switches & SWMASK ('P')) {
     sprintf(pc_s, "-%s:", sim_PC->name);
     sprint_val (&pc_s[strlen(pc_s)], val, sim_PC->radix, sim_PC->width, sim_PC->flags & REG_FMT);
     }
-sprintf(debug_line_prefix, "DBG(%s%s%.0f%s)%s> %s %s: ", tim_t, tim_a, sim_gtime(), pc_s, AIO_MAIN_THREAD ? "" : "+", dptr->name, debug_type);
+_sim_debug_format_prefix (debug_line_prefix, sim_deb_switches, &time_now, &sim_deb_basetime,
+                          sim_gtime(), pc_s, !AIO_MAIN_THREAD, dptr->name, debug_type);
 return debug_line_prefix;
 }
 
+/* Binary debug trace
+
+   When debug output is enabled with the -Z switch, sim_debug messages are
+   not formatted when they are generated.  Instead a record holding the time
+   stamps, the device, the debug bits, a format identifier and the raw
+   argument values is placed in a memory ring, and a writer thread drains the
+   rings to the debug file.  The main (simulation) thread has a ring of its
+   own which it fills without taking any lock; messages from other threads
+   share a second ring whose producers are serialized by a mutex.  When a
+   ring is full, records are dropped and counted, and the count is recorded
+   as soon as there is room again.
+
+   Format strings, device names and debug flag names are identified by their
+   address and described once, by a definition record, the first time they
+   are used.  Arguments are captured as directed by the conversions in the
+   format.  Messages whose format can't be captured (%n, long double, too
+   many arguments) are formatted immediately and recorded as a string, as is
+   output arriving through the other debug output routines.
+
+   Every record starts with a magic number and its length.  Anything else in
+   the file (text written directly to sim_deb by device code, the banner
+   written by SET DEBUG) is passed through as is by the decoder.  SHOW DEBUG
+   DECODE file renders a trace file as the text output would have appeared,
+   without summarizing duplicate lines.  Records are in host byte order.
+*/
+
+#define DEBT_MAGIC      0x47424453                      /* "SDBG" */
+#define DEBT_RINGSIZE   (16 * 1024 * 1024)              /* ring size (power of 2) */
+#define DEBT_MAXREC     4096                            /* max record length */
+#define DEBT_MAXARGS    16                              /* max captured args */
+#define DEBT_DEFS       4096                            /* definition slots (power of 2) */
+#define DEBT_WAIT_MS    20                              /* writer poll interval */
+
+#define DEBT_R_PAD      0                               /* record types */
+#define DEBT_R_HDR      1
+#define DEBT_R_DEF      2
+#define DEBT_R_MSG      3
+#define DEBT_R_TEXT     4
+#define DEBT_R_DROP     5
+
+#define DEBT_F_AUX      1                               /* not the main thread */
+#define DEBT_F_CONT     2                               /* continues unterminated line */
+#define DEBT_F_PC       4                               /* pc valid */
+
+#define DEBT_A_INT      1                               /* argument types */
+#define DEBT_A_LONG     2
+#define DEBT_A_LLONG    3
+#define DEBT_A_SIZE     4
+#define DEBT_A_DBL      5
+#define DEBT_A_STR      6
+#define DEBT_A_PTR      7
+
+#if defined(__GNUC__)
+#define DEBT_BARRIER    __sync_synchronize ()
+#elif defined(_WIN32)
+#define DEBT_BARRIER    MemoryBarrier ()
+#else
+#define DEBT_BARRIER
+#endif
+
+typedef struct {
+    uint32      magic;                                  /* DEBT_MAGIC */
+    uint32      len;                                    /* record length, multiple of 8 */
+    uint8       type;                                   /* record type */
+    uint8       flags;                                  /* DEBT_F_xxx */
+    uint16      nargs;                                  /* argument slots */
+    uint32      id;                                     /* format id, count, length */
+    uint32      dev;                                    /* device name id */
+    uint32      verb;                                   /* debug flag name id */
+    uint32      dbits;                                  /* debug bits */
+    uint32      spare;
+    double      gtime;                                  /* simulated time */
+    t_int64     wsec;                                   /* wall clock time */
+    t_int64     wnsec;
+    t_uint64    pc;                                     /* PC when -P */
+    } DEBT_REC;
+
+typedef struct {
+    const char  *key;                                   /* address identifying text */
+    char        *text;                                  /* copy of text */
+    uint32      id;
+    int32       nargs;                                  /* -1 if not capturable */
+    uint8       types[DEBT_MAXARGS];
+    } DEBT_DEF;
+
+typedef struct {
+    uint8       *buf;
+    uint32      size;
+    volatile uint32 head;                               /* producer position */
+    volatile uint32 tail;                               /* consumer position */
+    uint32      drops;                                  /* dropped, not yet recorded */
+    t_uint64    total_drops;
+    t_uint64    records;
+    } DEBT_RING;
+
+static DEBT_RING debt_ring[2];                          /* main thread, others */
+static DEBT_DEF debt_defs[DEBT_DEFS];
+static uint32 debt_ndefs = 0;
+static uint8 *debt_pend = NULL;                         /* definitions not yet written */
+static size_t debt_pend_len = 0, debt_pend_size = 0;
+static t_bool debt_active = FALSE;
+static char debt_tbuf[DEBT_MAXREC - sizeof (DEBT_REC)]; /* main thread text being collected */
+static size_t debt_tlen = 0;
+#if defined(SIM_ASYNCH_IO)
+static pthread_mutex_t debt_lock = PTHREAD_MUTEX_INITIALIZER;       /* defs, aux ring */
+static pthread_mutex_t debt_drain_lock = PTHREAD_MUTEX_INITIALIZER; /* consumer */
+static pthread_mutex_t debt_wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t debt_wake = PTHREAD_COND_INITIALIZER;
+static pthread_t debt_thread;
+static t_bool debt_thread_stop;
+#define DEBT_LOCK(l)    pthread_mutex_lock (&l)
+#define DEBT_UNLOCK(l)  pthread_mutex_unlock (&l)
+#else
+#define DEBT_LOCK(l)
+#define DEBT_UNLOCK(l)
+#endif
+
+/* Determine the argument types consumed by a format */
+
+static int32 _debt_parse_fmt (const char *fmt, uint8 *types)
+{
+int32 n = 0;
+uint8 lt;
+
+while ((fmt = strchr (fmt, '%'))) {
+    ++fmt;
+    if (*fmt == '%') {
+        ++fmt;
+        continue;
+        }
+    fmt += strspn (fmt, "-+ #0'");
+    if (*fmt == '*') {
+        if (n >= DEBT_MAXARGS)
+            return -1;
+        types[n++] = DEBT_A_INT;
+        ++fmt;
+        }
+    else
+        fmt += strspn (fmt, "0123456789");
+    if (*fmt == '.') {
+        ++fmt;
+        if (*fmt == '*') {
+            if (n >= DEBT_MAXARGS)
+                return -1;
+            types[n++] = DEBT_A_INT;
+            ++fmt;
+            }
+        else
+            fmt += strspn (fmt, "0123456789");
+        }
+    lt = DEBT_A_INT;
+    if (fmt[0] == 'h')
+        fmt += (fmt[1] == 'h') ? 2 : 1;
+    else if ((fmt[0] == 'l') && (fmt[1] == 'l')) {
+        lt = DEBT_A_LLONG;
+        fmt += 2;
+        }
+    else if (fmt[0] == 'l') {
+        lt = DEBT_A_LONG;
+        fmt += 1;
+        }
+    else if ((fmt[0] == 'q') || (fmt[0] == 'j')) {
+        lt = DEBT_A_LLONG;
+        fmt += 1;
+        }
+    else if ((fmt[0] == 'z') || (fmt[0] == 't')) {
+        lt = DEBT_A_SIZE;
+        fmt += 1;
+        }
+    else if ((fmt[0] == 'I') && (fmt[1] == '6') && (fmt[2] == '4')) {
+        lt = DEBT_A_LLONG;
+        fmt += 3;
+        }
+    else if ((fmt[0] == 'I') && (fmt[1] == '3') && (fmt[2] == '2'))
+        fmt += 3;
+    if (n >= DEBT_MAXARGS)
+        return -1;
+    switch (*fmt++) {
+        case 'd': case 'i': case 'u': case 'o':
+        case 'x': case 'X': case 'c':
+            types[n++] = lt;
+            break;
+        case 'e': case 'E': case 'f': case 'F':
+        case 'g': case 'G': case 'a': case 'A':
+            types[n++] = DEBT_A_DBL;
+            break;
+        case 's':
+            if (lt != DEBT_A_INT)                       /* wide string? */
+                return -1;
+            types[n++] = DEBT_A_STR;
+            break;
+        case 'p':
+            types[n++] = DEBT_A_PTR;
+            break;
+        default:                                        /* %n, %L.., unknown */
+            return -1;
+        }
+    }
+return n;
+}
+
+/* Append to the pending definitions (debt_lock held) */
+
+static void _debt_pend (const void *rec, size_t len)
+{
+if (debt_pend_len + len > debt_pend_size) {
+    size_t size = MAX (2 * debt_pend_size, debt_pend_len + len + 4096);
+    uint8 *p = (uint8 *)realloc (debt_pend, size);
+
+    if (p == NULL)
+        return;
+    debt_pend = p;
+    debt_pend_size = size;
+    }
+memcpy (debt_pend + debt_pend_len, rec, len);
+debt_pend_len += len;
+}
+
+/* Look up (defining on first use) the id of a format or name */
+
+static DEBT_DEF *_debt_def (const char *key)
+{
+uint32 h = (uint32)((((size_t)key) >> 2) * 2654435761u) & (DEBT_DEFS - 1);
+DEBT_DEF *d;
+t_uint64 rec[DEBT_MAXREC / 8];
+DEBT_REC *r = (DEBT_REC *)rec;
+size_t tlen;
+
+while ((d = &debt_defs[h])->key != NULL) {              /* lock free probe */
+    if (d->key == key)
+        return (strcmp (d->text, key) == 0) ? d : NULL; /* text changed, don't trust */
+    h = (h + 1) & (DEBT_DEFS - 1);
+    }
+DEBT_LOCK (debt_lock);
+while (((d = &debt_defs[h])->key != NULL) && (d->key != key))
+    h = (h + 1) & (DEBT_DEFS - 1);
+if (d->key == NULL) {
+    tlen = strlen (key);
+    if ((debt_ndefs >= (DEBT_DEFS * 3) / 4) ||          /* table too full or */
+        (sizeof (*r) + tlen + 1 > sizeof (rec)) ||      /* text too long? */
+        ((d->text = strdup (key)) == NULL)) {
+        DEBT_UNLOCK (debt_lock);
+        return NULL;
+        }
+    d->id = ++debt_ndefs;
+    d->nargs = _debt_parse_fmt (key, d->types);
+    memset (r, 0, sizeof (*r));
+    r->magic = DEBT_MAGIC;
+    r->type = DEBT_R_DEF;
+    r->id = d->id;
+    r->len = (uint32)((sizeof (*r) + tlen + 1 + 7) & ~7);
+    memset ((uint8 *)(r + 1), 0, r->len - sizeof (*r));
+    memcpy ((uint8 *)(r + 1), key, tlen);
+    _debt_pend (r, r->len);
+    DEBT_BARRIER;
+    d->key = key;                                       /* publish */
+    }
+DEBT_UNLOCK (debt_lock);
+return (strcmp (d->text, key) == 0) ? d : NULL;
+}
+
+/* Move records from a ring to the debug file, up to position head */
+
+static void _debt_drain_ring (DEBT_RING *rg, uint32 head)
+{
+uint32 tail = rg->tail;
+uint32 run = tail;                                      /* start of contiguous records */
+
+while (tail != head) {
+    uint32 off = tail & (rg->size - 1);
+    DEBT_REC *r = (DEBT_REC *)(rg->buf + off);
+
+    if ((off == 0) && (tail != run)) {                  /* wrapped? */
+        fwrite (rg->buf + (run & (rg->size - 1)), 1, tail - run, sim_deb);
+        run = tail;
+        }
+    if (((rg->size - off) < sizeof (DEBT_REC)) ||       /* pad? */
+        (r->type == DEBT_R_PAD)) {
+        if (tail != run)
+            fwrite (rg->buf + (run & (rg->size - 1)), 1, tail - run, sim_deb);
+        tail += ((rg->size - off) < sizeof (DEBT_REC)) ? rg->size - off : r->len;
+        run = tail;
+        continue;
+        }
+    tail += r->len;
+    }
+if (tail != run)
+    fwrite (rg->buf + (run & (rg->size - 1)), 1, tail - run, sim_deb);
+DEBT_BARRIER;
+rg->tail = tail;
+}
+
+static void _debt_drain (void)
+{
+uint32 head[2];
+
+DEBT_LOCK (debt_drain_lock);
+head[0] = debt_ring[0].head;                            /* snapshot producers */
+head[1] = debt_ring[1].head;
+DEBT_BARRIER;
+DEBT_LOCK (debt_lock);                                  /* definitions first */
+if (debt_pend_len && sim_deb)
+    fwrite (debt_pend, 1, debt_pend_len, sim_deb);
+debt_pend_len = 0;
+DEBT_UNLOCK (debt_lock);
+if (sim_deb) {
+    _debt_drain_ring (&debt_ring[0], head[0]);
+    _debt_drain_ring (&debt_ring[1], head[1]);
+    }
+DEBT_UNLOCK (debt_drain_lock);
+}
+
+/* Place a record in a ring */
+
+static t_bool _debt_put_raw (DEBT_RING *rg, const DEBT_REC *r)
+{
+uint32 head = rg->head;
+uint32 off = head & (rg->size - 1);
+uint32 pad = ((off + r->len) > rg->size) ? rg->size - off : 0;
+
+if (((head - rg->tail) + pad + r->len) > rg->size)      /* no room? */
+    return FALSE;
+if (pad >= sizeof (DEBT_REC)) {                         /* explicit pad */
+    DEBT_REC *p = (DEBT_REC *)(rg->buf + off);
+
+    p->magic = DEBT_MAGIC;
+    p->len = pad;
+    p->type = DEBT_R_PAD;
+    }
+memcpy (rg->buf + ((head + pad) & (rg->size - 1)), r, r->len);
+DEBT_BARRIER;
+rg->head = head + pad + r->len;                         /* publish */
+return TRUE;
+}
+
+static void _debt_text_flush (void);
+
+static void _debt_put (DEBT_REC *r)
+{
+t_bool aux = !AIO_MAIN_THREAD;
+DEBT_RING *rg = &debt_ring[aux ? 1 : 0];
+
+if (!aux && debt_tlen && (r->type != DEBT_R_TEXT))      /* collected text first */
+    _debt_text_flush ();
+if (aux) {
+    r->flags |= DEBT_F_AUX;
+    DEBT_LOCK (debt_lock);
+    }
+if (rg->drops) {                                        /* record earlier drops */
+    DEBT_REC d;
+
+    memset (&d, 0, sizeof (d));
+    d.magic = DEBT_MAGIC;
+    d.len = sizeof (d);
+    d.type = DEBT_R_DROP;
+    d.flags = r->flags;
+    d.id = rg->drops;
+    if (_debt_put_raw (rg, &d))
+        rg->drops = 0;
+    }
+if ((rg->drops == 0) && _debt_put_raw (rg, r))
+    rg->records++;
+else {
+    rg->drops++;
+    rg->total_drops++;
+    }
+if (aux)
+    DEBT_UNLOCK (debt_lock);
+if ((rg->head - rg->tail) > (rg->size / 2)) {           /* getting full? */
+#if defined(SIM_ASYNCH_IO)
+    pthread_cond_signal (&debt_wake);                   /* wake writer */
+#else
+    _debt_drain ();
+#endif
+    }
+}
+
+/* Fill in the common record header */
+
+static void _debt_header (DEBT_REC *r, uint8 type, uint32 dbits, DEVICE *dptr, UNIT *uptr)
+{
+DEBT_DEF *d;
+
+memset (r, 0, sizeof (*r));
+r->magic = DEBT_MAGIC;
+r->type = type;
+r->dbits = dbits;
+if (dptr) {
+    if ((d = _debt_def (dptr->name)))
+        r->dev = d->id;
+    if ((d = _debt_def (_get_dbg_verb (dbits, dptr, uptr))))
+        r->verb = d->id;
+    }
+r->gtime = sim_gtime ();
+if (sim_deb_switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A'))) {
+    struct timespec now;
+
+    clock_gettime (CLOCK_REALTIME, &now);
+    r->wsec = (t_int64)now.tv_sec;
+    r->wnsec = (t_int64)now.tv_nsec;
+    }
+if (sim_deb_switches & SWMASK ('P')) {
+    r->pc = (t_uint64)(sim_vm_pc_value ? (*sim_vm_pc_value)() : get_rval (sim_PC, 0));
+    r->flags |= DEBT_F_PC;
+    }
+if (debug_unterm)
+    r->flags |= DEBT_F_CONT;
+}
+
+/* Record a sim_debug message */
+
+static void _debt_vrecord (uint32 dbits, DEVICE *dptr, UNIT *uptr, const char *fmt, va_list arglist)
+{
+t_uint64 rec[DEBT_MAXREC / 8];
+DEBT_REC *r = (DEBT_REC *)rec;
+t_uint64 *slot = (t_uint64 *)(r + 1);
+DEBT_DEF *d = _debt_def (fmt);
+uint8 *sp;
+size_t room, l;
+int32 i;
+size_t flen = strlen (fmt);
+t_bool ends_str = (flen >= 2) && (fmt[flen - 2] == '%') && (fmt[flen - 1] == 's');
+char last = flen ? fmt[flen - 1] : 0;
+
+_debt_header (r, DEBT_R_MSG, dbits, dptr, uptr);
+if ((d == NULL) || (d->nargs < 0)) {                    /* can't capture? */
+    char *buf = (char *)(slot + 1);                     /* format now */
+    int len;
+
+    room = sizeof (rec) - sizeof (*r) - sizeof (*slot);
+    len = vsnprintf (buf, room, fmt, arglist);
+    l = ((len < 0) || ((size_t)len >= room)) ? room - 1 : (size_t)len;
+    r->id = 0;                                          /* preformatted */
+    r->nargs = 1;
+    slot[0] = l;
+    last = l ? buf[l - 1] : 0;
+    r->len = (uint32)((sizeof (*r) + sizeof (*slot) + l + 7) & ~7);
+    }
+else {
+    r->id = d->id;
+    r->nargs = (uint16)d->nargs;
+    sp = (uint8 *)(slot + d->nargs);
+    room = sizeof (rec) - (sp - (uint8 *)rec);
+    for (i = 0; i < d->nargs; i++) {
+        switch (d->types[i]) {
+            case DEBT_A_INT:
+                slot[i] = (t_uint64)(t_int64)va_arg (arglist, int);
+                break;
+            case DEBT_A_LONG:
+                slot[i] = (t_uint64)(t_int64)va_arg (arglist, long);
+                break;
+            case DEBT_A_LLONG:
+                slot[i] = (t_uint64)va_arg (arglist, LL_TYPE);
+                break;
+            case DEBT_A_SIZE:
+                slot[i] = (t_uint64)va_arg (arglist, size_t);
+                break;
+            case DEBT_A_DBL: {
+                double v = va_arg (arglist, double);
+
+                memcpy (&slot[i], &v, sizeof (v));
+                break;
+                }
+            case DEBT_A_PTR:
+                slot[i] = (t_uint64)(size_t)va_arg (arglist, void *);
+                break;
+            case DEBT_A_STR: {
+                const char *s = va_arg (arglist, const char *);
+
+                if (s == NULL)
+                    s = "(null)";
+                l = strlen (s);
+                if (l > room)                           /* truncate to fit */
+                    l = room;
+                memcpy (sp, s, l);
+                sp += l;
+                room -= l;
+                slot[i] = l;
+                if (ends_str)
+                    last = l ? s[l - 1] : 0;
+                break;
+                }
+            }
+        }
+    r->len = (uint32)(((sp - (uint8 *)rec) + 7) & ~7);
+    }
+_debt_put (r);
+debug_unterm = (last != '\n');
+}
+
+/* Record already formatted debug output
+
+   Output from the main thread arrives in small pieces (sim_debug_bits writes
+   field by field), so it is collected into lines before being recorded.
+*/
+
+static void _debt_text_put (const char *buf, size_t len)
+{
+t_uint64 rec[DEBT_MAXREC / 8];
+DEBT_REC *r = (DEBT_REC *)rec;
+
+while (len > 0) {
+    size_t l = MIN (len, sizeof (rec) - sizeof (*r));
+
+    memset (r, 0, sizeof (*r));
+    r->magic = DEBT_MAGIC;
+    r->type = DEBT_R_TEXT;
+    r->id = (uint32)l;
+    memcpy ((uint8 *)(r + 1), buf, l);
+    r->len = (uint32)((sizeof (*r) + l + 7) & ~7);
+    _debt_put (r);
+    buf += l;
+    len -= l;
+    }
+}
+
+static void _debt_text_flush (void)
+{
+size_t len = debt_tlen;
+
+debt_tlen = 0;
+_debt_text_put (debt_tbuf, len);
+}
+
+static void _debt_text (const char *buf, size_t len)
+{
+if (!AIO_MAIN_THREAD) {
+    _debt_text_put (buf, len);
+    return;
+    }
+while (len > 0) {
+    size_t l = MIN (len, sizeof (debt_tbuf) - debt_tlen);
+
+    memcpy (debt_tbuf + debt_tlen, buf, l);
+    debt_tlen += l;
+    buf += l;
+    len -= l;
+    if ((debt_tlen == sizeof (debt_tbuf)) || (debt_tbuf[debt_tlen - 1] == '\n'))
+        _debt_text_flush ();
+    }
+}
+
+/* Write out everything recorded by the main thread so far */
+
+static void _debt_flush (void)
+{
+if (debt_tlen)
+    _debt_text_flush ();
+_debt_drain ();
+}
+
+#if defined(SIM_ASYNCH_IO)
+static void *_debt_writer (void *arg)
+{
+pthread_mutex_lock (&debt_wake_lock);
+while (!debt_thread_stop) {
+    struct timespec due;
+
+    pthread_mutex_unlock (&debt_wake_lock);
+    _debt_drain ();
+    if (sim_deb)
+        fflush (sim_deb);
+    pthread_mutex_lock (&debt_wake_lock);
+    if (debt_thread_stop)
+        break;
+    clock_gettime (CLOCK_REALTIME, &due);
+    due.tv_nsec += DEBT_WAIT_MS * 1000000;
+    if (due.tv_nsec >= 1000000000) {
+        due.tv_sec += 1;
+        due.tv_nsec -= 1000000000;
+        }
+    pthread_cond_timedwait (&debt_wake, &debt_wake_lock, &due);
+    }
+pthread_mutex_unlock (&debt_wake_lock);
+return NULL;
+}
+#endif
+
+/* Release the saved format definitions */
+
+static void _debt_free_defs (void)
+{
+uint32 i;
+
+for (i = 0; i < DEBT_DEFS; i++)
+    free (debt_defs[i].text);
+memset (debt_defs, 0, sizeof (debt_defs));
+}
+
+/* Start binary tracing to sim_deb */
+
+t_stat sim_debug_trace_start (void)
+{
+DEBT_REC h;
+int32 i;
+
+for (i = 0; i < 2; i++) {
+    DEBT_RING *rg = &debt_ring[i];
+
+    if (rg->buf == NULL) {
+        rg->buf = (uint8 *)malloc (DEBT_RINGSIZE);
+        if (rg->buf == NULL)
+            return SCPE_MEM;
+        rg->size = DEBT_RINGSIZE;
+        }
+    rg->head = rg->tail = rg->drops = 0;
+    rg->records = rg->total_drops = 0;
+    }
+debt_tlen = 0;
+_debt_free_defs ();                                     /* forget definitions */
+debt_ndefs = 0;
+debt_pend_len = 0;
+memset (&h, 0, sizeof (h));                             /* file header */
+h.magic = DEBT_MAGIC;
+h.len = sizeof (h);
+h.type = DEBT_R_HDR;
+h.id = (uint32)sim_deb_switches;
+h.wsec = (t_int64)sim_deb_basetime.tv_sec;
+h.wnsec = (t_int64)sim_deb_basetime.tv_nsec;
+_debt_pend (&h, sizeof (h));
+debt_active = TRUE;
+#if defined(SIM_ASYNCH_IO)
+debt_thread_stop = FALSE;
+if (pthread_create (&debt_thread, NULL, _debt_writer, NULL)) {
+    debt_active = FALSE;
+    return SCPE_IERR;
+    }
+#endif
+return SCPE_OK;
+}
+
+/* Stop binary tracing, writing everything still in the rings */
+
+void sim_debug_trace_stop (void)
+{
+if (!debt_active)
+    return;
+#if defined(SIM_ASYNCH_IO)
+pthread_mutex_lock (&debt_wake_lock);
+debt_thread_stop = TRUE;
+pthread_cond_signal (&debt_wake);
+pthread_mutex_unlock (&debt_wake_lock);
+pthread_join (debt_thread, NULL);
+#endif
+debt_active = FALSE;
+_debt_flush ();
+if (sim_deb)
+    fflush (sim_deb);
+}
+
+void sim_debug_trace_stats (FILE *st)
+{
+fprintf (st, "   Debug messages are recorded in binary form: %" LL_FMT "u records, %" LL_FMT "u dropped\n",
+             (LL_TYPE)(debt_ring[0].records + debt_ring[1].records),
+             (LL_TYPE)(debt_ring[0].total_drops + debt_ring[1].total_drops));
+}
+
+/* Decode a binary trace file */
+
+static size_t _debt_format (char *out, size_t size, const char *fmt, const DEBT_DEF *d, const DEBT_REC *r)
+{
+const t_uint64 *slot = (const t_uint64 *)(r + 1);
+const char *sp = (const char *)(slot + r->nargs);
+const char *end = ((const char *)r) + r->len;
+size_t o = 0;
+int32 a = 0;
+
+#define DEBT_APPEND(s, l) do { size_t _l = MIN ((size_t)(l), size - 1 - o); memcpy (out + o, s, _l); o += _l; } while (0)
+while (*fmt && (o < size - 1)) {
+    const char *start = fmt;
+    char spec[32], tmp[DEBT_MAXREC + 64];
+    int star[2], nstar = 0, len = 0;
+    uint8 type;
+    t_uint64 v;
+
+    if (*fmt != '%') {
+        out[o++] = *fmt++;
+        continue;
+        }
+    if (fmt[1] == '%') {
+        out[o++] = '%';
+        fmt += 2;
+        continue;
+        }
+    ++fmt;
+    fmt += strspn (fmt, "-+ #0'");
+    if (*fmt == '*') {
+        star[nstar++] = (int)(t_int64)slot[a++];
+        ++fmt;
+        }
+    else
+        fmt += strspn (fmt, "0123456789");
+    if (*fmt == '.') {
+        ++fmt;
+        if (*fmt == '*') {
+            star[nstar++] = (int)(t_int64)slot[a++];
+            ++fmt;
+            }
+        else
+            fmt += strspn (fmt, "0123456789");
+        }
+    fmt += strspn (fmt, "hlqjztI3264");
+    if (*fmt)
+        ++fmt;
+    if ((a >= r->nargs) || ((size_t)(fmt - start) >= sizeof (spec)))
+        break;                                          /* malformed */
+    memcpy (spec, start, fmt - start);
+    spec[fmt - start] = '\0';
+    type = d ? d->types[a] : DEBT_A_STR;
+    v = slot[a++];
+#define DEBT_SNPRINTF(val) \
+    len = (nstar == 0) ? snprintf (tmp, sizeof (tmp), spec, val) : \
+          (nstar == 1) ? snprintf (tmp, sizeof (tmp), spec, star[0], val) : \
+                         snprintf (tmp, sizeof (tmp), spec, star[0], star[1], val)
+    switch (type) {
+        case DEBT_A_INT:
+            DEBT_SNPRINTF ((int)(t_int64)v);
+            break;
+        case DEBT_A_LONG:
+            DEBT_SNPRINTF ((long)(t_int64)v);
+            break;
+        case DEBT_A_LLONG:
+            DEBT_SNPRINTF ((LL_TYPE)v);
+            break;
+        case DEBT_A_SIZE:
+            DEBT_SNPRINTF ((size_t)v);
+            break;
+        case DEBT_A_DBL: {
+            double dv;
+
+            memcpy (&dv, &v, sizeof (dv));
+            DEBT_SNPRINTF (dv);
+            break;
+            }
+        case DEBT_A_PTR:
+            DEBT_SNPRINTF ((void *)(size_t)v);
+            break;
+        case DEBT_A_STR: {
+            char sbuf[DEBT_MAXREC];
+
+            if (v > (t_uint64)(end - sp))
+                v = (t_uint64)(end - sp);
+            memcpy (sbuf, sp, (size_t)v);
+            sbuf[v] = '\0';
+            sp += v;
+            DEBT_SNPRINTF (sbuf);
+            break;
+            }
+        }
+    if (len > 0)
+        DEBT_APPEND (tmp, MIN ((size_t)len, sizeof (tmp) - 1));
+    }
+out[o] = '\0';
+return o;
+}
+
+static DEBT_DEF *_debt_id (uint32 id)
+{
+uint32 h;
+
+for (h = id & (DEBT_DEFS - 1); debt_defs[h].text; h = (h + 1) & (DEBT_DEFS - 1))
+    if (debt_defs[h].id == id)
+        return &debt_defs[h];
+return NULL;
+}
+
+static const char *_debt_name (uint32 id)
+{
+DEBT_DEF *d = id ? _debt_id (id) : NULL;
+
+return d ? d->text : "";
+}
+
+t_stat sim_debug_decode (FILE *st, const char *filename)
+{
+FILE *f;
+uint8 *data, *rec;
+size_t pos = 0, end = 0;
+t_bool eof = FALSE;
+int32 switches = 0;
+struct timespec basetime = { 0, 0 };
+t_bool unterm = FALSE;
+char *msg;
+uint32 drops = 0;
+
+if (debt_active)
+    return sim_messagef (SCPE_ARG, "Binary debug tracing is active\n");
+f = sim_fopen (filename, "rb");
+if (f == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't open %s: %s\n", filename, strerror (errno));
+data = (uint8 *)malloc (2 * DEBT_MAXREC);              /* file window */
+rec = (uint8 *)malloc (DEBT_MAXREC);                    /* aligned record copy */
+msg = (char *)malloc (4 * DEBT_MAXREC);
+if ((data == NULL) || (rec == NULL) || (msg == NULL)) {
+    fclose (f);
+    free (data);
+    free (rec);
+    free (msg);
+    return SCPE_MEM;
+    }
+_debt_free_defs ();                                     /* decoder's definitions */
+while (1) {
+    DEBT_REC r;
+    const DEBT_REC *rp = (const DEBT_REC *)rec;
+    size_t avail = end - pos;
+
+    if ((avail < DEBT_MAXREC) && !eof) {                /* keep a whole record buffered */
+        size_t want;
+
+        memmove (data, data + pos, avail);
+        pos = 0;
+        end = avail;
+        want = 2 * DEBT_MAXREC - end;
+        end += fread (data + end, 1, want, f);
+        eof = (end - avail) < want;
+        avail = end;
+        }
+    if (avail == 0)
+        break;
+    if (avail >= sizeof (r))
+        memcpy (&r, data + pos, sizeof (r));
+    if ((avail < sizeof (r)) || (r.magic != DEBT_MAGIC) ||
+        (r.len < sizeof (r)) || (r.len > DEBT_MAXREC) || (r.len > avail) ||
+        (r.type > DEBT_R_DROP)) {
+        fputc (data[pos++], st);                        /* pass through */
+        continue;
+        }
+    memcpy (rec, data + pos, r.len);
+    pos += r.len;
+    switch (r.type) {
+        case DEBT_R_HDR:
+            switches = (int32)r.id;
+            basetime.tv_sec = (time_t)r.wsec;
+            basetime.tv_nsec = (long)r.wnsec;
+            break;
+        case DEBT_R_DEF: {
+            const char *text = (const char *)(rp + 1);
+            uint32 h = r.id & (DEBT_DEFS - 1);
+
+            while (debt_defs[h].text)
+                h = (h + 1) & (DEBT_DEFS - 1);
+            debt_defs[h].text = (char *)malloc (strnlen (text, r.len - sizeof (r)) + 1);
+            if (debt_defs[h].text) {
+                memcpy (debt_defs[h].text, text, strnlen (text, r.len - sizeof (r)));
+                debt_defs[h].text[strnlen (text, r.len - sizeof (r))] = '\0';
+                debt_defs[h].id = r.id;
+                debt_defs[h].nargs = _debt_parse_fmt (debt_defs[h].text, debt_defs[h].types);
+                }
+            break;
+            }
+        case DEBT_R_DROP:
+            fprintf (st, "*** %u debug records were lost (trace ring full) ***\r\n", r.id);
+            drops += r.id;
+            break;
+        case DEBT_R_TEXT:
+            fwrite (rp + 1, 1, MIN (r.id, r.len - sizeof (r)), st);
+            break;
+        case DEBT_R_MSG: {
+            DEBT_DEF *d = r.id ? _debt_id (r.id) : NULL;
+            char prefix[512];
+            char pc_s[64] = "";
+            struct timespec wtime;
+            size_t len, i, j;
+
+            if (r.id && ((d == NULL) || (d->nargs != r.nargs)))
+                break;                                  /* unknown format */
+            len = _debt_format (msg, 4 * DEBT_MAXREC, d ? d->text : "%s", d, rp);
+            if (r.flags & DEBT_F_PC) {
+                sprintf (pc_s, "-%s:", sim_PC->name);
+                sprint_val (&pc_s[strlen (pc_s)], (t_value)r.pc, sim_PC->radix, sim_PC->width, sim_PC->flags & REG_FMT);
+                }
+            wtime.tv_sec = (time_t)r.wsec;
+            wtime.tv_nsec = (long)r.wnsec;
+            _sim_debug_format_prefix (prefix, switches, &wtime, &basetime, r.gtime, pc_s,
+                                      (r.flags & DEBT_F_AUX) != 0, _debt_name (r.dev), _debt_name (r.verb));
+            unterm = (r.flags & DEBT_F_CONT) != 0;
+            for (i = j = 0; i < len; ++i) {             /* as in _sim_vdebug */
+                if (msg[i] == '\n') {
+                    if ((i != j) || (i == 0)) {
+                        if (!unterm)
+                            fputs (prefix, st);
+                        fwrite (&msg[j], 1, i - j, st);
+                        fputs ("\r\n", st);
+                        }
+                    unterm = FALSE;
+                    j = i + 1;
+                    }
+                }
+            if (i > j) {
+                if (!unterm)
+                    fputs (prefix, st);
+                fwrite (&msg[j], 1, i - j, st);
+                }
+            break;
+            }
+        }
+    }
+fclose (f);
+_debt_free_defs ();
+free (data);
+free (rec);
+free (msg);
+if (drops)
+    fprintf (st, "*** %u debug records lost in total ***\r\n", drops);
+return SCPE_OK;
+}
+
 void fprint_fields (FILE *stream, t_value before, t_value after, BITFIELD* bitdefs)
 {
 int32 i, fields, offset;
@@ -13444,7 +16124,13 @@ if (sim_deb && dptr && ((dptr->dctrl | (uptr ? uptr->dctrl : 0)) & dbits)) {
     int32 bufsize = sizeof(stackbuf);
     char *buf = stackbuf;
     int32 i, j, len;
-    const char* debug_prefix = sim_debug_prefix(dbits, dptr, uptr);   /* prefix to print if required */
+    const char* debug_prefix;
+
+    if (sim_deb_switches & SWMASK ('Z')) {              /* binary trace? */
+        _debt_vrecord (dbits, dptr, uptr, fmt, arglist);/* record, don't format */
+        return;
+        }
+    debug_prefix = sim_debug_prefix(dbits, dptr, uptr); /* prefix to print if required */
 
     sim_oline = NULL;                                   /* avoid potential debug to active socket */
     buf[bufsize-1] = '\0';
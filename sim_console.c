@@ -131,6 +131,7 @@
 #include "sim_tmxr.h"
 #include "sim_serial.h"
 #include "sim_timer.h"
+#include "sim_frontpanel_shmem.h"
 #include <ctype.h>
 #include <math.h>
 
@@ -449,12 +450,14 @@ t_stat sim_rem_con_poll_svc (UNIT *uptr);               /* remote console connec
 t_stat sim_rem_con_data_svc (UNIT *uptr);               /* remote console connection data routine */
 t_stat sim_rem_con_repeat_svc (UNIT *uptr);             /* remote auto repeat command console timing routine */
 t_stat sim_rem_con_smp_collect_svc (UNIT *uptr);        /* remote remote register data sampling routine */
+t_stat sim_rem_con_shm_svc (UNIT *uptr);                /* remote shared memory register mirror update routine */
 t_stat sim_rem_con_reset (DEVICE *dptr);                /* remote console reset routine */
 #define rem_con_poll_unit (&sim_remote_console.units[0])
 #define rem_con_data_unit (&sim_remote_console.units[1])
 #define REM_CON_BASE_UNITS 2
 #define rem_con_repeat_units (&sim_remote_console.units[REM_CON_BASE_UNITS])
 #define rem_con_smp_smpl_units (&sim_remote_console.units[REM_CON_BASE_UNITS+sim_rem_con_tmxr.lines])
+#define rem_con_shm_units (&sim_remote_console.units[REM_CON_BASE_UNITS+2*sim_rem_con_tmxr.lines])
 
 #define DBG_MOD  0x00000004                             /* Remote Console Mode activities */
 #define DBG_REP  0x00000008                             /* Remote Console Repeat activities */
@@ -506,6 +509,15 @@ struct BITSAMPLE_REG {
     uint32          width;          /* number of bits to sample */
     BITSAMPLE       *bits;
     };
+typedef struct SHMEM_REG SHMEM_REG;
+struct SHMEM_REG {
+    REG             *reg;           /* Register to be mirrored */
+    uint32          idx;            /* First register index */
+    uint32          count;          /* Number of elements */
+    t_bool          indirect;       /* Register value points at memory */
+    DEVICE          *dptr;          /* Device register is part of */
+    UNIT            *uptr;          /* Unit Register is related to */
+    };
 typedef struct REMOTE REMOTE;
 struct REMOTE {
     int32           buf_size;
@@ -526,6 +538,13 @@ struct REMOTE {
     int             smp_sample_dither_pct;  /* dithering of cycles interval */
     uint32          smp_reg_count;          /* sample register count */
     BITSAMPLE_REG   *smp_regs;              /* registers being sampled */
+    uint32          shm_interval;           /* usecs between shared memory updates */
+    char            *shm_name;              /* shared memory segment name */
+    SHMEM           *shm;                   /* shared memory segment */
+    SIM_PANEL_SHMEM *shm_hdr;               /* mapped register mirror */
+    uint32          shm_reg_count;          /* mirrored register count */
+    uint32          shm_value_count;        /* mirrored register values */
+    SHMEM_REG       *shm_regs;              /* registers being mirrored */
     };
 REMOTE *sim_rem_consoles = NULL;
 
@@ -658,6 +677,8 @@ for (i=connections=0; i<sim_rem_con_tmxr.lines; i++) {
         if (sim_switches & SWMASK ('D'))
             sim_rem_sample_output (st, rem->line);
         }
+    if (rem->shm)
+        fprintf (st, "Values of %d registers are published in shared memory '%s' every %s\n", (int)rem->shm_value_count, rem->shm_name, sim_fmt_secs (rem->shm_interval / 1000000.0));
     }
 return SCPE_OK;
 }
@@ -736,6 +757,11 @@ static t_stat x_run_cmd (int32 flag, CONST char *cptr)
 return 7+SCPE_IERR;         /* This routine should never be called */
 }
 
+static t_stat x_shmem_cmd (int32 flag, CONST char *cptr)
+{
+return 8+SCPE_IERR;         /* This routine should never be called */
+}
+
 static t_stat x_help_cmd (int32 flag, CONST char *cptr);
 
 static CTAB allowed_remote_cmds[] = {
@@ -750,6 +776,7 @@ static CTAB allowed_remote_cmds[] = {
     { "REPEAT",   &x_repeat_cmd,      0 },
     { "COLLECT",  &x_collect_cmd,     0 },
     { "SAMPLEOUT",&x_sampleout_cmd,   0 },
+    { "SHMEM",    &x_shmem_cmd,       0 },
     { "PWD",      &pwd_cmd,           0 },
     { "SAVE",     &save_cmd,          0 },
     { "DIR",      &dir_cmd,           0 },
@@ -775,6 +802,7 @@ static CTAB allowed_master_remote_cmds[] = {
     { "REPEAT",   &x_repeat_cmd,      0 },
     { "COLLECT",  &x_collect_cmd,     0 },
     { "SAMPLEOUT",&x_sampleout_cmd,   0 },
+    { "SHMEM",    &x_shmem_cmd,       0 },
     { "EXECUTE",  &x_execute_cmd,     0 },
     { "PWD",      &pwd_cmd,           0 },
     { "SAVE",     &save_cmd,          0 },
@@ -809,6 +837,7 @@ static CTAB allowed_single_remote_cmds[] = {
     { "REPEAT",   &x_repeat_cmd,      0 },
     { "COLLECT",  &x_collect_cmd,     0 },
     { "SAMPLEOUT",&x_sampleout_cmd,   0 },
+    { "SHMEM",    &x_shmem_cmd,       0 },
     { "EXECUTE",  &x_execute_cmd,     0 },
     { "PWD",      &pwd_cmd,           0 },
     { "DIR",      &dir_cmd,           0 },
@@ -826,6 +855,7 @@ static CTAB remote_only_cmds[] = {
     { "REPEAT",   &x_repeat_cmd,      0 },
     { "COLLECT",  &x_collect_cmd,     0 },
     { "SAMPLEOUT",&x_sampleout_cmd,   0 },
+    { "SHMEM",    &x_shmem_cmd,       0 },
     { "EXECUTE",  &x_execute_cmd,     0 },
     { NULL,       NULL }
     };
@@ -1311,7 +1341,7 @@ uint32 i;
 t_value val = get_rval (reg->reg, reg->idx);
 
 if (reg->indirect)
-    val = get_aval ((t_addr)val, reg->dptr, reg->uptr);
+    val = (get_aval ((t_addr)val, reg->dptr, reg->uptr) == SCPE_OK) ? sim_eval[0] : 0;
 val = val >> reg->reg->offset;
 for (i = 0; i < reg->width; i++) {
     if (sim_is_running)
@@ -1330,12 +1360,252 @@ for (i = 0; i < rem->smp_reg_count; i++)
     sim_rem_collect_reg_bits (&rem->smp_regs[i]);
 }
 
+static void sim_rem_shmem_stop (REMOTE *rem)
+{
+sim_cancel (&rem_con_shm_units[rem->line]);
+sim_shmem_close (rem->shm);
+rem->shm = NULL;
+rem->shm_hdr = NULL;
+free (rem->shm_name);
+rem->shm_name = NULL;
+free (rem->shm_regs);
+rem->shm_regs = NULL;
+rem->shm_reg_count = 0;
+rem->shm_value_count = 0;
+rem->shm_interval = 0;
+}
+
+/* Memory contents an indirect register points at, composed of as many 
+   memory units as the register's width spans (little endian) */
+
+static t_value sim_rem_indirect_value (SHMEM_REG *sreg, t_value addr)
+{
+uint32 i, units = 1;
+t_value val = 0;
+
+if (get_aval ((t_addr)addr, sreg->dptr, sreg->uptr) != SCPE_OK)
+    return 0;
+if ((sreg->dptr->dwidth != 0) && (sreg->reg->width > sreg->dptr->dwidth))
+    units = sreg->reg->width / sreg->dptr->dwidth;
+if (units > (uint32)sim_emax)
+    units = (uint32)sim_emax;
+for (i = 0; i < units; i++)
+    val |= sim_eval[i] << (i * sreg->dptr->dwidth);
+return val;
+}
+
+static void sim_rem_shmem_publish (REMOTE *rem)
+{
+SIM_PANEL_SHMEM *shm = rem->shm_hdr;
+t_uint64 *value;
+int32 *bits, *bits_end;
+uint32 i, j;
+
+if (shm == NULL)
+    return;
+value = (t_uint64 *)(shm + 1);
+bits = (int32 *)(value + shm->value_count);
+bits_end = bits + shm->bits_count;
+sim_shmem_atomic_add ((int32 *)&shm->sequence, 1);  /* odd - update in progress */
+for (i = 0; i < rem->shm_reg_count; i++) {
+    SHMEM_REG *sreg = &rem->shm_regs[i];
+
+    for (j = 0; j < sreg->count; j++) {
+        t_value val = get_rval (sreg->reg, sreg->idx + j);
+
+        if (sreg->indirect)
+            val = sim_rem_indirect_value (sreg, val);
+        *value++ = (t_uint64)val;
+        }
+    }
+for (i = 0; i < rem->smp_reg_count; i++) {
+    BITSAMPLE_REG *smp = &rem->smp_regs[i];
+
+    if (bits + 1 + smp->width > bits_end)
+        break;
+    *bits++ = (int32)smp->width;
+    for (j = 0; j < smp->width; j++)
+        *bits++ = smp->bits[j].tot;
+    }
+shm->simulation_time = (t_uint64)sim_gtime ();
+++shm->updates;
+sim_shmem_atomic_add ((int32 *)&shm->sequence, 1);  /* even - update complete */
+}
+
+/* 
+    Parse and setup Remote Console SHMEM command:
+       SHMEM name EVERY nnn USECS reg{,reg...}
+       SHMEM STOP
+
+    The values of the listed registers (reg, reg[n] or reg[first:last], 
+    optionally preceded by a device name and a -I switch for the memory 
+    contents the register points at), followed by the bit totals of 
+    any registers being sampled by COLLECT, are published in the named 
+    shared memory segment.  Updates happen in an event, so they always 
+    reflect state at an instruction boundary, and are bracketed by 
+    sequence number increments so a reader can detect a torn read.
+ */
+static t_stat sim_rem_shmem_cmd_setup (int32 line, CONST char **iptr)
+{
+char gbuf[CBUFSIZE], name[CBUFSIZE];
+int32 usecs;
+uint32 i, bits_count = 0;
+size_t size;
+void *addr;
+t_stat stat = SCPE_OK;
+CONST char *cptr = *iptr;
+REMOTE *rem = &sim_rem_consoles[line];
+
+sim_debug (DBG_SAM, &sim_remote_console, "Shared Memory Setup: %s\n", cptr);
+if (*cptr == 0)         /* required argument? */
+    return SCPE_2FARG;
+cptr = get_glyph_nc (cptr, name, 0);            /* get case sensitive name */
+if (strcasecmp (name, "STOP") == 0) {
+    *iptr = cptr;
+    if (*cptr != 0)
+        return SCPE_2MARG;
+    sim_rem_shmem_stop (rem);
+    return SCPE_OK;
+    }
+cptr = get_glyph (cptr, gbuf, 0);               /* get next glyph */
+if (MATCH_CMD (gbuf, "EVERY") != 0) {
+    *iptr = cptr;
+    return sim_messagef (SCPE_ARG, "Expected EVERY found: %s\n", gbuf);
+    }
+cptr = get_glyph (cptr, gbuf, 0);               /* get next glyph */
+usecs = (int32) get_uint (gbuf, 10, INT_MAX, &stat);
+if ((stat != SCPE_OK) || (usecs <= 0)) {        /* error? */
+    *iptr = cptr;
+    return sim_messagef (SCPE_ARG, "Expected value found: %s\n", gbuf);
+    }
+cptr = get_glyph (cptr, gbuf, 0);               /* get next glyph */
+if ((MATCH_CMD (gbuf, "USECS") != 0) || (*cptr == 0)) {
+    *iptr = cptr;
+    return sim_messagef (SCPE_ARG, "Expected USECS found: %s\n", gbuf);
+    }
+sim_rem_shmem_stop (rem);                       /* Start from a clean slate */
+while (cptr && *cptr) {
+    const char *comma = strchr (cptr, ',');
+    char tbuf[2*CBUFSIZE];
+    const char *tptr;
+    REG *reg;
+    uint32 first, last;
+    int32 saved_switches = sim_switches;
+    t_bool indirect = FALSE;
+    SHMEM_REG *shm_regs;
+
+    if (comma) {
+        strncpy (tbuf, cptr, comma - cptr);
+        tbuf[comma - cptr] = '\0';
+        cptr = comma + 1;
+        }
+    else {
+        strcpy (tbuf, cptr);
+        cptr += strlen (cptr);
+        }
+    tptr = tbuf;
+    if (strchr (tbuf, ' ')) {
+        sim_switches = 0;
+        tptr = get_sim_opt (CMD_OPT_SW|CMD_OPT_DFT, tbuf, &stat); /* get switches and device */
+        indirect = ((sim_switches & SWMASK('I')) != 0);
+        sim_switches = saved_switches;
+        }
+    if (stat != SCPE_OK)
+        break;
+    tptr = get_glyph (tptr, gbuf, 0);           /* get next glyph */
+    reg = find_reg (gbuf, &tptr, sim_dfdev);
+    if (reg == NULL) {
+        stat = sim_messagef (SCPE_NXREG, "Nonexistent Register: %s\n", gbuf);
+        break;
+        }
+    first = last = 0;
+    if (*tptr == '[') {                         /* subscript? */
+        const char *tgptr = ++tptr;
+
+        if (reg->depth <= 1) {                  /* array register? */
+            stat = sim_messagef (SCPE_SUB, "Not Array Register: %s\n", reg->name);
+            break;
+            }
+        first = last = (uint32) strtotv (tgptr, &tptr, 10);
+        if ((tgptr != tptr) && (*tptr == ':')) {
+            tgptr = ++tptr;
+            last = (uint32) strtotv (tgptr, &tptr, 10);
+            }
+        if ((tgptr == tptr) || (*tptr++ != ']')) {
+            stat = sim_messagef (SCPE_SUB, "Missing or Invalid Register Subscript: %s[%s\n", reg->name, tgptr);
+            break;
+            }
+        if ((last < first) || (last >= reg->depth)) {
+            stat = sim_messagef (SCPE_SUB, "Invalid Register Subscript: %s[%d:%d]\n", reg->name, first, last);
+            break;
+            }
+        }
+    shm_regs = (SHMEM_REG *)realloc (rem->shm_regs, (rem->shm_reg_count + 1) * sizeof(*shm_regs));
+    if (shm_regs == NULL) {
+        stat = SCPE_MEM;
+        break;
+        }
+    rem->shm_regs = shm_regs;
+    shm_regs[rem->shm_reg_count].reg = reg;
+    shm_regs[rem->shm_reg_count].idx = first;
+    shm_regs[rem->shm_reg_count].count = 1 + last - first;
+    shm_regs[rem->shm_reg_count].indirect = indirect;
+    shm_regs[rem->shm_reg_count].dptr = sim_dfdev;
+    shm_regs[rem->shm_reg_count].uptr = sim_dfunit;
+    rem->shm_reg_count += 1;
+    rem->shm_value_count += 1 + last - first;
+    }
+if (stat == SCPE_OK) {
+    for (i = 0; i < rem->smp_reg_count; i++)
+        bits_count += 1 + rem->smp_regs[i].width;
+    size = sizeof (SIM_PANEL_SHMEM) + rem->shm_value_count * sizeof (t_uint64) + bits_count * sizeof (int32);
+    stat = sim_shmem_open (name, size, &rem->shm, &addr);
+    }
+if (stat == SCPE_OK) {
+    rem->shm_name = (char *)malloc (1 + strlen (name));
+    if (rem->shm_name == NULL)
+        stat = SCPE_MEM;
+    }
+if (stat != SCPE_OK) {                          /* Error? */
+    *iptr = cptr;
+    sim_rem_shmem_stop (rem);                   /* Cleanup mess */
+    return stat;
+    }
+strcpy (rem->shm_name, name);
+rem->shm_hdr = (SIM_PANEL_SHMEM *)addr;
+memset (rem->shm_hdr, 0, size);
+rem->shm_hdr->size = (unsigned int)size;
+rem->shm_hdr->value_count = rem->shm_value_count;
+rem->shm_hdr->bits_count = bits_count;
+rem->shm_hdr->interval = usecs;
+rem->shm_interval = usecs;
+sim_rem_shmem_publish (rem);                    /* initial contents */
+rem->shm_hdr->magic = SIM_PANEL_SHMEM_MAGIC;    /* now valid */
+sim_activate_after (&rem_con_shm_units[rem->line], rem->shm_interval);
+*iptr = cptr;
+return stat;
+}
+
+t_stat sim_rem_con_shm_svc (UNIT *uptr)
+{
+int line = uptr - rem_con_shm_units;
+REMOTE *rem = &sim_rem_consoles[line];
+
+if (rem->shm_interval) {
+    sim_rem_shmem_publish (rem);
+    sim_activate_after (uptr, rem->shm_interval);       /* reschedule */
+    }
+return SCPE_OK;
+}
+
 static void sim_rem_collect_all_registers (void)
 {
 int32 line;
 
-for (line = 0; line < sim_rem_con_tmxr.lines; line++)
+for (line = 0; line < sim_rem_con_tmxr.lines; line++) {
     sim_rem_collect_registers (&sim_rem_consoles[line]);
+    sim_rem_shmem_publish (&sim_rem_consoles[line]);
+    }
 }
 
 t_stat sim_rem_con_smp_collect_svc (UNIT *uptr)
@@ -1390,6 +1660,8 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
             cptr = strcpy (gbuf, "STOP");
             sim_rem_collect_cmd_setup (i, &cptr);   /* make sure it is now disabled */
             }
+        if (rem->shm)                               /* was a register mirror published? */
+            sim_rem_shmem_stop (rem);
         continue;
         }
     if (master_session && !sim_rem_master_was_connected) {
@@ -1751,6 +2023,10 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
                                             sim_debug (DBG_CMD, &sim_remote_console, "collect_cmd executing\n");
                                             stat = sim_rem_collect_cmd_setup (i, &cptr);
                                             }
+                                        else if (cmdp->action == &x_shmem_cmd) {
+                                            sim_debug (DBG_CMD, &sim_remote_console, "shmem_cmd executing\n");
+                                            stat = sim_rem_shmem_cmd_setup (i, &cptr);
+                                            }
                                         else {
                                             if ((sim_con_stable_registers &&    /* can we process command now? */
                                                  sim_rem_master_mode) ||
@@ -1884,6 +2160,8 @@ if (sim_rem_con_tmxr.lines) {
             sim_activate_after (&rem_con_repeat_units[rem->line], rem->repeat_interval);    /* schedule */
         if (rem->smp_reg_count)
             sim_activate (&rem_con_smp_smpl_units[rem->line], rem->smp_sample_interval);    /* schedule */
+        if (rem->shm_interval)
+            sim_activate_after (&rem_con_shm_units[rem->line], rem->shm_interval);          /* schedule */
         }
     if (i != sim_rem_con_tmxr.lines)
         sim_activate_after (rem_con_data_unit, 100000);     /* continue polling for open sessions */
@@ -1956,13 +2234,14 @@ for (i=0; i<sim_rem_con_tmxr.lines; i++) {
     free (rem->repeat_action);
     sim_cancel (&rem_con_repeat_units[i]);
     sim_cancel (&rem_con_smp_smpl_units[i]);
+    sim_rem_shmem_stop (rem);
     }
 sim_rem_con_tmxr.lines = lines;
 sim_rem_con_tmxr.ldsc = (TMLN *)realloc (sim_rem_con_tmxr.ldsc, sizeof(*sim_rem_con_tmxr.ldsc)*lines);
 memset (sim_rem_con_tmxr.ldsc, 0, sizeof(*sim_rem_con_tmxr.ldsc)*lines);
-sim_remote_console.units = (UNIT *)realloc (sim_remote_console.units, sizeof(*sim_remote_console.units)*((2 * lines) + REM_CON_BASE_UNITS));
-memset (sim_remote_console.units, 0, sizeof(*sim_remote_console.units)*((2 * lines) + REM_CON_BASE_UNITS));
-sim_remote_console.numunits = (2 * lines) + REM_CON_BASE_UNITS;
+sim_remote_console.units = (UNIT *)realloc (sim_remote_console.units, sizeof(*sim_remote_console.units)*((3 * lines) + REM_CON_BASE_UNITS));
+memset (sim_remote_console.units, 0, sizeof(*sim_remote_console.units)*((3 * lines) + REM_CON_BASE_UNITS));
+sim_remote_console.numunits = (3 * lines) + REM_CON_BASE_UNITS;
 rem_con_poll_unit->action = &sim_rem_con_poll_svc;/* remote console connection polling unit */
 rem_con_poll_unit->flags |= UNIT_IDLE;
 rem_con_data_unit->action = &sim_rem_con_data_svc;/* console data handling unit */
@@ -1976,6 +2255,8 @@ for (i=0; i<lines; i++) {
     rem_con_repeat_units[i].action = &sim_rem_con_repeat_svc;
     rem_con_smp_smpl_units[i].flags = UNIT_DIS;
     rem_con_smp_smpl_units[i].action = &sim_rem_con_smp_collect_svc;
+    rem_con_shm_units[i].flags = UNIT_DIS;
+    rem_con_shm_units[i].action = &sim_rem_con_shm_svc;
     rem = &sim_rem_consoles[i];
     rem->line = i;
     rem->lp = &sim_rem_con_tmxr.ldsc[i];
@@ -2280,7 +2561,7 @@ sim_deb_switches = switches &
                     SWMASK ('T') | SWMASK ('A') | 
                     SWMASK ('F') | SWMASK ('N') |
                     SWMASK ('B') | SWMASK ('E') |
-                    SWMASK ('D') );                 /* save debug switches */
+                    SWMASK ('D') | SWMASK ('Z') );  /* save debug switches */
 return old_deb_switches;
 }
 
@@ -2295,6 +2576,8 @@ size_t buffer_size = 0;
 
 if ((cptr == NULL) || (*cptr == 0))                     /* need arg */
     return SCPE_2FARG;
+if ((sim_switches & SWMASK ('Z')) && (sim_switches & SWMASK ('B')))
+    return sim_messagef (SCPE_ARG, "Binary debug output can't use a memory buffer\n");
 if (sim_switches & SWMASK ('B')) {
     cptr = get_glyph_nc (cptr, gbuf, 0);                /* buffer size */
     buffer_size = (size_t)strtoul (gbuf, NULL, 10);
@@ -2304,10 +2587,16 @@ if (sim_switches & SWMASK ('B')) {
 cptr = get_glyph_nc (cptr, gbuf, 0);                    /* get file name */
 if (*cptr != 0)                                         /* now eol? */
     return SCPE_2MARG;
-r = sim_open_logfile (gbuf, FALSE, &sim_deb, &sim_deb_ref);
+r = sim_open_logfile (gbuf, (sim_switches & SWMASK ('Z')) != 0, &sim_deb, &sim_deb_ref);
 
 if (r != SCPE_OK)
     return r;
+if ((sim_switches & SWMASK ('Z')) &&
+    ((sim_deb == stdout) || (sim_deb == stderr) || (sim_deb == sim_log))) {
+    sim_close_logfile (&sim_deb_ref);
+    sim_deb = NULL;
+    return sim_messagef (SCPE_ARG, "Binary debug output must be written to a file\n");
+    }
 
 sim_set_deb_switches (sim_switches);
 
@@ -2338,6 +2627,8 @@ if (sim_deb_switches & SWMASK ('E'))
 if (sim_deb_switches & SWMASK ('B'))
     sim_messagef (SCPE_OK, "   Debug messages will be written to a %u MB circular memory buffer\n", 
                                 (unsigned int)buffer_size);
+if (sim_deb_switches & SWMASK ('Z'))
+    sim_messagef (SCPE_OK, "   Debug messages will be recorded in binary form (see SHOW DEBUG DECODE)\n");
 time(&now);
 if (!sim_quiet) {
     fprintf (sim_deb, "Debug output to \"%s\" at %s", sim_logfile_name (sim_deb, sim_deb_ref), ctime(&now));
@@ -2352,6 +2643,17 @@ if (sim_deb_switches & SWMASK ('B')) {
     sim_debug_buffer_offset = sim_debug_buffer_inuse = 0;
     memset (sim_deb_buffer, 0, sim_deb_buffer_size);
     }
+if (sim_deb_switches & SWMASK ('Z')) {
+    if (!sim_quiet)
+        fflush (sim_deb);                       /* banner precedes records */
+    r = sim_debug_trace_start ();
+    if (r != SCPE_OK) {
+        sim_close_logfile (&sim_deb_ref);
+        sim_deb = NULL;
+        sim_deb_switches = 0;
+        return r;
+        }
+    }
 
 return SCPE_OK;
 }
@@ -2364,6 +2666,8 @@ if (cptr && (*cptr != 0))                               /* now eol? */
     return SCPE_2MARG;
 if (sim_deb == NULL)                                    /* no debug? */
     return SCPE_OK;
+if (sim_deb_switches & SWMASK ('Z'))
+    sim_debug_trace_stop ();                            /* write out binary trace */
 if (sim_deb_switches & SWMASK ('B')) {
     size_t offset = (sim_debug_buffer_inuse == sim_deb_buffer_size) ? sim_debug_buffer_offset : 0;
     const char *bufmsg = "Circular Buffer Contents follow here:\n\n";
@@ -2395,8 +2699,19 @@ t_stat sim_show_debug (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST cha
 {
 int32 i;
 
-if (cptr && (*cptr != 0))
-    return SCPE_2MARG;
+if (cptr && (*cptr != 0)) {
+    char gbuf[CBUFSIZE];
+
+    cptr = get_glyph (cptr, gbuf, 0);
+    if (strcmp (gbuf, "DECODE") != 0)
+        return SCPE_ARG;
+    cptr = get_glyph_nc (cptr, gbuf, 0);                /* file name */
+    if (gbuf[0] == '\0')
+        return SCPE_2FARG;
+    if (*cptr != 0)
+        return SCPE_2MARG;
+    return sim_debug_decode (st, gbuf);
+    }
 if (sim_deb) {
     fprintf (st, "Debug output enabled to \"%s\"\n", 
                  sim_logfile_name (sim_deb, sim_deb_ref));
@@ -2410,6 +2725,8 @@ if (sim_deb) {
         fprintf (st, "   Debug messages are not being filtered to summarize duplicate lines\n");
     if (sim_deb_switches & SWMASK ('E'))
         fprintf (st, "   Debug messages containing blob data in EBCDIC will display in readable form\n");
+    if (sim_deb_switches & SWMASK ('Z'))
+        sim_debug_trace_stats (st);
     for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
         t_bool unit_debug = FALSE;
         uint32 unit;
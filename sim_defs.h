@@ -600,6 +600,10 @@ struct UNIT {
     char                *uname;                         /* Unit name */
     DEVICE              *dptr;                          /* DEVICE linkage (backpointer) */
     uint32              dctrl;                          /* debug control */
+    /* Event heap scheduler state */
+    double              q_time;                         /* absolute event queue time */
+    t_uint64            q_seq;                          /* activation sequence number */
+    int32               q_index;                        /* position in event heap */
 #ifdef SIM_ASYNCH_IO
     void                (*a_check_completion)(UNIT *);
     t_bool              (*a_is_active)(UNIT *);
@@ -730,8 +734,12 @@ struct C1TAB {
                             int32 flag, CONST char *cptr);/* action routine */
     int32               arg;                            /* argument */
     const char          *help;                          /* help string */
+    uint32              flags;                          /* flags */
     };
 
+/* c1tab flag bits */
+#define C1TAB_NC        0001                            /* no UC conversion */
+
 struct SHTAB {
     const char          *name;                          /* name */
     t_stat              (*action)(FILE *st, DEVICE *dptr,
@@ -838,6 +846,7 @@ struct EXPECT {
     uint32              buf_ins;                        /* buffer insertion point for the next output data */
     uint32              buf_size;                       /* buffer size */
     uint32              buf_data;                       /* count of data in buffer */
+    struct EXPMATCH     *matcher;                       /* literal rule matcher (NULL until built) */
     };
 
 /* Send Context */
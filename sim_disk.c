@@ -51,6 +51,8 @@ Public routines:
    sim_disk_show_capac       show disk capacity
    sim_disk_set_async        enable asynchronous operation
    sim_disk_clr_async        disable asynchronous operation
+   sim_disk_set_cache        configure sector cache
+   sim_disk_show_cache       show sector cache configuration and statistics
    sim_disk_data_trace       debug support
    sim_disk_test             unit test routine
 
@@ -86,6 +88,20 @@ Internal routines:
 #include <pthread.h>
 #endif
 
+/* SIMH format sector data is transferred with pread/pwrite on the 
+   container's descriptor, while the footer and other metadata are still 
+   accessed through the FILE*.  The positioned calls never move the file 
+   offset, and _sim_disk_rdsect/_sim_disk_wrsect fflush the stream first 
+   (so no buffered stdio write can later overwrite sectors) and again after 
+   writing (so no stdio read buffer keeps stale sector data).  Every stdio 
+   access repositions with sim_fseeko before reading or writing. */
+#if defined (__linux) || defined (__linux__) || defined (__APPLE__) || defined (__FreeBSD__) || defined (__NetBSD__) || defined (__OpenBSD__) || defined (__sun) || defined (__sun__)
+#include <unistd.h>
+#include <sys/mman.h>
+#define DK_USE_PREAD_PWRITE     /* positioned I/O for SIMH format containers */
+#define DK_USE_MMAP             /* memory mapped fixed size containers */
+#endif
+
 /* Newly created SIMH (and possibly RAW) disk containers       */
 /* will have this data as the last 512 bytes of the container  */
 /* It will not be considered part of the data in the container */
@@ -159,10 +175,14 @@ struct disk_context {
     uint32              auto_format;        /* Format determined dynamically */
     struct simh_disk_footer
                         *footer;
+    struct disk_cache   *cache;             /* Sector cache (NULL when not caching) */
+    uint8               *map;               /* Mapped container data (NULL when not mapped) */
+    t_offset            map_size;           /* Bytes of container data mapped */
 #if defined _WIN32
     HANDLE              disk_handle;        /* OS specific Raw device handle */
 #endif
 #if defined SIM_ASYNCH_IO
+#define DK_AIO_SLOTS    16                  /* outstanding asynchronous requests per unit */
     int                 asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
     pthread_mutex_t     lock;
@@ -171,46 +191,46 @@ struct disk_context {
     pthread_cond_t      io_cond;
     pthread_cond_t      io_done;
     pthread_cond_t      startup_cond;
-    int                 io_dop;
-    uint8               *buf;
-    t_seccnt            *rsects;
-    t_seccnt            sects;
-    t_lba               lba;
-    DISK_PCALLBACK      callback;
-    t_stat              io_status;
+    struct disk_aio_request {
+        int             dop;                /* operation */
+        t_lba           lba;
+        uint8           *buf;
+        t_seccnt        *rsects;
+        t_seccnt        sects;
+        DISK_PCALLBACK  callback;
+        t_stat          status;             /* completion status */
+        }               io_queue[DK_AIO_SLOTS];
+    uint32              io_head;            /* oldest undelivered request */
+    uint32              io_next;            /* next request to perform */
+    uint32              io_tail;            /* next free slot */
 #endif
     };
 
 #define disk_ctx up8                        /* Field in Unit structure which points to the disk_context */
 
 #if defined SIM_ASYNCH_IO
+/* Asynchronous requests for a unit are held in a ring of DK_AIO_SLOTS
+   requests.  The indices are free running counters:
+
+        io_head     oldest request whose completion hasn't been delivered
+        io_next     next request the I/O thread will perform
+        io_tail     next free slot
+
+   The I/O thread performs requests in the order they were queued and
+   completion callbacks are delivered (in the main simulator thread) in
+   that same order, so the sequence of callbacks a controller observes
+   never depends on host thread scheduling.  With SET NOASYNCH each
+   request completes, and its callback is called, before the _a routine
+   returns. */
+
 #define AIO_CALLSETUP                                               \
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;   \
                                                                     \
 if ((!callback) || !ctx->asynch_io)
 
 #define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
-    if (ctx->asynch_io) {                                       \
-        struct disk_context *ctx =                              \
-                      (struct disk_context *)uptr->disk_ctx;    \
-                                                                \
-        pthread_mutex_lock (&ctx->io_lock);                     \
-                                                                \
-        sim_debug_unit (ctx->dbit, uptr,                        \
-      "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d)\n",\
-                op, (int)(uptr - ctx->dptr->units), _lba, _sects);\
-                                                                \
-        if (ctx->callback)                                      \
-            abort(); /* horrible mistake, stop */               \
-        ctx->io_dop = op;                                       \
-        ctx->lba = _lba;                                        \
-        ctx->buf = _buf;                                        \
-        ctx->sects = _sects;                                    \
-        ctx->rsects = _rsects;                                  \
-        ctx->callback = _callback;                              \
-        pthread_cond_signal (&ctx->io_cond);                    \
-        pthread_mutex_unlock (&ctx->io_lock);                   \
-        }                                                       \
+    if ((_callback) && ctx->asynch_io)                          \
+        _disk_aio_queue (uptr, op, _lba, _buf, _rsects, _sects, _callback);\
     else                                                        \
         if (_callback)                                          \
             (_callback) (uptr, r);
@@ -221,11 +241,46 @@ if ((!callback) || !ctx->asynch_io)
 #define DOP_WSEC  2             /* sim_disk_wrsect_a */
 #define DOP_IAVL  3             /* sim_disk_isavailable_a */
 
+static void _disk_completion_dispatch (UNIT *uptr);
+
+/* Queue a request for the unit's I/O thread.  When all slots are in use
+   the caller waits for the oldest request to complete and its completion
+   is delivered before the new request is queued. */
+
+static void _disk_aio_queue (UNIT *uptr, int op, t_lba lba, uint8 *buf, t_seccnt *rsects, t_seccnt sects, DISK_PCALLBACK callback)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_aio_request *req;
+
+pthread_mutex_lock (&ctx->io_lock);
+sim_debug_unit (ctx->dbit, uptr, "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d, queued=%u)\n",
+                op, (int)(uptr - ctx->dptr->units), lba, sects, ctx->io_tail - ctx->io_head);
+while ((ctx->io_tail - ctx->io_head) == DK_AIO_SLOTS) { /* queue full? */
+    while (ctx->io_head == ctx->io_next)                /* wait for the oldest to complete */
+        pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
+    pthread_mutex_unlock (&ctx->io_lock);
+    _disk_completion_dispatch (uptr);
+    pthread_mutex_lock (&ctx->io_lock);
+    }
+req = &ctx->io_queue[ctx->io_tail % DK_AIO_SLOTS];
+req->dop = op;
+req->lba = lba;
+req->buf = buf;
+req->sects = sects;
+req->rsects = rsects;
+req->callback = callback;
+req->status = SCPE_OK;
+++ctx->io_tail;
+pthread_cond_signal (&ctx->io_cond);
+pthread_mutex_unlock (&ctx->io_lock);
+}
+
 static void *
 _disk_io(void *arg)
 {
 UNIT* volatile uptr = (UNIT*)arg;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_aio_request *req;
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution
    thread which in general won't be readily yielding the processor when
@@ -237,23 +292,26 @@ sim_debug_unit (ctx->dbit, uptr, "_disk_io(unit=%d) starting\n", (int)(uptr - ct
 pthread_mutex_lock (&ctx->io_lock);
 pthread_cond_signal (&ctx->startup_cond);   /* Signal we're ready to go */
 while (ctx->asynch_io) {
-    pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
-    if (ctx->io_dop == DOP_DONE)
-        break;
+    if (ctx->io_next == ctx->io_tail) {     /* Nothing queued? */
+        pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
+        continue;
+        }
+    req = &ctx->io_queue[ctx->io_next % DK_AIO_SLOTS];
     pthread_mutex_unlock (&ctx->io_lock);
-    switch (ctx->io_dop) {
+    switch (req->dop) {
         case DOP_RSEC:
-            ctx->io_status = sim_disk_rdsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            req->status = sim_disk_rdsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_WSEC:
-            ctx->io_status = sim_disk_wrsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            req->status = sim_disk_wrsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_IAVL:
-            ctx->io_status = sim_disk_isavailable (uptr);
+            req->status = sim_disk_isavailable (uptr);
             break;
         }
     pthread_mutex_lock (&ctx->io_lock);
-    ctx->io_dop = DOP_DONE;
+    req->dop = DOP_DONE;
+    ++ctx->io_next;
     pthread_cond_signal (&ctx->io_done);
     sim_activate (uptr, ctx->asynch_io_latency);
     }
@@ -270,25 +328,31 @@ return NULL;
    routine is to put the unit in proper condition to digest what may have
    occurred in the asynchrconous thread.
   
-   Since disk processing only handles a single I/O at a time to a
-   particular disk device (due to using stdio for the SimH Disk format
-   and stdio doesn't have an atomic seek+(read|write) operation),
-   we have the opportunity to possibly detect improper attempts to
-   issue multiple concurrent I/O requests. */
+   Every request which has completed is delivered to its callback, oldest
+   first.  Completions left undelivered when asynchronous operation is
+   disabled (the I/O thread and its lock are gone) are delivered the next
+   time this routine runs. */
 static void _disk_completion_dispatch (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-DISK_PCALLBACK callback = ctx->callback;
-
-sim_debug_unit (ctx->dbit, uptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop, (void *)(ctx->callback));
-
-if (ctx->io_dop != DOP_DONE)
-    abort();                                            /* horribly wrong, stop */
+t_bool locked = ctx->asynch_io;
+struct disk_aio_request req;
 
-if (ctx->callback && ctx->io_dop == DOP_DONE) {
-    ctx->callback = NULL;
-    callback (uptr, ctx->io_status);
+if (locked)
+    pthread_mutex_lock (&ctx->io_lock);
+while (ctx->io_head != ctx->io_next) {
+    req = ctx->io_queue[ctx->io_head % DK_AIO_SLOTS];
+    ++ctx->io_head;
+    if (locked)
+        pthread_mutex_unlock (&ctx->io_lock);
+    sim_debug_unit (ctx->dbit, uptr, "_disk_completion_dispatch(unit=%d, lba=0x%X, callback=%p, status=%d)\n", (int)(uptr - ctx->dptr->units), req.lba, (void *)(req.callback), req.status);
+    if (req.callback)
+        req.callback (uptr, req.status);
+    if (locked)
+        pthread_mutex_lock (&ctx->io_lock);
     }
+if (locked)
+    pthread_mutex_unlock (&ctx->io_lock);
 }
 
 static t_bool _disk_is_active (UNIT *uptr)
@@ -296,8 +360,8 @@ static t_bool _disk_is_active (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug_unit (ctx->dbit, uptr, "_disk_is_active(unit=%d, dop=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop);
-    return (ctx->io_dop != DOP_DONE);
+    sim_debug_unit (ctx->dbit, uptr, "_disk_is_active(unit=%d, pending=%u)\n", (int)(uptr - ctx->dptr->units), ctx->io_tail - ctx->io_next);
+    return (ctx->io_next != ctx->io_tail);
     }
 return FALSE;
 }
@@ -307,10 +371,10 @@ static t_bool _disk_cancel (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug_unit (ctx->dbit, uptr, "_disk_cancel(unit=%d, dop=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop);
+    sim_debug_unit (ctx->dbit, uptr, "_disk_cancel(unit=%d, pending=%u)\n", (int)(uptr - ctx->dptr->units), ctx->io_tail - ctx->io_next);
     if (ctx->asynch_io) {
         pthread_mutex_lock (&ctx->io_lock);
-        while (ctx->io_dop != DOP_DONE)
+        while (ctx->io_next != ctx->io_tail)
             pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
         pthread_mutex_unlock (&ctx->io_lock);
         }
@@ -333,6 +397,7 @@ static FILE *sim_vhd_disk_create_diff (const char *szVHDPath, const char *szPare
 static FILE *sim_vhd_disk_merge (const char *szVHDPath, char **ParentVHD);
 static int sim_vhd_disk_close (FILE *f);
 static void sim_vhd_disk_flush (FILE *f);
+static int sim_vhd_disk_fixed_fd (FILE *f);
 static t_offset sim_vhd_disk_size (FILE *f);
 static t_stat sim_vhd_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
 static t_stat sim_vhd_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
@@ -354,6 +419,16 @@ static t_stat sim_os_disk_info_raw (FILE *f, uint32 *sector_size, uint32 *remova
 static char *HostPathToVhdPath (const char *szHostPath, char *szVhdPath, size_t VhdPathSize);
 static char *VhdPathToHostPath (const char *szVhdPath, char *szHostPath, size_t HostPathSize);
 static t_offset get_filesystem_size (UNIT *uptr);
+static t_stat _sim_disk_rdsect_direct (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
+static t_stat _sim_disk_wrsect_direct (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
+static t_stat _disk_cache_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
+static t_stat _disk_cache_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
+static t_stat _disk_cache_open (UNIT *uptr);
+static t_stat _disk_cache_flush (UNIT *uptr);
+static t_stat _disk_cache_close (UNIT *uptr);
+static void _sim_disk_map (UNIT *uptr);
+static void _sim_disk_unmap (UNIT *uptr);
+static void _sim_disk_map_flush (UNIT *uptr, t_bool wait);
 
 struct sim_disk_fmt {
     const char          *name;                          /* name */
@@ -588,6 +663,8 @@ sim_debug_unit (ctx->dbit, uptr, "sim_disk_clr_async(unit=%d)\n", (int)(uptr - c
 
 if (ctx->asynch_io) {
     pthread_mutex_lock (&ctx->io_lock);
+    while (ctx->io_next != ctx->io_tail)                /* let queued requests finish */
+        pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
     ctx->asynch_io = 0;
     pthread_cond_signal (&ctx->io_cond);
     pthread_mutex_unlock (&ctx->io_lock);
@@ -605,7 +682,10 @@ return SCPE_OK;
 static t_stat _sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
 {
 t_offset da;
-uint32 err, tbc;
+uint32 tbc;
+#if !defined (DK_USE_PREAD_PWRITE)
+uint32 err;
+#endif
 size_t i;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
@@ -615,6 +695,26 @@ da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
 if (sectsread)
     *sectsread = 0;
+#if defined (DK_USE_PREAD_PWRITE)
+fflush (uptr->fileref);                                 /* push any stdio writes to the fd */
+i = 0;
+while (i < tbc) {                                       /* positioned read, no shared file position */
+    ssize_t bytesread = pread (fileno (uptr->fileref), buf + i, tbc - i, (off_t)(da + i));
+
+    if (bytesread < 0) {
+        if (errno == EINTR)
+            continue;
+        return SCPE_IOERR;
+        }
+    if (bytesread == 0)
+        break;
+    i += (size_t)bytesread;
+    }
+if (i < tbc)                                            /* fill */
+    memset (&buf[i], 0, tbc - i);
+if (sectsread)
+    *sectsread = (t_seccnt)(i / ctx->sector_size);
+#else
 while (tbc) {
     size_t sectbytes;
 
@@ -636,15 +736,51 @@ while (tbc) {
     da += sectbytes;
     buf += sectbytes;
     }
+#endif
 return SCPE_OK;
 }
 
+/* Data transfer totals across all disk units (reported by BENCHMARK).
+   Transfers complete in per unit I/O threads as well as the simulator
+   thread, so the totals are updated under a lock. */
+
+static t_uint64 disk_bytes_read = 0;
+static t_uint64 disk_bytes_written = 0;
+#if defined SIM_ASYNCH_IO
+static pthread_mutex_t disk_totals_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static t_stat _sim_disk_count (t_stat r, t_uint64 *total, t_seccnt sects, uint32 sector_size)
+{
+if (sects == 0)
+    return r;
+#if defined SIM_ASYNCH_IO
+pthread_mutex_lock (&disk_totals_lock);
+#endif
+*total += (t_uint64)sects * sector_size;
+#if defined SIM_ASYNCH_IO
+pthread_mutex_unlock (&disk_totals_lock);
+#endif
+return r;
+}
+
+void sim_disk_data_totals (t_uint64 *bytes_read, t_uint64 *bytes_written)
+{
+#if defined SIM_ASYNCH_IO
+pthread_mutex_lock (&disk_totals_lock);
+#endif
+*bytes_read = disk_bytes_read;
+*bytes_written = disk_bytes_written;
+#if defined SIM_ASYNCH_IO
+pthread_mutex_unlock (&disk_totals_lock);
+#endif
+}
+
 t_stat sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
 {
-t_stat r;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-uint32 f = DK_GET_FMT (uptr);
 t_seccnt sread = 0;
+t_stat r;
 
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
 
@@ -653,9 +789,32 @@ if ((sects == 1) &&                                     /* Single sector reads *
     memset (buf, '\0', ctx->sector_size);               /* are bad block management efforts - zero buffer */
     if (sectsread)
         *sectsread = 1;
-    return SCPE_OK;                                     /* return success */
+    return _sim_disk_count (SCPE_OK, &disk_bytes_read, 1, ctx->sector_size);/* return success */
     }
+if (ctx->cache)
+    r = _disk_cache_rdsect (uptr, lba, buf, &sread, sects);
+else
+    r = _sim_disk_rdsect_direct (uptr, lba, buf, &sread, sects);
+if (sectsread)
+    *sectsread = sread;
+return _sim_disk_count (r, &disk_bytes_read, sread, ctx->sector_size);
+}
 
+static t_stat _sim_disk_rdsect_direct (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+t_stat r;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 f = DK_GET_FMT (uptr);
+t_seccnt sread = 0;
+
+if ((ctx->map != NULL) &&                               /* Mapped container data? */
+    ((((t_offset)lba) + sects) * ctx->sector_size <= ctx->map_size)) {
+    memcpy (buf, ctx->map + ((t_offset)lba) * ctx->sector_size, sects * ctx->sector_size);
+    sim_buf_swap_data (buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
+    if (sectsread)
+        *sectsread = sects;
+    return SCPE_OK;
+    }
 if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
     ((0 == ((lba*ctx->sector_size) & (ctx->storage_sector_size - 1))) &&
      (0 == ((sects*ctx->sector_size) & (ctx->storage_sector_size - 1)))) ||
@@ -719,6 +878,9 @@ t_offset da;
 uint32 err, tbc;
 size_t i;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+#if defined (DK_USE_PREAD_PWRITE)
+uint8 *tbuf = NULL;
+#endif
 
 sim_debug_unit (ctx->dbit, uptr, "_sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
 
@@ -726,6 +888,33 @@ da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
 if (sectswritten)
     *sectswritten = 0;
+#if defined (DK_USE_PREAD_PWRITE)
+if (!sim_end && (ctx->xfer_element_size != sizeof (char))) {
+    tbuf = (uint8*) malloc (tbc);
+    if (NULL == tbuf)
+        return SCPE_MEM;
+    sim_buf_copy_swapped (tbuf, buf, ctx->xfer_element_size, tbc / ctx->xfer_element_size);
+    buf = tbuf;
+    }
+fflush (uptr->fileref);                                 /* push any stdio writes to the fd */
+i = 0;
+err = 0;
+while (i < tbc) {                                       /* positioned write, no shared file position */
+    ssize_t byteswritten = pwrite (fileno (uptr->fileref), buf + i, tbc - i, (off_t)(da + i));
+
+    if (byteswritten < 0) {
+        if (errno == EINTR)
+            continue;
+        err = errno;
+        break;
+        }
+    i += (size_t)byteswritten;
+    }
+fflush (uptr->fileref);                                 /* drop stdio data the write made stale */
+free (tbuf);
+if (sectswritten)
+    *sectswritten += (t_seccnt)((i + ctx->sector_size - 1)/ctx->sector_size);
+#else
 err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
 if (err)
     return SCPE_IOERR;
@@ -733,6 +922,7 @@ i = sim_fwrite (buf, ctx->xfer_element_size, tbc/ctx->xfer_element_size, uptr->f
 if (sectswritten)
     *sectswritten += (t_seccnt)((i * ctx->xfer_element_size + ctx->sector_size - 1)/ctx->sector_size);
 err = ferror (uptr->fileref);
+#endif
 if (err)
     return SCPE_IOERR;
 return SCPE_OK;
@@ -741,9 +931,8 @@ return SCPE_OK;
 t_stat sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-uint32 f = DK_GET_FMT (uptr);
+t_seccnt swritten = 0;
 t_stat r;
-uint8 *tbuf = NULL;
 
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
 
@@ -776,6 +965,30 @@ if (uptr->dynflags & UNIT_DISK_CHK) {
             }
         }
     }
+if (ctx->cache)
+    r = _disk_cache_wrsect (uptr, lba, buf, &swritten, sects);
+else
+    r = _sim_disk_wrsect_direct (uptr, lba, buf, &swritten, sects);
+if (sectswritten)
+    *sectswritten = swritten;
+return _sim_disk_count (r, &disk_bytes_written, swritten, ctx->sector_size);
+}
+
+static t_stat _sim_disk_wrsect_direct (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 f = DK_GET_FMT (uptr);
+t_stat r;
+uint8 *tbuf = NULL;
+
+if ((ctx->map != NULL) &&                               /* Mapped container data? */
+    (!(uptr->flags & UNIT_RO)) &&
+    ((((t_offset)lba) + sects) * ctx->sector_size <= ctx->map_size)) {
+    sim_buf_copy_swapped (ctx->map + ((t_offset)lba) * ctx->sector_size, buf, ctx->xfer_element_size, (sects * ctx->sector_size) / ctx->xfer_element_size);
+    if (sectswritten)
+        *sectswritten = sects;
+    return SCPE_OK;
+    }
 switch (f) {                                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
         return _sim_disk_wrsect (uptr, lba, buf, sectswritten, sects);
@@ -847,6 +1060,745 @@ AIO_CALL(DOP_WSEC, lba, buf, sectswritten, sects, callback);
 return r;
 }
 
+/* Sector Cache
+
+   An optional per unit cache of recently used sectors sits beneath the
+   sim_disk_rdsect and sim_disk_wrsect interfaces and works the same way
+   for all container formats.  Sectors are cached in lines of about
+   DK_CACHE_LINE_BYTES (a whole number of sectors) which are replaced in
+   least recently used order.  Line data is held exactly as it is
+   presented to and returned to the simulator, so any byte swapping for
+   the container happens when lines are loaded or written back.
+
+   Sequential read streams are detected and, once established, a miss
+   also loads the following lines with the same container read.
+
+   In WRITETHROUGH mode every write goes directly to the container and
+   updates any cached copy.  In WRITEBACK mode writes only update the
+   cache; dirty lines are written to the container when they are evicted,
+   when the simulator stops (via _sim_disk_io_flush), on reset and when
+   the unit is detached.
+
+   Cache settings are made per unit and are remembered across attach and
+   detach:
+
+        SET <unit> CACHE{=size{K|M}}    enable cache (default 1MB)
+        SET <unit> NOCACHE              disable cache
+        SET <unit> WRITEBACK            cache writes until flushed
+        SET <unit> WRITETHROUGH         write directly to the container
+
+   Requests which extend beyond the end of the unit bypass the cache.
+*/
+
+#define DK_CACHE_LINE_BYTES     4096            /* nominal line size */
+#define DK_CACHE_DEFAULT_KB     1024            /* default cache size */
+#define DK_CACHE_READAHEAD      16              /* lines to read ahead */
+#define DK_CACHE_SEQ_THRESHOLD  2               /* sequential reads before read ahead */
+
+struct disk_cache_line {
+    t_lba               line;                   /* line number (lba / line_sects) */
+    t_bool              inuse;                  /* line holds data */
+    uint32              valid;                  /* sectors present in the container */
+    uint32              dirty_lo;               /* first dirty sector */
+    uint32              dirty_hi;               /* last dirty sector + 1 (0 when clean) */
+    uint8               *data;                  /* line data */
+    struct disk_cache_line
+                        *hnext;                 /* hash chain */
+    struct disk_cache_line
+                        *prev;                  /* LRU list */
+    struct disk_cache_line
+                        *next;
+    };
+
+struct disk_cache {
+    uint32              line_sects;             /* sectors per line */
+    uint32              line_bytes;             /* bytes per line */
+    uint32              nlines;                 /* lines in cache */
+    uint32              max_load;               /* most lines loaded by one read */
+    uint32              hash_mask;              /* hash buckets - 1 */
+    t_lba               total_sects;            /* sectors on the unit */
+    t_bool              write_back;             /* WRITEBACK mode */
+    struct disk_cache_line
+                        *lines;
+    struct disk_cache_line
+                        **hash;
+    struct disk_cache_line
+                        lru;                    /* LRU list head (next is most recent) */
+    uint8               *data;                  /* storage for all lines */
+    uint8               *ldbuf;                 /* container read buffer */
+    t_lba               next_lba;               /* sequential stream detection */
+    uint32              seq_count;
+    t_uint64            reads;                  /* statistics */
+    t_uint64            read_hits;
+    t_uint64            writes;
+    t_uint64            loads;
+    t_uint64            readaheads;
+    t_uint64            writebacks;
+    };
+
+/* Cache and mapping settings by unit, kept while the unit is detached */
+
+struct disk_cache_setting {
+    UNIT                *uptr;
+    uint32              size_kb;                /* cache size (0 when disabled) */
+    t_bool              write_back;             /* WRITEBACK mode */
+    t_bool              mmap;                   /* MMAP mode */
+    };
+
+static struct disk_cache_setting *disk_cache_settings = NULL;
+static uint32 disk_cache_setting_count = 0;
+
+static struct disk_cache_setting *_disk_cache_setting (UNIT *uptr, t_bool create)
+{
+uint32 i;
+struct disk_cache_setting *settings;
+
+for (i = 0; i < disk_cache_setting_count; i++)
+    if (disk_cache_settings[i].uptr == uptr)
+        return &disk_cache_settings[i];
+if (!create)
+    return NULL;
+settings = (struct disk_cache_setting *)realloc (disk_cache_settings, (disk_cache_setting_count + 1) * sizeof (*settings));
+if (settings == NULL)
+    return NULL;
+disk_cache_settings = settings;
+memset (&settings[i], 0, sizeof (settings[i]));
+settings[i].uptr = uptr;
+++disk_cache_setting_count;
+return &settings[i];
+}
+
+static void _disk_cache_unlink (struct disk_cache_line *l)
+{
+l->prev->next = l->next;
+l->next->prev = l->prev;
+}
+
+static void _disk_cache_mru (struct disk_cache *cache, struct disk_cache_line *l)
+{
+_disk_cache_unlink (l);
+l->next = cache->lru.next;
+l->prev = &cache->lru;
+cache->lru.next->prev = l;
+cache->lru.next = l;
+}
+
+static void _disk_cache_lru (struct disk_cache *cache, struct disk_cache_line *l)
+{
+_disk_cache_unlink (l);
+l->prev = cache->lru.prev;
+l->next = &cache->lru;
+cache->lru.prev->next = l;
+cache->lru.prev = l;
+}
+
+static struct disk_cache_line *_disk_cache_find (struct disk_cache *cache, t_lba line)
+{
+struct disk_cache_line *l;
+
+for (l = cache->hash[line & cache->hash_mask]; l != NULL; l = l->hnext)
+    if (l->line == line)
+        return l;
+return NULL;
+}
+
+static void _disk_cache_discard (struct disk_cache *cache, struct disk_cache_line *l)
+{
+struct disk_cache_line **lp;
+
+for (lp = &cache->hash[l->line & cache->hash_mask]; *lp != NULL; lp = &(*lp)->hnext)
+    if (*lp == l) {
+        *lp = l->hnext;
+        break;
+        }
+l->hnext = NULL;
+l->inuse = FALSE;
+l->dirty_lo = l->dirty_hi = 0;
+_disk_cache_lru (cache, l);
+}
+
+static t_stat _disk_cache_writeback (UNIT *uptr, struct disk_cache_line *l)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+t_stat r;
+
+if (l->dirty_hi == 0)
+    return SCPE_OK;
+r = _sim_disk_wrsect_direct (uptr, l->line * cache->line_sects + l->dirty_lo,
+                             l->data + l->dirty_lo * ctx->sector_size, NULL, l->dirty_hi - l->dirty_lo);
+if (r == SCPE_OK) {
+    l->dirty_lo = l->dirty_hi = 0;
+    ++cache->writebacks;
+    }
+return r;
+}
+
+/* Claim the least recently used line for a new line number */
+
+static struct disk_cache_line *_disk_cache_alloc (UNIT *uptr, t_lba line, t_stat *stat)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+struct disk_cache_line *l = cache->lru.prev;
+
+if (l->inuse) {
+    *stat = _disk_cache_writeback (uptr, l);
+    if (*stat != SCPE_OK)
+        return NULL;
+    _disk_cache_discard (cache, l);
+    }
+l->line = line;
+l->inuse = TRUE;
+l->valid = 0;
+l->dirty_lo = l->dirty_hi = 0;
+l->hnext = cache->hash[line & cache->hash_mask];
+cache->hash[line & cache->hash_mask] = l;
+_disk_cache_mru (cache, l);
+return l;
+}
+
+/* Load count consecutive uncached lines with a single container read */
+
+static t_stat _disk_cache_load (UNIT *uptr, t_lba line, uint32 count, struct disk_cache_line **first)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+struct disk_cache_line *l;
+t_lba lba = line * cache->line_sects;
+t_seccnt sects = count * cache->line_sects;
+t_seccnt sread = 0;
+uint32 i;
+t_stat r;
+
+if (lba + sects > cache->total_sects)
+    sects = cache->total_sects - lba;
+memset (cache->ldbuf, 0, count * cache->line_bytes);
+r = _sim_disk_rdsect_direct (uptr, lba, cache->ldbuf, &sread, sects);
+if (r != SCPE_OK)
+    return r;
+for (i = 0; i < count; i++) {
+    l = _disk_cache_alloc (uptr, line + i, &r);
+    if (l == NULL)
+        return r;
+    memcpy (l->data, cache->ldbuf + i * cache->line_bytes, cache->line_bytes);
+    if (sread >= (i + 1) * cache->line_sects)
+        l->valid = cache->line_sects;
+    else
+        if (sread > i * cache->line_sects)
+            l->valid = sread - i * cache->line_sects;
+    if (i == 0)
+        *first = l;
+    }
+cache->loads += count;
+return SCPE_OK;
+}
+
+static int _disk_cache_line_compare (const void *pa, const void *pb)
+{
+const struct disk_cache_line *a = *(const struct disk_cache_line * const *)pa;
+const struct disk_cache_line *b = *(const struct disk_cache_line * const *)pb;
+
+return (a->line < b->line) ? -1 : ((a->line > b->line) ? 1 : 0);
+}
+
+/* Write all dirty lines to the container in ascending sector order */
+
+static t_stat _disk_cache_flush (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache;
+struct disk_cache_line **dirty;
+uint32 i, ndirty = 0;
+t_stat r, stat = SCPE_OK;
+
+if ((ctx == NULL) || ((cache = ctx->cache) == NULL) || (!cache->write_back))
+    return SCPE_OK;
+dirty = (struct disk_cache_line **)malloc (cache->nlines * sizeof (*dirty));
+if (dirty == NULL)
+    return SCPE_MEM;
+for (i = 0; i < cache->nlines; i++)
+    if (cache->lines[i].inuse && cache->lines[i].dirty_hi)
+        dirty[ndirty++] = &cache->lines[i];
+qsort (dirty, ndirty, sizeof (*dirty), _disk_cache_line_compare);
+sim_debug_unit (ctx->dbit, uptr, "_disk_cache_flush(unit=%d, dirty lines=%u)\n", (int)(uptr - ctx->dptr->units), ndirty);
+for (i = 0; i < ndirty; i++) {
+    r = _disk_cache_writeback (uptr, dirty[i]);
+    if (r != SCPE_OK)
+        stat = r;
+    }
+free (dirty);
+return stat;
+}
+
+/* Flush and discard any cached lines in the sector range [lba, end) */
+
+static t_stat _disk_cache_invalidate (UNIT *uptr, t_lba lba, t_lba end)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+struct disk_cache_line *l;
+t_stat r = SCPE_OK;
+uint32 i;
+
+for (i = 0; i < cache->nlines; i++) {
+    l = &cache->lines[i];
+    if ((!l->inuse) ||
+        ((l->line + 1) * cache->line_sects <= lba) ||
+        (l->line * cache->line_sects >= end))
+        continue;
+    r = _disk_cache_writeback (uptr, l);
+    if (r != SCPE_OK)
+        return r;
+    _disk_cache_discard (cache, l);
+    }
+return r;
+}
+
+static t_stat _disk_cache_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+struct disk_cache_line *l;
+t_lba end = lba + sects;
+t_seccnt sread = 0;
+t_bool short_read = FALSE;
+t_bool hit = TRUE;
+t_stat r;
+
+if (sectsread)
+    *sectsread = 0;
+if ((end > cache->total_sects) || (end < lba)) {        /* beyond the end of the unit? */
+    r = _disk_cache_flush (uptr);
+    if (r != SCPE_OK)
+        return r;
+    return _sim_disk_rdsect_direct (uptr, lba, buf, sectsread, sects);
+    }
+++cache->reads;
+if (lba == cache->next_lba)                             /* sequential stream? */
+    ++cache->seq_count;
+else
+    cache->seq_count = 0;
+cache->next_lba = end;
+while (lba < end) {
+    t_lba line = lba / cache->line_sects;
+    uint32 off = lba % cache->line_sects;
+    uint32 cnt = cache->line_sects - off;
+
+    if (cnt > end - lba)
+        cnt = end - lba;
+    l = _disk_cache_find (cache, line);
+    if (l == NULL) {
+        uint32 want = (uint32)((end - 1) / cache->line_sects - line) + 1;
+        uint32 count;
+
+        hit = FALSE;
+        if (cache->seq_count >= DK_CACHE_SEQ_THRESHOLD)
+            want += DK_CACHE_READAHEAD;
+        if (want > cache->max_load)
+            want = cache->max_load;
+        for (count = 1; count < want; count++) {
+            if (((line + count) * cache->line_sects >= cache->total_sects) ||
+                (_disk_cache_find (cache, line + count) != NULL))
+                break;
+            }
+        if (((line + count - 1) * cache->line_sects) >= end)
+            cache->readaheads += (line + count) - ((end - 1) / cache->line_sects + 1);
+        r = _disk_cache_load (uptr, line, count, &l);
+        if (r != SCPE_OK) {
+            if (sectsread)
+                *sectsread = sread;
+            return r;
+            }
+        }
+    else
+        _disk_cache_mru (cache, l);
+    memcpy (buf, l->data + off * ctx->sector_size, cnt * ctx->sector_size);
+    if (!short_read) {
+        if (off + cnt <= l->valid)
+            sread += cnt;
+        else {
+            if (l->valid > off)
+                sread += l->valid - off;
+            short_read = TRUE;
+            }
+        }
+    buf += cnt * ctx->sector_size;
+    lba += cnt;
+    }
+if (hit)
+    ++cache->read_hits;
+if (sectsread)
+    *sectsread = sread;
+return SCPE_OK;
+}
+
+static t_stat _disk_cache_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache = ctx->cache;
+struct disk_cache_line *l;
+t_lba end = lba + sects;
+t_stat r = SCPE_OK;
+
+if (sectswritten)
+    *sectswritten = 0;
+if ((end > cache->total_sects) || (end < lba)) {        /* beyond the end of the unit? */
+    r = _disk_cache_invalidate (uptr, lba, end);
+    if (r != SCPE_OK)
+        return r;
+    return _sim_disk_wrsect_direct (uptr, lba, buf, sectswritten, sects);
+    }
+++cache->writes;
+if (!cache->write_back)
+    r = _sim_disk_wrsect_direct (uptr, lba, buf, sectswritten, sects);
+while (lba < end) {
+    t_lba line = lba / cache->line_sects;
+    uint32 off = lba % cache->line_sects;
+    uint32 cnt = cache->line_sects - off;
+
+    if (cnt > end - lba)
+        cnt = end - lba;
+    l = _disk_cache_find (cache, line);
+    if (!cache->write_back) {                           /* WRITETHROUGH updates cached copies */
+        if (l != NULL) {
+            if (r == SCPE_OK) {
+                memcpy (l->data + off * ctx->sector_size, buf, cnt * ctx->sector_size);
+                if (off + cnt > l->valid)
+                    l->valid = off + cnt;
+                }
+            else
+                _disk_cache_discard (cache, l);
+            }
+        }
+    else {                                              /* WRITEBACK */
+        t_stat lr = SCPE_OK;
+
+        if (l == NULL) {
+            if (cnt == cache->line_sects)               /* whole line needs no read */
+                l = _disk_cache_alloc (uptr, line, &lr);
+            else
+                lr = _disk_cache_load (uptr, line, 1, &l);
+            if (lr != SCPE_OK)
+                return lr;
+            }
+        else
+            _disk_cache_mru (cache, l);
+        memcpy (l->data + off * ctx->sector_size, buf, cnt * ctx->sector_size);
+        if (off + cnt > l->valid)
+            l->valid = off + cnt;
+        if (l->dirty_hi == 0) {
+            l->dirty_lo = off;
+            l->dirty_hi = off + cnt;
+            }
+        else {
+            if (off < l->dirty_lo)
+                l->dirty_lo = off;
+            if (off + cnt > l->dirty_hi)
+                l->dirty_hi = off + cnt;
+            }
+        if (sectswritten)
+            *sectswritten += cnt;
+        }
+    buf += cnt * ctx->sector_size;
+    lba += cnt;
+    }
+return r;
+}
+
+static t_stat _disk_cache_open (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache_setting *setting = _disk_cache_setting (uptr, FALSE);
+struct disk_cache *cache;
+uint32 i, hash_size;
+
+if ((ctx == NULL) || (ctx->cache != NULL) || (ctx->map != NULL) || (setting == NULL) || (setting->size_kb == 0))
+    return SCPE_OK;
+cache = (struct disk_cache *)calloc (1, sizeof (*cache));
+if (cache == NULL)
+    return SCPE_MEM;
+cache->line_sects = (ctx->sector_size >= DK_CACHE_LINE_BYTES) ? 1 : DK_CACHE_LINE_BYTES / ctx->sector_size;
+cache->line_bytes = cache->line_sects * ctx->sector_size;
+cache->nlines = (uint32)((((t_uint64)setting->size_kb) * 1024) / cache->line_bytes);
+if (cache->nlines < 2 * DK_CACHE_READAHEAD)
+    cache->nlines = 2 * DK_CACHE_READAHEAD;
+cache->max_load = cache->nlines / 2;
+for (hash_size = 1; hash_size < cache->nlines; hash_size <<= 1)
+    ;
+cache->hash_mask = hash_size - 1;
+cache->total_sects = (t_lba)((uptr->capac*ctx->capac_factor)/(ctx->sector_size/((ctx->dptr->flags & DEV_SECTORS) ? ((ctx->sector_size >= 512) ? 512 : ctx->sector_size) : 1)));
+cache->write_back = setting->write_back;
+cache->next_lba = (t_lba)-1;
+cache->lines = (struct disk_cache_line *)calloc (cache->nlines, sizeof (*cache->lines));
+cache->hash = (struct disk_cache_line **)calloc (hash_size, sizeof (*cache->hash));
+cache->data = (uint8 *)malloc ((size_t)cache->nlines * cache->line_bytes);
+cache->ldbuf = (uint8 *)malloc ((size_t)cache->max_load * cache->line_bytes);
+if ((cache->lines == NULL) || (cache->hash == NULL) ||
+    (cache->data == NULL) || (cache->ldbuf == NULL)) {
+    free (cache->lines);
+    free (cache->hash);
+    free (cache->data);
+    free (cache->ldbuf);
+    free (cache);
+    return sim_messagef (SCPE_MEM, "%s: Can't allocate %uKB disk cache\n", sim_uname (uptr), setting->size_kb);
+    }
+cache->lru.next = cache->lru.prev = &cache->lru;
+for (i = 0; i < cache->nlines; i++) {
+    struct disk_cache_line *l = &cache->lines[i];
+
+    l->data = cache->data + (size_t)i * cache->line_bytes;
+    l->prev = cache->lru.prev;
+    l->next = &cache->lru;
+    cache->lru.prev->next = l;
+    cache->lru.prev = l;
+    }
+ctx->cache = cache;
+sim_debug_unit (ctx->dbit, uptr, "_disk_cache_open(unit=%d, lines=%u, sectors/line=%u, %s)\n", (int)(uptr - ctx->dptr->units), cache->nlines, cache->line_sects, cache->write_back ? "writeback" : "writethrough");
+return SCPE_OK;
+}
+
+static t_stat _disk_cache_close (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache *cache;
+t_stat r;
+
+if ((ctx == NULL) || ((cache = ctx->cache) == NULL))
+    return SCPE_OK;
+r = _disk_cache_flush (uptr);
+sim_debug_unit (ctx->dbit, uptr, "_disk_cache_close(unit=%d) - %s\n", (int)(uptr - ctx->dptr->units), sim_error_text (r));
+ctx->cache = NULL;
+free (cache->lines);
+free (cache->hash);
+free (cache->data);
+free (cache->ldbuf);
+free (cache);
+return r;
+}
+
+/* Configure the sector cache
+
+   val selects the setting:
+        DK_CACHE_SET_SIZE       CACHE{=size{K|M}}
+        DK_CACHE_SET_NONE       NOCACHE
+        DK_CACHE_SET_WRITEBACK  WRITEBACK
+        DK_CACHE_SET_WRITETHRU  WRITETHROUGH
+        DK_CACHE_SET_MMAP       MMAP
+        DK_CACHE_SET_NOMMAP     NOMMAP
+
+   Changes to an attached unit take effect immediately (the current cache
+   contents are flushed and discarded).
+*/
+
+t_stat sim_disk_set_cache (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+DEVICE *dptr;
+struct disk_cache_setting *setting;
+uint32 size_kb = DK_CACHE_DEFAULT_KB;
+t_stat r;
+#if defined (SIM_ASYNCH_IO)
+struct disk_context *ctx;
+int asynch_io;
+#endif
+
+if (uptr == NULL)
+    return SCPE_IERR;
+dptr = find_dev_from_unit (uptr);
+if ((dptr == NULL) || (DEV_TYPE (dptr) != DEV_DISK))
+    return sim_messagef (SCPE_NOFNC, "%s is not a disk unit\n", sim_uname (uptr));
+if ((val == DK_CACHE_SET_SIZE) && (cptr != NULL) && (*cptr != '\0')) {
+    char *eptr;
+    unsigned long size = strtoul (cptr, &eptr, 10);
+
+    if (eptr == cptr)
+        return sim_messagef (SCPE_ARG, "Invalid cache size: %s\n", cptr);
+    if ((*eptr == 'M') || (*eptr == 'm')) {
+        size *= 1024;
+        ++eptr;
+        }
+    else
+        if ((*eptr == 'K') || (*eptr == 'k'))
+            ++eptr;
+    if ((*eptr == 'B') || (*eptr == 'b'))
+        ++eptr;
+    if ((*eptr != '\0') || (size == 0) || (size > 0x3FFFFF))
+        return sim_messagef (SCPE_ARG, "Invalid cache size: %s\n", cptr);
+    size_kb = (uint32)size;
+    }
+else
+    if ((val != DK_CACHE_SET_SIZE) && (cptr != NULL))
+        return SCPE_ARG;
+setting = _disk_cache_setting (uptr, TRUE);
+if (setting == NULL)
+    return SCPE_MEM;
+switch (val) {
+    case DK_CACHE_SET_SIZE:
+        setting->size_kb = size_kb;
+        break;
+    case DK_CACHE_SET_NONE:
+        setting->size_kb = 0;
+        break;
+    case DK_CACHE_SET_WRITEBACK:
+    case DK_CACHE_SET_WRITETHRU:
+        setting->write_back = (val == DK_CACHE_SET_WRITEBACK);
+        if (setting->size_kb == 0)
+            setting->size_kb = DK_CACHE_DEFAULT_KB;
+        break;
+    case DK_CACHE_SET_MMAP:
+    case DK_CACHE_SET_NOMMAP:
+        setting->mmap = (val == DK_CACHE_SET_MMAP);
+        break;
+    default:
+        return SCPE_IERR;
+    }
+if (!(uptr->flags & UNIT_ATT))
+    return SCPE_OK;
+#if defined (SIM_ASYNCH_IO)
+ctx = (struct disk_context *)uptr->disk_ctx;
+asynch_io = ctx->asynch_io;
+if (asynch_io)                                          /* quiesce the I/O thread */
+    sim_disk_clr_async (uptr);                          /* while the cache and map change */
+#endif
+r = _disk_cache_close (uptr);
+if (r == SCPE_OK) {
+    if (setting->mmap)
+        _sim_disk_map (uptr);
+    else
+        _sim_disk_unmap (uptr);
+    r = _disk_cache_open (uptr);
+    }
+else
+    r = sim_messagef (r, "%s: Error flushing disk cache: %s\n", sim_uname (uptr), sim_error_text (r));
+#if defined (SIM_ASYNCH_IO)
+if (asynch_io)
+    sim_disk_set_async (uptr, ctx->asynch_io_latency);
+#endif
+return r;
+}
+
+t_stat sim_disk_show_cache (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache_setting *setting = _disk_cache_setting (uptr, FALSE);
+struct disk_cache *cache = ctx ? ctx->cache : NULL;
+
+if ((ctx != NULL) && (ctx->map != NULL)) {
+    fprintf (st, "memory mapped (%s bytes)", sim_fmt_numeric ((double)ctx->map_size));
+    return SCPE_OK;
+    }
+if ((setting == NULL) || (setting->size_kb == 0)) {
+    fprintf (st, "no cache");
+    if ((setting != NULL) && setting->mmap)
+        fprintf (st, ", mmap requested");
+    return SCPE_OK;
+    }
+fprintf (st, "%uKB %s cache", setting->size_kb, setting->write_back ? "writeback" : "writethrough");
+if (cache != NULL) {
+    uint32 i, dirty = 0;
+
+    for (i = 0; i < cache->nlines; i++)
+        if (cache->lines[i].inuse && cache->lines[i].dirty_hi)
+            ++dirty;
+    fprintf (st, ", %u lines of %u bytes, %u dirty\n", cache->nlines, cache->line_bytes, dirty);
+    fprintf (st, "\treads: %" LL_FMT "u (%" LL_FMT "u hits), writes: %" LL_FMT "u\n", cache->reads, cache->read_hits, cache->writes);
+    fprintf (st, "\tlines loaded: %" LL_FMT "u (%" LL_FMT "u read ahead), lines written back: %" LL_FMT "u", cache->loads, cache->readaheads, cache->writebacks);
+    }
+return SCPE_OK;
+}
+
+/* Memory Mapped Access
+
+   SIMH and RAW format containers held in regular files, and fixed size
+   VHD containers, can be accessed through a shared mapping of the
+   container's data rather than a seek and a system call per request:
+
+        SET <unit> MMAP         map the container data when attached
+        SET <unit> NOMMAP       use file I/O (default)
+
+   A mapped read is a copy out of the mapping and a write a copy into it,
+   with any xfer_element_size swapping done along the way.  Modified pages
+   are scheduled for writing (msync MS_ASYNC) when the simulator stops and
+   written synchronously when the unit is detached.  A mapped unit doesn't
+   use the sector cache.  Requests beyond the mapped data (a container
+   smaller than the unit) use file I/O.
+*/
+
+static void _sim_disk_map (UNIT *uptr)
+{
+#if defined (DK_USE_MMAP)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache_setting *setting = _disk_cache_setting (uptr, FALSE);
+struct stat statb;
+t_offset data_size, unit_size;
+void *map;
+int fd = -1;
+
+if ((ctx == NULL) || (ctx->map != NULL) || (setting == NULL) || (!setting->mmap))
+    return;
+switch (DK_GET_FMT (uptr)) {
+    case DKUF_F_STD:                                    /* SIMH format */
+        fflush (uptr->fileref);
+        fd = fileno (uptr->fileref);
+        break;
+    case DKUF_F_VHD:                                    /* VHD format */
+        fd = sim_vhd_disk_fixed_fd (uptr->fileref);
+        break;
+    case DKUF_F_RAW:                                    /* Raw Physical Disk Access */
+        fd = (int)((long)uptr->fileref);
+        break;
+    }
+if ((fd < 0) || fstat (fd, &statb) || !S_ISREG (statb.st_mode)) {
+    sim_debug_unit (ctx->dbit, uptr, "_sim_disk_map(unit=%d) - container can't be mapped\n", (int)(uptr - ctx->dptr->units));
+    return;
+    }
+data_size = (t_offset)statb.st_size;
+if (DK_GET_FMT (uptr) == DKUF_F_VHD)
+    data_size = sim_vhd_disk_size (uptr->fileref);
+else
+    if ((ctx->footer != NULL) && (data_size >= (t_offset)sizeof (*ctx->footer)))
+        data_size -= sizeof (*ctx->footer);
+unit_size = ((t_offset)uptr->capac) * ctx->capac_factor * ((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1);
+if (data_size > unit_size)
+    data_size = unit_size;
+data_size -= data_size % ctx->sector_size;
+if ((data_size <= 0) || ((t_offset)((size_t)data_size) != data_size))
+    return;
+map = mmap (NULL, (size_t)data_size, PROT_READ | ((uptr->flags & UNIT_RO) ? 0 : PROT_WRITE), MAP_SHARED, fd, 0);
+if (map == MAP_FAILED) {
+    sim_debug_unit (ctx->dbit, uptr, "_sim_disk_map(unit=%d) - mmap failed: %s\n", (int)(uptr - ctx->dptr->units), strerror (errno));
+    return;
+    }
+ctx->map = (uint8 *)map;
+ctx->map_size = data_size;
+sim_debug_unit (ctx->dbit, uptr, "_sim_disk_map(unit=%d) - %s bytes mapped\n", (int)(uptr - ctx->dptr->units), sim_fmt_numeric ((double)data_size));
+#endif
+}
+
+static void _sim_disk_map_flush (UNIT *uptr, t_bool wait)
+{
+#if defined (DK_USE_MMAP)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if ((ctx != NULL) && (ctx->map != NULL) && !(uptr->flags & UNIT_RO))
+    msync (ctx->map, (size_t)ctx->map_size, wait ? MS_SYNC : MS_ASYNC);
+#endif
+}
+
+static void _sim_disk_unmap (UNIT *uptr)
+{
+#if defined (DK_USE_MMAP)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if ((ctx == NULL) || (ctx->map == NULL))
+    return;
+_sim_disk_map_flush (uptr, TRUE);
+munmap (ctx->map, (size_t)ctx->map_size);
+ctx->map = NULL;
+ctx->map_size = 0;
+#endif
+}
+
 t_stat sim_disk_unload (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
@@ -880,6 +1832,8 @@ sim_disk_clr_async (uptr);
 if (sim_asynch_enabled)
     sim_disk_set_async (uptr, ctx->asynch_io_latency);
 #endif
+_disk_cache_flush (uptr);
+_sim_disk_map_flush (uptr, FALSE);
 switch (f) {                                            /* case on format */
     case DKUF_F_STD:                                    /* Simh */
         fflush (uptr->fileref);
@@ -2785,6 +3739,8 @@ if (container_size && (container_size != (t_offset)-1)) {
 if (dtype && (created || (ctx->footer == NULL)))
     store_disk_footer (uptr, dtype);
 
+_sim_disk_map (uptr);
+_disk_cache_open (uptr);
 #if defined (SIM_ASYNCH_IO)
 sim_disk_set_async (uptr, completion_delay);
 #endif
@@ -2835,6 +3791,8 @@ if (uptr->io_flush)
     uptr->io_flush (uptr);                              /* flush buffered data */
 
 sim_disk_clr_async (uptr);
+_disk_cache_close (uptr);
+_sim_disk_unmap (uptr);
 
 uptr->flags &= ~(UNIT_ATT | UNIT_RO);
 uptr->dynflags &= ~(UNIT_NO_FIO | UNIT_DISK_CHK);
@@ -4071,6 +5029,11 @@ static void sim_vhd_disk_flush (FILE *f)
 {
 }
 
+static int sim_vhd_disk_fixed_fd (FILE *f)
+{
+return -1;
+}
+
 static t_offset sim_vhd_disk_size (FILE *f)
 {
 return (t_offset)-1;
@@ -4724,6 +5687,7 @@ struct VHD_IOData {
     FILE *File;
     char ParentVHDPath[512];
     struct VHD_IOData *Parent;
+    struct VHD_IOData **BlockOwner;     /* Differencing chain level holding each block (NULL: zeros) */
     };
 
 static t_stat sim_vhd_disk_implemented (void)
@@ -4803,6 +5767,65 @@ if (creation_time)
 return (char *)(&hVHD->Footer.DriveType[0]);
 }
 
+/* Differencing disk chains (base <- ... <- child) are flattened when the
+   child is opened.  BlockOwner[n] records which level of the chain holds
+   block n (the first level, walking towards the base, whose BAT has an
+   entry for it), or NULL when no level has it and it reads as zeros.  A
+   read then goes straight to the owning file without visiting each
+   intermediate level.  The map is maintained as the child allocates
+   blocks.  Chains whose levels have different block sizes, or which
+   don't cover the whole child, aren't mapped and are read level by
+   level. */
+
+static void
+BuildVHDBlockOwnerMap (VHDHANDLE hVHD)
+{
+uint32 BlockSize = NtoHl (hVHD->Dynamic.BlockSize);
+uint32 Blocks = NtoHl (hVHD->Dynamic.MaxTableEntries);
+uint32 BlockNumber;
+VHDHANDLE Level;
+
+if (((uint64)Blocks * BlockSize) < NtoHll (hVHD->Footer.CurrentSize))
+    return;
+for (Level = hVHD->Parent; Level != NULL; Level = Level->Parent) {
+    if (NtoHl (Level->Footer.DiskType) == VHD_DT_Fixed) {
+        if (((uint64)Blocks * BlockSize) > NtoHll (Level->Footer.CurrentSize))
+            return;
+        }
+    else {
+        if ((NtoHl (Level->Dynamic.BlockSize) != BlockSize) ||
+            (NtoHl (Level->Dynamic.MaxTableEntries) < Blocks))
+            return;
+        }
+    }
+hVHD->BlockOwner = (VHDHANDLE *)calloc (Blocks, sizeof (*hVHD->BlockOwner));
+if (hVHD->BlockOwner == NULL)
+    return;
+for (BlockNumber = 0; BlockNumber < Blocks; ++BlockNumber) {
+    for (Level = hVHD; Level != NULL; Level = Level->Parent) {
+        if ((NtoHl (Level->Footer.DiskType) == VHD_DT_Fixed) ||
+            (Level->BAT[BlockNumber] != VHD_BAT_FREE_ENTRY)) {
+            hVHD->BlockOwner[BlockNumber] = Level;
+            break;
+            }
+        }
+    }
+}
+
+/* File offset of the data of a block held by a chain level */
+
+static uint64
+VHDBlockPosition (VHDHANDLE Level, uint32 BlockNumber, uint32 BlockSize)
+{
+uint32 BitMapBytes, BitMapSectors;
+
+if (NtoHl (Level->Footer.DiskType) == VHD_DT_Fixed)
+    return (uint64)BlockNumber * BlockSize;
+BitMapBytes = (7+(BlockSize/VHD_Internal_SectorSize))/8;
+BitMapSectors = (BitMapBytes+VHD_Internal_SectorSize-1)/VHD_Internal_SectorSize;
+return VHD_Internal_SectorSize * ((uint64)(NtoHl (Level->BAT[BlockNumber]) + BitMapSectors));
+}
+
 static FILE *sim_vhd_disk_open (const char *szVHDPath, const char *DesiredAccess)
     {
     VHDHANDLE hVHD = (VHDHANDLE) calloc (1, sizeof(*hVHD));
@@ -4866,6 +5889,8 @@ static FILE *sim_vhd_disk_open (const char *szVHDPath, const char *DesiredAccess
         Status = errno;
         goto Cleanup_Return;
         }
+    if (hVHD->Parent)
+        BuildVHDBlockOwnerMap (hVHD);
 Cleanup_Return:
     if (Status) {
         sim_vhd_disk_close ((FILE *)hVHD);
@@ -5014,6 +6039,7 @@ if (NULL != hVHD) {
     if (hVHD->Parent)
         sim_vhd_disk_close ((FILE *)hVHD->Parent);
     free (hVHD->BAT);
+    free (hVHD->BlockOwner);
     if (hVHD->File) {
         fflush (hVHD->File);
         fclose (hVHD->File);
@@ -5032,6 +6058,20 @@ if ((NULL != hVHD) && (hVHD->File))
     fflush (hVHD->File);
 }
 
+/* File descriptor of a fixed VHD (whose data starts at file offset 0),
+   -1 for dynamic and differencing disks */
+
+static int sim_vhd_disk_fixed_fd (FILE *f)
+{
+VHDHANDLE hVHD = (VHDHANDLE)f;
+
+if ((NULL == hVHD) || (NULL == hVHD->File) ||
+    (NtoHl (hVHD->Footer.DiskType) != VHD_DT_Fixed))
+    return -1;
+fflush (hVHD->File);
+return fileno (hVHD->File);
+}
+
 static t_offset sim_vhd_disk_size (FILE *f)
 {
 VHDHANDLE hVHD = (VHDHANDLE)f;
@@ -5586,6 +6626,50 @@ if (NtoHl (hVHD->Footer.DiskType) == VHD_DT_Fixed) {
         r = SCPE_IOERR;
     return r;
     }
+if (hVHD->BlockOwner) {                     /* Flattened differencing chain */
+    uint32 BlockSize = NtoHl (hVHD->Dynamic.BlockSize);
+
+    while (BytesToRead && (r == SCPE_OK)) {
+        uint32 BlockNumber = (uint32)(Offset / BlockSize);
+        VHDHANDLE Owner = hVHD->BlockOwner[BlockNumber];
+        uint64 Position = 0;
+        uint32 BytesInRead = (uint32)(((uint64)(BlockNumber + 1) * BlockSize) - Offset);
+        uint32 BytesThisRead = 0;
+
+        if (BytesInRead > BytesToRead)
+            BytesInRead = BytesToRead;
+        if (Owner)
+            Position = VHDBlockPosition (Owner, BlockNumber, BlockSize) + (Offset % BlockSize);
+        /* Coalesce following blocks which continue the same run */
+        while ((BytesInRead < BytesToRead) &&
+               (++BlockNumber < NtoHl (hVHD->Dynamic.MaxTableEntries)) &&
+               (hVHD->BlockOwner[BlockNumber] == Owner) &&
+               ((Owner == NULL) ||
+                (VHDBlockPosition (Owner, BlockNumber, BlockSize) == Position + BytesInRead)))
+            BytesInRead += ((BytesToRead - BytesInRead) < BlockSize) ? (BytesToRead - BytesInRead) : BlockSize;
+        if (Owner == NULL) {
+            memset (buf, 0, BytesInRead);
+            BytesThisRead = BytesInRead;
+            }
+        else {
+            if (ReadFilePosition(Owner->File,
+                                 buf,
+                                 BytesInRead,
+                                 &BytesThisRead,
+                                 Position))
+                r = SCPE_IOERR;
+            }
+        if (BytesThisRead == 0)
+            break;
+        BytesToRead -= BytesThisRead;
+        buf = (uint8 *)(((char *)buf) + BytesThisRead);
+        Offset += BytesThisRead;
+        TotalBytesRead += BytesThisRead;
+        }
+    if (BytesRead)
+        *BytesRead = TotalBytesRead;
+    return SCPE_OK;
+    }
 /* We are now dealing with a Dynamically expanding or differencing disk */
 BitMapBytes = (7+(NtoHl (hVHD->Dynamic.BlockSize)/VHD_Internal_SectorSize))/8;
 BitMapSectors = (BitMapBytes+VHD_Internal_SectorSize-1)/VHD_Internal_SectorSize;
@@ -5786,6 +6870,8 @@ while (BytesToWrite && (r == SCPE_OK)) {
         /* the BAT block address is the beginning of the block bitmap */
         BlockOffset -= BitMapSectors * VHD_Internal_SectorSize;
         hVHD->BAT[BlockNumber] = NtoHl((uint32)(BlockOffset / VHD_Internal_SectorSize));
+        if (hVHD->BlockOwner)
+            hVHD->BlockOwner[BlockNumber] = hVHD;
         BlockOffset += (BitMapSectors * VHD_Internal_SectorSize) + NtoHl(hVHD->Dynamic.BlockSize);
         if (WriteFilePosition(hVHD->File,
                               &hVHD->Footer,
@@ -6153,6 +7239,10 @@ t_stat sim_disk_test (DEVICE *dptr)
 const char *fmt[] = {"RAW", "VHD", "VHD", "SIMH", NULL};
 uint32 sect_size[] = {576, 4096, 1024, 512, 256, 128, 64, 0};
 uint32 xfr_size[] = {1, 2, 4, 8, 0};
+const char *cache_fmt[] = {"SIMH", "SIMH", "VHD", "VHD", NULL};
+int32 cache_mode[] = {DK_CACHE_SET_WRITETHRU, DK_CACHE_SET_WRITEBACK, DK_CACHE_SET_WRITEBACK, DK_CACHE_SET_MMAP};
+const char *cache_mode_name[] = {"WRITETHROUGH", "WRITEBACK", "WRITEBACK", "MMAP"};
+uint32 cache_sect_size[] = {576, 576, 512, 512};
 int x, s, f;
 UNIT *uptr = &dptr->units[0];
 char filename[256];
@@ -6189,5 +7279,25 @@ for (x = 0; xfr_size[x] != 0; x++) {
             }
         }
     }
+sim_switches = saved_switches;
+for (f = 0; cache_fmt[f] != NULL; f++) {                /* exercise the sector cache */
+    snprintf (filename, sizeof (filename) - 1, "Test-%u-Cache-%s.%s", cache_sect_size[f], cache_mode_name[f], cache_fmt[f]);
+    (void)remove (filename);        /* Remove any prior remnants */
+    r = sim_disk_set_fmt (uptr, 0, cache_fmt[f], NULL);
+    if (r != SCPE_OK)
+        break;
+    SIM_TEST(sim_disk_set_cache (uptr, DK_CACHE_SET_SIZE, "64K", NULL));
+    SIM_TEST(sim_disk_set_cache (uptr, cache_mode[f], NULL, NULL));
+    if (cache_mode[f] == DK_CACHE_SET_MMAP)     /* Mapping needs a Fixed VHD */
+        sim_switches |= SWMASK('X');
+    sim_printf ("Testing %s (%s) with %s cache using %s\n", sim_uname (uptr), sprint_capac (dptr, uptr), cache_mode_name[f], filename);
+    r = sim_disk_attach_ex (uptr, filename, cache_sect_size[f], 2, TRUE, 0, NULL, 0, 0, NULL);
+    sim_switches = saved_switches;
+    if (r != SCPE_OK)
+        break;
+    SIM_TEST(sim_disk_test_exercise (uptr));
+    }
+sim_disk_set_cache (uptr, DK_CACHE_SET_NONE, NULL, NULL);
+sim_disk_set_cache (uptr, DK_CACHE_SET_NOMMAP, NULL, NULL);
 return SCPE_OK;
 }
@@ -64,6 +64,15 @@ typedef uint32          t_lba;                          /* disk logical block ad
 
 #define DKSE_OK         0                               /* no error */
 
+/* Sector cache settings (sim_disk_set_cache val) */
+
+#define DK_CACHE_SET_SIZE       0                       /* CACHE{=size} */
+#define DK_CACHE_SET_NONE       1                       /* NOCACHE */
+#define DK_CACHE_SET_WRITEBACK  2                       /* WRITEBACK */
+#define DK_CACHE_SET_WRITETHRU  3                       /* WRITETHROUGH */
+#define DK_CACHE_SET_MMAP       4                       /* MMAP */
+#define DK_CACHE_SET_NOMMAP     5                       /* NOMMAP */
+
 typedef void (*DISK_PCALLBACK)(UNIT *unit, t_stat status);
 
 /* Prototypes */
@@ -100,6 +109,8 @@ t_stat sim_disk_set_capac (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_disk_show_capac (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat sim_disk_set_asynch (UNIT *uptr, int latency);
 t_stat sim_disk_clr_asynch (UNIT *uptr);
+t_stat sim_disk_set_cache (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat sim_disk_show_cache (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat sim_disk_reset (UNIT *uptr);
 t_stat sim_disk_perror (UNIT *uptr, const char *msg);
 t_stat sim_disk_clearerr (UNIT *uptr);
@@ -112,6 +123,7 @@ t_bool sim_disk_vhd_support (void);
 t_bool sim_disk_raw_support (void);
 void sim_disk_data_trace (UNIT *uptr, const uint8 *data, size_t lba, size_t len, const char* txt, int detail, uint32 reason);
 t_stat sim_disk_info_cmd (int32 flag, CONST char *ptr);
+void sim_disk_data_totals (t_uint64 *bytes_read, t_uint64 *bytes_written);
 t_stat sim_disk_test (DEVICE *dptr);
 
 #ifdef  __cplusplus
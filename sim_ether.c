@@ -157,6 +157,12 @@
   HAVE_SLIRP_NETWORK- Specifies that support for SLiRP networking should be 
                       included.  This can be leveraged to provide User Mode 
                       IP NAT connectivity for simulators.
+  HAVE_AFPACKET_NETWORK
+                    - Specifies that support for Linux AF_PACKET sockets with 
+                      memory mapped TPACKET_V3 rings should be included.  
+                      This allows device names of the form afpacket:eth0 to 
+                      be specified at open time, giving direct access to a 
+                      host LAN interface without libpcap.
 
   NEED_PCAP_SENDPACKET
                     - Specifies that you are using an older version of libpcap
@@ -819,6 +825,62 @@ t_stat eth_show_devices (FILE* st, DEVICE *dptr, UNIT* uptr, int32 val, CONST ch
 return eth_show (st, uptr, val, NULL);
 }
 
+/* Fixed size buffer pools.  All buffers are allocated up front, so getting 
+   and returning one never touches the heap.  Callers provide any locking. */
+
+t_stat ethp_init(ETH_POOL* pool, size_t size, int max)
+{
+  int i;
+
+  memset(pool, 0, sizeof(*pool));
+  if (max > 0) {
+    pool->slab = (uint8 *) calloc(max, size);
+    pool->free = (void **) calloc(max, sizeof(*pool->free));
+    if (!pool->slab || !pool->free) {
+      sim_printf("EthP: failed to allocate buffer pool[%d]\n", max);
+      ethp_destroy(pool);
+      return SCPE_MEM;
+    };
+  };
+  pool->size = size;
+  pool->max = max;
+  /* stack the buffers so the lowest addressed one is handed out first */
+  for (i=0; i<max; ++i)
+    pool->free[i] = pool->slab + (max - 1 - i) * size;
+  pool->avail = max;
+  pool->fresh = max;
+  return SCPE_OK;
+}
+
+void ethp_destroy(ETH_POOL* pool)
+{
+  free(pool->slab);
+  free(pool->free);
+  memset(pool, 0, sizeof(*pool));
+}
+
+void *ethp_get(ETH_POOL* pool)
+{
+  if (pool->avail == 0) {
+    ++pool->empty;
+    return NULL;
+  };
+  ++pool->gets;
+  if (pool->max - (pool->avail - 1) > pool->high)
+    pool->high = pool->max - (pool->avail - 1);
+  /* returned buffers are pushed above the untouched ones */
+  if (pool->avail == pool->fresh)
+    --pool->fresh;
+  else
+    ++pool->reuses;
+  return pool->free[--pool->avail];
+}
+
+void ethp_put(ETH_POOL* pool, void *buf)
+{
+  pool->free[pool->avail++] = buf;
+}
+
 t_stat ethq_init(ETH_QUE* que, int max)
 {
   /* create dynamic queue if it does not exist */
@@ -830,6 +892,11 @@ t_stat ethq_init(ETH_QUE* que, int max)
       return SCPE_MEM;
     };
     que->max = max;
+    if (ethp_init(&que->oversize, ETH_MAX_JUMBO_FRAME + ETH_CRC_SIZE, ETH_QUE_OVERSIZE_MAX) != SCPE_OK) {
+      free(que->item);
+      que->item = NULL;
+      return SCPE_MEM;
+    };
   };
   ethq_clear(que);
   return SCPE_OK;
@@ -844,6 +911,7 @@ t_stat ethq_destroy(ETH_QUE* que)
     free(que->item);
     que->item = NULL;
   };
+  ethp_destroy(&que->oversize);
   return SCPE_OK;
 }
 
@@ -851,10 +919,10 @@ void ethq_clear(ETH_QUE* que)
 {
   int i;
 
-  /* free up any extended packets */
+  /* return any extended packet buffers */
   for (i=0; i<que->max; ++i)
     if (que->item[i].packet.oversize) {
-      free (que->item[i].packet.oversize);
+      ethp_put (&que->oversize, que->item[i].packet.oversize);
       que->item[i].packet.oversize = NULL;
       }
   /* clear packet array */
@@ -869,7 +937,7 @@ void ethq_remove(ETH_QUE* que)
 
   if (que->count) {
     if (item->packet.oversize)
-      free (item->packet.oversize);
+      ethp_put (&que->oversize, item->packet.oversize);
     memset(item, 0, sizeof(struct eth_item));
     if (++que->head == que->max)
       que->head = 0;
@@ -880,6 +948,20 @@ void ethq_remove(ETH_QUE* que)
 void ethq_insert_data(ETH_QUE* que, int32 type, const uint8 *data, int used, size_t len, size_t crc_len, const uint8 *crc_data, int32 status)
 {
   struct eth_item* item;
+  size_t size = MAX (len, crc_len);
+
+  /* an oversized frame needs a pool buffer, unless it will reuse the one */
+  /* held by the oldest entry it is about to displace from a full queue */
+  if (size > sizeof (item->packet.msg)) {
+    item = &que->item[(que->count ? que->tail + 1 : 0) % que->max];
+    if ((size > que->oversize.size) ||
+        (!((que->count == que->max) && item->packet.oversize) && !que->oversize.avail)) {
+      if (size <= que->oversize.size)
+        ++que->oversize.empty;
+      que->loss++;
+      return;
+      }
+    }
 
   /* if queue empty, set pointers to beginning */
   if (!que->count) {
@@ -906,13 +988,18 @@ void ethq_insert_data(ETH_QUE* que, int32 type, const uint8 *data, int used, siz
   item->packet.len = len;
   item->packet.used = used;
   item->packet.crc_len = crc_len;
-  if (MAX (len, crc_len) <= sizeof (item->packet.msg)) {
+  if (size <= sizeof (item->packet.msg)) {
+    if (item->packet.oversize) {
+      ethp_put (&que->oversize, item->packet.oversize);
+      item->packet.oversize = NULL;
+      }
     memcpy(item->packet.msg, data, ((len > crc_len) ? len : crc_len));
     if (crc_data && (crc_len > len))
       memcpy(&item->packet.msg[len], crc_data, ETH_CRC_SIZE);
     }
   else {
-    item->packet.oversize = (uint8 *)realloc (item->packet.oversize, ((len > crc_len) ? len : crc_len));
+    if (!item->packet.oversize)
+      item->packet.oversize = (uint8 *)ethp_get (&que->oversize);
     memcpy(item->packet.oversize, data, ((len > crc_len) ? len : crc_len));
     if (crc_data && (crc_len > len))
       memcpy(&item->packet.oversize[len], crc_data, ETH_CRC_SIZE);
@@ -925,6 +1012,23 @@ void ethq_insert(ETH_QUE* que, int32 type, ETH_PACK* pack, int32 status)
 ethq_insert_data(que, type, pack->oversize ? pack->oversize : pack->msg, pack->used, pack->len, pack->crc_len, NULL, status);
 }
 
+/* Packet totals across all Ethernet devices (reported by BENCHMARK).
+   These are only updated by eth_read and eth_write, which are called
+   from the simulator thread. */
+
+static t_uint64 eth_packets_read = 0;
+static t_uint64 eth_bytes_read = 0;
+static t_uint64 eth_packets_written = 0;
+static t_uint64 eth_bytes_written = 0;
+
+void eth_data_totals (t_uint64 *packets_read, t_uint64 *bytes_read, t_uint64 *packets_written, t_uint64 *bytes_written)
+{
+*packets_read = eth_packets_read;
+*bytes_read = eth_bytes_read;
+*packets_written = eth_packets_written;
+*bytes_written = eth_bytes_written;
+}
+
 /*============================================================================*/
 /*                        Non-implemented versions                            */
 /*============================================================================*/
@@ -992,6 +1096,9 @@ const char *eth_capabilities(void)
 #endif
 #if defined (HAVE_SLIRP_NETWORK)
      ":NAT"
+#endif
+#if defined (HAVE_AFPACKET_NETWORK)
+     ":AF_PACKET"
 #endif
      ":UDP";
  }
@@ -1033,6 +1140,19 @@ typedef void * pcap_t;  /* Pseudo Type to avoid compiler errors */
 #endif
 #endif /* HAVE_TAP_NETWORK */
 
+#ifdef HAVE_AFPACKET_NETWORK
+#if defined(__linux) || defined(__linux__)
+#include <sys/mman.h>
+#include <poll.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/filter.h>
+#else /* AF_PACKET rings are Linux specific */
+#undef HAVE_AFPACKET_NETWORK
+#endif
+#endif /* HAVE_AFPACKET_NETWORK */
+
 #ifdef HAVE_VDE_NETWORK
 #ifdef  __cplusplus
 extern "C" {
@@ -1716,6 +1836,242 @@ _eth_callback((u_char *)opaque, &header, buf);
 }
 #endif
 
+#if defined (HAVE_AFPACKET_NETWORK)
+/*============================================================================*/
+/*  Linux AF_PACKET routines using memory mapped TPACKET_V3 RX and TX rings   */
+/*                                                                            */
+/*  Received frames are handed to _eth_callback() directly from the ring      */
+/*  block they were captured into, so the only copy made is the one into      */
+/*  the read queue.  A kernel socket filter built from the current filter     */
+/*  state keeps unwanted traffic out of the ring.                             */
+/*============================================================================*/
+
+#define AFPACKET_BLOCK_SIZE  (1 << 17)  /* ring block size */
+#define AFPACKET_RX_BLOCKS   32         /* receive ring blocks */
+#define AFPACKET_FRAME_SIZE  2048       /* receive ring frame size */
+#define AFPACKET_TX_BLOCK_SIZE (1 << 18)/* transmit ring block size */
+#define AFPACKET_TX_BLOCKS   4          /* transmit ring blocks */
+#define AFPACKET_TX_FRAME_SIZE (1 << 17)/* transmit slot (holds ETH_MAX_JUMBO_FRAME) */
+#define AFPACKET_TX_WAIT     100        /* ms to wait for a busy transmit slot */
+#define AFPACKET_BLOCK_TMO   2          /* ms before a partial RX block is retired */
+
+typedef struct {
+  uint8                 *map;           /* RX ring followed by TX ring */
+  size_t                map_size;
+  size_t                rx_size;
+  struct tpacket_req3   rx_req;
+  struct tpacket_req3   tx_req;         /* tp_frame_nr == 0 if no TX ring */
+  uint32                rx_block;       /* next RX block to examine */
+  uint32                rx_pkt;         /* packets consumed from the current block */
+  uint32                rx_offset;      /* offset of the next packet in that block */
+  uint32                tx_frame;       /* next TX frame slot */
+  } AFPACKET_RING;
+
+static AFPACKET_RING *_eth_afpacket_open (const char *ifname, SOCKET *fd_handle, char *errbuf)
+{
+AFPACKET_RING *ring;
+struct sockaddr_ll sll;
+struct packet_mreq mreq;
+int version = TPACKET_V3;
+int one = 1;
+int ifindex;
+int fd;
+
+if (0 == (ifindex = if_nametoindex (ifname))) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "Unknown interface: %s", ifname);
+  return NULL;
+  }
+if ((fd = socket (AF_PACKET, SOCK_RAW, htons (ETH_P_ALL))) < 0) {
+  strlcpy (errbuf, strerror (errno), PCAP_ERRBUF_SIZE);
+  return NULL;
+  }
+ring = (AFPACKET_RING *)calloc (1, sizeof (*ring));
+if (setsockopt (fd, SOL_PACKET, PACKET_VERSION, &version, sizeof (version)) < 0)
+  goto Error;
+ring->rx_req.tp_block_size = AFPACKET_BLOCK_SIZE;
+ring->rx_req.tp_block_nr = AFPACKET_RX_BLOCKS;
+ring->rx_req.tp_frame_size = AFPACKET_FRAME_SIZE;
+ring->rx_req.tp_frame_nr = (AFPACKET_BLOCK_SIZE / AFPACKET_FRAME_SIZE) * AFPACKET_RX_BLOCKS;
+ring->rx_req.tp_retire_blk_tov = AFPACKET_BLOCK_TMO;
+if (setsockopt (fd, SOL_PACKET, PACKET_RX_RING, &ring->rx_req, sizeof (ring->rx_req)) < 0)
+  goto Error;
+ring->rx_size = (size_t)AFPACKET_BLOCK_SIZE * AFPACKET_RX_BLOCKS;
+/* A TPACKET_V3 transmit ring needs Linux 4.11 or later.  Without one, 
+   frames are simply written with send() */
+ring->tx_req.tp_block_size = AFPACKET_TX_BLOCK_SIZE;
+ring->tx_req.tp_block_nr = AFPACKET_TX_BLOCKS;
+ring->tx_req.tp_frame_size = AFPACKET_TX_FRAME_SIZE;
+ring->tx_req.tp_frame_nr = (AFPACKET_TX_BLOCK_SIZE / AFPACKET_TX_FRAME_SIZE) * AFPACKET_TX_BLOCKS;
+/* PACKET_LOSS lets the kernel skip a malformed TX frame rather than stall on it */
+if ((setsockopt (fd, SOL_PACKET, PACKET_LOSS, &one, sizeof (one)) < 0) ||
+    (setsockopt (fd, SOL_PACKET, PACKET_TX_RING, &ring->tx_req, sizeof (ring->tx_req)) < 0))
+  memset (&ring->tx_req, 0, sizeof (ring->tx_req));
+ring->map_size = ring->rx_size + (size_t)ring->tx_req.tp_block_size * ring->tx_req.tp_block_nr;
+ring->map = (uint8 *)mmap (NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+if (ring->map == MAP_FAILED) {
+  ring->map = NULL;
+  goto Error;
+  }
+memset (&sll, 0, sizeof (sll));
+sll.sll_family = AF_PACKET;
+sll.sll_protocol = htons (ETH_P_ALL);
+sll.sll_ifindex = ifindex;
+if (bind (fd, (struct sockaddr *)&sll, sizeof (sll)) < 0)
+  goto Error;
+memset (&mreq, 0, sizeof (mreq));
+mreq.mr_ifindex = ifindex;
+mreq.mr_type = PACKET_MR_PROMISC;
+if (setsockopt (fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof (mreq)) < 0)
+  goto Error;
+*fd_handle = (SOCKET)fd;
+return ring;
+
+Error:
+strlcpy (errbuf, strerror (errno), PCAP_ERRBUF_SIZE);
+if (ring->map)
+  munmap (ring->map, ring->map_size);
+free (ring);
+close (fd);
+return NULL;
+}
+
+static void _eth_afpacket_close (AFPACKET_RING *ring, SOCKET fd)
+{
+munmap (ring->map, ring->map_size);
+free (ring);
+close (fd);
+}
+
+/* Build a kernel socket filter which passes the frames the current filter 
+   state could possibly want.  It admits a superset of what the simulated
+   NIC accepts (all multicast when hashing), so _eth_callback() still makes
+   the final decision exactly as it does for the other software filtered 
+   transports. */
+static void _eth_afpacket_insn (struct sock_filter *insn, uint16 code, uint8 jt, uint8 jf, uint32 k)
+{
+insn->code = code;
+insn->jt = jt;
+insn->jf = jf;
+insn->k = k;
+}
+
+static int _eth_afpacket_setfilter (ETH_DEV *dev, SOCKET fd)
+{
+struct sock_filter code[4*ETH_FILTER_MAX + 4];
+struct sock_fprog prog;
+int multicast = (dev->all_multicast || dev->hash_filter);
+int accept, pc = 0;
+int i;
+
+if (!dev->promiscuous) {
+  accept = 4*dev->addr_count + (multicast ? 2 : 0) + 1;
+  for (i = 0; i < dev->addr_count; i++) {
+    const uint8 *mac = dev->filter_address[i];
+
+    _eth_afpacket_insn (&code[pc++], BPF_LD|BPF_W|BPF_ABS, 0, 0, 0);
+    _eth_afpacket_insn (&code[pc++], BPF_JMP|BPF_JEQ|BPF_K, 0, 2, ((uint32)mac[0] << 24) | (mac[1] << 16) | (mac[2] << 8) | mac[3]);
+    _eth_afpacket_insn (&code[pc++], BPF_LD|BPF_H|BPF_ABS, 0, 0, 4);
+    _eth_afpacket_insn (&code[pc], BPF_JMP|BPF_JEQ|BPF_K, (uint8)(accept - pc - 1), 0, (mac[4] << 8) | mac[5]);
+    ++pc;
+    }
+  if (multicast) {
+    _eth_afpacket_insn (&code[pc++], BPF_LD|BPF_B|BPF_ABS, 0, 0, 0);
+    _eth_afpacket_insn (&code[pc], BPF_JMP|BPF_JSET|BPF_K, (uint8)(accept - pc - 1), 0, 0x01);
+    ++pc;
+    }
+  _eth_afpacket_insn (&code[pc++], BPF_RET|BPF_K, 0, 0, 0);
+  }
+_eth_afpacket_insn (&code[pc++], BPF_RET|BPF_K, 0, 0, ETH_MAX_JUMBO_FRAME);
+prog.len = (unsigned short)pc;
+prog.filter = code;
+return setsockopt (fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof (prog));
+}
+
+/* Deliver up to max (all if max < 0) received frames to _eth_callback() */
+static int _eth_afpacket_dispatch (ETH_DEV *dev, AFPACKET_RING *ring, int max)
+{
+int packets = 0;
+
+while ((max < 0) || (packets < max)) {
+  struct tpacket_block_desc *pbd = (struct tpacket_block_desc *)(ring->map + (size_t)ring->rx_block * ring->rx_req.tp_block_size);
+
+  if (0 == (pbd->hdr.bh1.block_status & TP_STATUS_USER))
+    break;
+  __sync_synchronize ();                /* block contents are valid once its status is */
+  if (ring->rx_pkt == 0)
+    ring->rx_offset = pbd->hdr.bh1.offset_to_first_pkt;
+  while ((ring->rx_pkt < pbd->hdr.bh1.num_pkts) && ((max < 0) || (packets < max))) {
+    struct tpacket3_hdr *ppd = (struct tpacket3_hdr *)((uint8 *)pbd + ring->rx_offset);
+    struct pcap_pkthdr header;
+
+    memset (&header, 0, sizeof (header));
+    header.caplen = ppd->tp_snaplen;
+    header.len = ppd->tp_len;
+    _eth_callback ((u_char *)dev, &header, (u_char *)ppd + ppd->tp_mac);
+    ring->rx_offset += ppd->tp_next_offset;
+    ++ring->rx_pkt;
+    ++packets;
+    }
+  if (ring->rx_pkt < pbd->hdr.bh1.num_pkts)
+    break;                              /* stopped part way through this block */
+  ring->rx_pkt = 0;
+  __sync_synchronize ();
+  pbd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+  ring->rx_block = (ring->rx_block + 1) % ring->rx_req.tp_block_nr;
+  }
+if (packets == 0) {                     /* woken with nothing to read? */
+  int err = 0;
+  socklen_t errlen = sizeof (err);
+
+  if ((0 == getsockopt (dev->fd_handle, SOL_SOCKET, SO_ERROR, &err, &errlen)) && err) {
+    errno = err;
+    return -1;
+    }
+  }
+return packets;
+}
+
+/* Once a TX ring is mapped the kernel transmits only from the ring and 
+   ignores any buffer passed to send(), so a frame which can't be placed 
+   in a ring slot is reported as an error rather than silently lost. */
+
+static int _eth_afpacket_send (ETH_DEV *dev, AFPACKET_RING *ring, const uint8 *msg, size_t len)
+{
+const size_t data_off = TPACKET_ALIGN (sizeof (struct tpacket3_hdr));
+uint8 *frame;
+struct tpacket3_hdr *hdr;
+
+if (ring->tx_req.tp_frame_nr == 0)                  /* no TX ring? */
+  return ((ssize_t)len == send (dev->fd_handle, msg, len, 0)) ? 0 : -1;
+if (len > ring->tx_req.tp_frame_size - data_off)    /* won't fit in a slot? */
+  return -1;
+frame = ring->map + ring->rx_size + (size_t)ring->tx_frame * ring->tx_req.tp_frame_size;
+hdr = (struct tpacket3_hdr *)frame;
+if (hdr->tp_status != TP_STATUS_AVAILABLE) {        /* slot still in use? */
+  struct pollfd pfd;
+
+  send (dev->fd_handle, NULL, 0, MSG_DONTWAIT);     /* kick pending frames */
+  pfd.fd = dev->fd_handle;
+  pfd.events = POLLOUT;
+  pfd.revents = 0;
+  if ((hdr->tp_status != TP_STATUS_AVAILABLE) &&
+      (poll (&pfd, 1, AFPACKET_TX_WAIT) < 0))
+    return -1;
+  __sync_synchronize ();
+  if (hdr->tp_status != TP_STATUS_AVAILABLE)
+    return -1;
+  }
+memcpy (frame + data_off, msg, len);
+hdr->tp_len = (uint32)len;
+hdr->tp_next_offset = 0;
+__sync_synchronize ();
+hdr->tp_status = TP_STATUS_SEND_REQUEST;
+ring->tx_frame = (ring->tx_frame + 1) % ring->tx_req.tp_frame_nr;
+/* A blocking send returns once the kernel has released the frame */
+return (send (dev->fd_handle, NULL, 0, 0) < 0) ? -1 : 0;
+}
+#endif /* HAVE_AFPACKET_NETWORK */
+
 #if defined (USE_READER_THREAD)
 static void *
 _eth_reader(void *arg)
@@ -1742,6 +2098,7 @@ switch (dev->eth_api) {
   case ETH_API_VDE:
   case ETH_API_UDP:
   case ETH_API_NAT:
+  case ETH_API_AFPACKET:
     do_select = 1;
     select_fd = dev->fd_handle;
     break;
@@ -1848,6 +2205,11 @@ while (dev->handle) {
         status = 1;
         break;
 #endif /* HAVE_SLIRP_NETWORK */
+#ifdef HAVE_AFPACKET_NETWORK
+      case ETH_API_AFPACKET:
+        status = _eth_afpacket_dispatch (dev, (AFPACKET_RING *)dev->handle, -1);
+        break;
+#endif /* HAVE_AFPACKET_NETWORK */
       case ETH_API_UDP:
         if (1) {
           struct pcap_pkthdr header;
@@ -1940,18 +2302,15 @@ while (dev->handle) {
     dev->write_status = _eth_write(dev, &request->packet, NULL);
 
     pthread_mutex_lock (&dev->writer_lock);
-    /* Put buffer on free buffer list */
-    request->next = dev->write_buffers;
-    dev->write_buffers = request;
+    /* Return buffer to the pool */
+    ethp_put (&dev->write_pool, request);
     request = NULL;
     }
   }
 /* If we exited these loops with a request allocated, */
-/* avoid buffer leaking by putting it on free buffer list */
-if (request) {
-  request->next = dev->write_buffers;
-  dev->write_buffers = request;
-  }
+/* avoid buffer leaking by returning it to the pool */
+if (request)
+  ethp_put (&dev->write_pool, request);
 pthread_mutex_unlock (&dev->writer_lock);
 
 sim_debug(dev->dbit, dev->dptr, "Writer Thread Exiting\n");
@@ -2005,6 +2364,8 @@ dev->throttle_mask = (1 << dev->throttle_burst) - 1;
 return SCPE_OK;
 }
 
+static t_stat _eth_close_port(int eth_api, pcap_t *pcap, SOCKET pcap_fd);
+
 static t_stat _eth_open_port(char *savname, int *eth_api, void **handle, SOCKET *fd_handle, char errbuf[PCAP_ERRBUF_SIZE], char *bpf_filter, void *opaque, DEVICE *dptr, uint32 dbit)
 {
 int bufsz = (BUFSIZ < ETH_MAX_PACKET) ? ETH_MAX_PACKET : BUFSIZ;
@@ -2018,7 +2379,25 @@ if (bufsz < ETH_MAX_JUMBO_FRAME)
 
 /* attempt to connect device */
 memset(errbuf, 0, PCAP_ERRBUF_SIZE);
-if (0 == strncmp("tap:", savname, 4)) {
+if (0 == strncmp("afpacket:", savname, 9)) {
+  const char *devname = savname + 9;
+
+  while (isspace(*devname))
+      ++devname;
+#if defined(HAVE_AFPACKET_NETWORK)
+  if (!strcmp(savname, "afpacket:ifname"))
+    return sim_messagef (SCPE_OPENERR, "Eth: Must specify actual interface name (i.e. afpacket:eth0)\n");
+  if ((*handle = (void *)_eth_afpacket_open (devname, fd_handle, errbuf))) {
+    *eth_api = ETH_API_AFPACKET;
+    /* a reopen after errors restores the kernel filter in effect before */
+    if (bpf_filter)
+      _eth_afpacket_setfilter ((ETH_DEV *)opaque, *fd_handle);
+    }
+#else
+  strlcpy(errbuf, "No support for afpacket: network devices", PCAP_ERRBUF_SIZE);
+#endif /* defined(HAVE_AFPACKET_NETWORK) */
+  }
+else if (0 == strncmp("tap:", savname, 4)) {
   int  tun = -1;    /* TUN/TAP Socket */
   int  on = 1;
   const char *devname = savname + 4;
@@ -2357,17 +2736,40 @@ eth_get_nic_hw_addr(dev, savname);
 
 /* save name of device */
 dev->name = (char *)malloc(strlen(savname)+1);
+if (!dev->name) {
+  _eth_close_port (dev->eth_api, (pcap_t *)dev->handle, dev->fd_handle);
+  eth_zero(dev);
+  return SCPE_MEM;
+  }
 strcpy(dev->name, savname);
 
 /* save debugging information */
 dev->dptr = dptr;
 dev->dbit = dbit;
 
+/* work buffer for splitting received jumbo frames */
+dev->jumbo_buf = (uint8 *)malloc(ETH_MAX_JUMBO_FRAME);
+if (!dev->jumbo_buf) {
+  _eth_close_port (dev->eth_api, (pcap_t *)dev->handle, dev->fd_handle);
+  free(dev->name);
+  eth_zero(dev);
+  return SCPE_MEM;
+  }
+
 #if defined (USE_READER_THREAD)
 if (1) {
   pthread_attr_t attr;
 
-  ethq_init (&dev->read_queue, 200);         /* initialize FIFO queue */
+  if ((ethq_init (&dev->read_queue, 200) != SCPE_OK) ||   /* initialize FIFO queue */
+      (ethp_init (&dev->write_pool, sizeof(ETH_WRITE_REQUEST), ETH_WRITE_POOL_MAX) != SCPE_OK)) {
+    ethp_destroy (&dev->write_pool);
+    ethq_destroy (&dev->read_queue);
+    free (dev->jumbo_buf);
+    _eth_close_port (dev->eth_api, (pcap_t *)dev->handle, dev->fd_handle);
+    free(dev->name);
+    eth_zero(dev);
+    return SCPE_MEM;
+    }
   pthread_mutex_init (&dev->lock, NULL);
   pthread_mutex_init (&dev->writer_lock, NULL);
   pthread_mutex_init (&dev->self_lock, NULL);
@@ -2420,6 +2822,11 @@ switch (eth_api) {
   case ETH_API_NAT:
     sim_slirp_close((SLIRP*)pcap);
     break;
+#endif
+#ifdef HAVE_AFPACKET_NETWORK
+  case ETH_API_AFPACKET:
+    _eth_afpacket_close((AFPACKET_RING*)pcap, pcap_fd);
+    break;
 #endif
   case ETH_API_UDP:
     sim_close_sock(pcap_fd);
@@ -2451,19 +2858,12 @@ pthread_join (dev->writer_thread, NULL);
 pthread_mutex_destroy (&dev->self_lock);
 pthread_mutex_destroy (&dev->writer_lock);
 pthread_cond_destroy (&dev->writer_cond);
-if (1) {
-  ETH_WRITE_REQUEST *buffer;
-   while (NULL != (buffer = dev->write_buffers)) {
-    dev->write_buffers = buffer->next;
-    free(buffer);
-    }
-  while (NULL != (buffer = dev->write_requests)) {
-    dev->write_requests = buffer->next;
-    free(buffer);
-    }
-  }
+dev->write_requests = NULL;              /* queued requests live in the pool */
+ethp_destroy (&dev->write_pool);         /* release write buffers */
 ethq_destroy (&dev->read_queue);         /* release FIFO queue */
 #endif
+free (dev->jumbo_buf);
+dev->jumbo_buf = NULL;
 
 _eth_close_port (dev->eth_api, pcap, pcap_fd);
 sim_messagef (SCPE_OK, "Eth: closed %s\n", dev->name);
@@ -2517,6 +2917,9 @@ fprintf (st, "    eth2   vde:device{:switch-port-number}      (Integrated VDE su
 fprintf (st, "    eth3   nat:{optional-nat-parameters}        (Integrated NAT (SLiRP) support)\n");
 #endif
 fprintf (st, "    eth4   udp:sourceport:remotehost:remoteport (Integrated UDP bridge support)\n");
+#if defined(HAVE_AFPACKET_NETWORK)
+fprintf (st, "    eth5   afpacket:ifname                      (Integrated AF_PACKET ring support)\n");
+#endif
 fprintf (st, "   sim> ATTACH %s eth0\n\n", dptr->name);
 fprintf (st, "or equivalently:\n\n");
 fprintf (st, "   sim> ATTACH %s en0\n\n", dptr->name);
@@ -2734,6 +3137,9 @@ switch (dev->eth_api) {
   case ETH_API_NAT:
       netname = "nat";
       break;
+  case ETH_API_AFPACKET:
+      netname = "afpacket";
+      break;
   }
 sprintf(msg, "%s(%s): ", where, netname);
 switch (dev->eth_api) {
@@ -2862,6 +3268,11 @@ if ((packet->len >= ETH_MIN_PACKET) && (packet->len <= ETH_MAX_PACKET)) {
       else
         status = 1;
       break;
+#endif
+#ifdef HAVE_AFPACKET_NETWORK
+    case ETH_API_AFPACKET:
+      status = _eth_afpacket_send(dev, (AFPACKET_RING*)dev->handle, packet->msg, packet->len);
+      break;
 #endif
     case ETH_API_UDP:
       status = (((int32)packet->len == sim_write_sock (dev->fd_handle, (char *)packet->msg, (int32)packet->len)) ? 0 : -1);
@@ -2902,13 +3313,16 @@ int write_queue_size = 1;
 /* make sure device exists */
 if ((!dev) || (dev->eth_api == ETH_API_NONE)) return SCPE_UNATT;
 
-/* Get a buffer */
+/* Get a buffer.  When every buffer is already queued, the packet is 
+   dropped just as a full transmit ring would on real hardware */
 pthread_mutex_lock (&dev->writer_lock);
-if (NULL != (request = dev->write_buffers))
-  dev->write_buffers = request->next;
+request = (ETH_WRITE_REQUEST *)ethp_get (&dev->write_pool);
 pthread_mutex_unlock (&dev->writer_lock);
-if (NULL == request)
-  request = (ETH_WRITE_REQUEST *)malloc(sizeof(*request));
+if (NULL == request) {
+  if (routine)
+    (routine)(SCPE_IOERR);
+  return SCPE_IOERR;
+  }
 
 /* Copy buffer contents */
 request->packet.len = packet->len;
@@ -2936,6 +3350,8 @@ else
 if (write_queue_size > dev->write_queue_peak)
   dev->write_queue_peak = write_queue_size;
 pthread_mutex_unlock (&dev->writer_lock);
+++eth_packets_written;
+eth_bytes_written += packet->len;
 
 /* Awaken writer thread to perform actual write */
 pthread_cond_signal (&dev->writer_cond);
@@ -2945,7 +3361,13 @@ if (routine)
   (routine)(dev->write_status);
 return dev->write_status;
 #else
-return _eth_write(dev, packet, routine);
+t_stat r = _eth_write(dev, packet, routine);
+
+if (r == SCPE_OK) {
+  ++eth_packets_written;
+  eth_bytes_written += packet->len;
+  }
+return r;
 #endif
 }
 
@@ -3483,6 +3905,7 @@ switch (dev->eth_api) {
   case ETH_API_VDE:
   case ETH_API_UDP:
   case ETH_API_NAT:
+  case ETH_API_AFPACKET:
     bpf_used = 0;
     to_me = 0;
     eth_packet_trace (dev, data, header->len, "received");
@@ -3531,11 +3954,10 @@ if ((LOOPBACK_SELF_FRAME(dev->physical_addr, data)) ||
 
 if (bpf_used ? to_me : (to_me && !from_me)) {
   if (header->len > ETH_MIN_JUMBO_FRAME) {
-    if (header->len <= header->caplen) {/* Whole Frame captured? */
-      u_char *datacopy = (u_char *)malloc(header->len);
-      memcpy(datacopy, data, header->len);
-      _eth_fix_ip_jumbo_offload(dev, datacopy, header->len);
-      free(datacopy);
+    if ((header->len <= header->caplen) && /* Whole Frame captured? */
+        (header->len <= ETH_MAX_JUMBO_FRAME)) {
+      memcpy(dev->jumbo_buf, data, header->len);
+      _eth_fix_ip_jumbo_offload(dev, dev->jumbo_buf, header->len);
       }
     else
       ++dev->jumbo_truncated;
@@ -3548,10 +3970,9 @@ if (bpf_used ? to_me : (to_me && !from_me)) {
     int crc_len = 0;
     uint8 crc_data[4];
     uint32 len = header->len;
-    u_char *moved_data = NULL;
+    u_char moved_data[ETH_MIN_PACKET];
 
     if (header->len < ETH_MIN_PACKET) {   /* Pad runt packets before CRC append */
-      moved_data = (u_char *)malloc(ETH_MIN_PACKET);
       memcpy(moved_data, data, len);
       memset(moved_data + len, 0, ETH_MIN_PACKET-len);
       len = ETH_MIN_PACKET;
@@ -3572,7 +3993,6 @@ if (bpf_used ? to_me : (to_me && !from_me)) {
     ethq_insert_data(&dev->read_queue, ETH_ITM_NORMAL, data, 0, len, crc_len, crc_data, 0);
     ++dev->packets_received;
     pthread_mutex_unlock (&dev->lock);
-    free(moved_data);
     }
 #else /* !USE_READER_THREAD */
   /* set data in passed read packet */
@@ -3679,6 +4099,11 @@ do {
         }
       break;
 #endif /* HAVE_VDE_NETWORK */
+#ifdef HAVE_AFPACKET_NETWORK
+    case ETH_API_AFPACKET:
+      status = _eth_afpacket_dispatch (dev, (AFPACKET_RING *)dev->handle, 1);
+      break;
+#endif /* HAVE_AFPACKET_NETWORK */
     case ETH_API_UDP:
       if (1) {
         struct pcap_pkthdr header;
@@ -3724,6 +4149,10 @@ if (status < 0) {
     routine(0);
 #endif
 
+if (packet->len > 0) {
+  ++eth_packets_read;
+  eth_bytes_read += packet->len;
+  }
 return status;
 }
 
@@ -3977,6 +4406,22 @@ if (dev->eth_api == ETH_API_PCAP) {
 #endif
   }
 #endif /* USE_BPF */
+#ifdef HAVE_AFPACKET_NETWORK
+if (dev->eth_api == ETH_API_AFPACKET) {
+  if (_eth_afpacket_setfilter (dev, dev->fd_handle) < 0)
+    sim_printf ("Eth: AF_PACKET socket filter error: %s\n", strerror (errno));
+  else {
+    /* Remember that a kernel filter is in effect (used on reopen) */
+    dev->bpf_filter = (char *)realloc(dev->bpf_filter, 1 + strlen(buf));
+    strcpy (dev->bpf_filter, buf);
+    }
+#ifdef USE_READER_THREAD
+  pthread_mutex_lock (&dev->lock);
+  ethq_clear (&dev->read_queue); /* Empty FIFO Queue when filter list changes */
+  pthread_mutex_unlock (&dev->lock);
+#endif
+  }
+#endif /* HAVE_AFPACKET_NETWORK */
 
 return SCPE_OK;
 }
@@ -4092,6 +4537,14 @@ if (used < max) {
   ++used;
   }
 #endif
+#ifdef HAVE_AFPACKET_NETWORK
+if (used < max) {
+  sprintf(list[used].name, "%s", "afpacket:ifname");
+  sprintf(list[used].desc, "%s", "Integrated AF_PACKET ring support");
+  list[used].eth_api = ETH_API_AFPACKET;
+  ++used;
+  }
+#endif
 
 if (used < max) {
   sprintf(list[used].name, "%s", "udp:sourceport:remotehost:remoteport");
@@ -4191,6 +4644,11 @@ fprintf(st, "  Read Queue: Count:       %d\n", dev->read_queue.count);
 fprintf(st, "  Read Queue: High:        %d\n", dev->read_queue.high);
 fprintf(st, "  Read Queue: Loss:        %d\n", dev->read_queue.loss);
 fprintf(st, "  Peak Write Queue Size:   %d\n", dev->write_queue_peak);
+fprintf(st, "  Write Buffers: Limit:    %d\n", dev->write_pool.max);
+fprintf(st, "  Write Buffers: High:     %d\n", dev->write_pool.high);
+fprintf(st, "  Write Buffers: Reused:   %u\n", dev->write_pool.reuses);
+if (dev->write_pool.empty)
+  fprintf(st, "  Write Buffers: Dropped:  %u\n", dev->write_pool.empty);
 #endif
 if (dev->bpf_filter)
   fprintf(st, "  BPF Filter: %s\n", dev->bpf_filter);
@@ -4315,6 +4773,7 @@ for (eth_num=0; eth_num<eth_device_count; eth_num++) {
   if ((0 == memcmp (eth_list[eth_num].name, "nat:", 4)) ||
       (0 == memcmp (eth_list[eth_num].name, "tap:", 4)) ||
       (0 == memcmp (eth_list[eth_num].name, "vde:", 4)) ||
+      (0 == memcmp (eth_list[eth_num].name, "afpacket:", 9)) ||
       (0 == memcmp (eth_list[eth_num].name, "udp:", 4)))
       continue;
   eth_name[sizeof (eth_name)-1] = '\0';
@@ -167,6 +167,8 @@ extern "C" {
 #define ETH_CRC_SIZE           4                        /* ethernet CRC size */
 #define ETH_FRAME_SIZE (ETH_MAX_PACKET+ETH_CRC_SIZE)    /* ethernet maximum frame size */
 #define ETH_MIN_JUMBO_FRAME ETH_MAX_PACKET              /* Threshold size for Jumbo Frame Processing */
+#define ETH_QUE_OVERSIZE_MAX   4                        /* oversized frame buffers per FIFO queue */
+#define ETH_WRITE_POOL_MAX   128                        /* write request buffers per device */
 
 #define LOOPBACK_SELF_FRAME(phy_mac, msg)                                                     \
     (((msg)[12] == 0x90) && ((msg)[13] == 0x00) &&              /* Ethernet Loopback */       \
@@ -222,6 +224,19 @@ struct eth_item {
   struct eth_packet   packet;
 };
 
+struct eth_pool {
+  uint8               *slab;                            /* storage for all buffers */
+  void                **free;                           /* stack of available buffers */
+  size_t              size;                             /* bytes per buffer */
+  int                 max;                              /* number of buffers (high water limit) */
+  int                 avail;                            /* buffers currently available */
+  int                 high;                             /* most buffers in use at once */
+  int                 fresh;                            /* never handed out (bottom of stack) */
+  uint32              gets;                             /* buffers handed out */
+  uint32              reuses;                           /* gets satisfied by a returned buffer */
+  uint32              empty;                            /* requests refused while exhausted */
+};
+
 struct eth_queue {
   int                 max;
   int                 count;
@@ -230,6 +245,7 @@ struct eth_queue {
   int                 loss;
   int                 high;
   struct eth_item*    item;
+  struct eth_pool     oversize;                         /* buffers for oversized frames */
 };
 
 struct eth_list {
@@ -245,6 +261,7 @@ typedef struct eth_packet  ETH_PACK;
 typedef void (*ETH_PCALLBACK)(int status);
 typedef struct eth_list ETH_LIST;
 typedef struct eth_queue ETH_QUE;
+typedef struct eth_pool ETH_POOL;
 typedef struct eth_item ETH_ITEM;
 struct eth_write_request {
   struct eth_write_request *next;
@@ -264,6 +281,7 @@ struct eth_device {
 #define ETH_API_VDE  3                                  /* VDE API in use */
 #define ETH_API_UDP  4                                  /* UDP API in use */
 #define ETH_API_NAT  5                                  /* NAT (SLiRP) API in use */
+#define ETH_API_AFPACKET 6                              /* Linux AF_PACKET ring API in use */
   ETH_PCALLBACK read_callback;                          /* read callback function */
   ETH_PCALLBACK write_callback;                         /* write callback function */
   ETH_PACK*     read_packet;                            /* read packet */
@@ -282,6 +300,7 @@ struct eth_device {
   uint32        jumbo_fragmented;                       /* Giant IPv4 Frames Fragmented */
   uint32        jumbo_dropped;                          /* Giant Frames Dropped */
   uint32        jumbo_truncated;                        /* Giant Frames too big for capture buffer - Dropped */
+  uint8*        jumbo_buf;                              /* work buffer for jumbo frame segmentation */
   uint32        packets_sent;                           /* Total Packets Sent */
   uint32        packets_received;                       /* Total Packets Received */
   uint32        loopback_packets_processed;             /* Total Loopback Packets Processed */
@@ -321,7 +340,7 @@ struct eth_device {
   pthread_cond_t      writer_cond;
   ETH_WRITE_REQUEST *write_requests;
   int write_queue_peak;
-  ETH_WRITE_REQUEST *write_buffers;
+  ETH_POOL      write_pool;                             /* write request buffers */
   t_stat write_status;
 #endif
 };
@@ -378,7 +397,15 @@ void ethq_insert_data(ETH_QUE* que, int32 type,         /* insert item into FIFO
                   const uint8 *data, int used, size_t len, 
                   size_t crc_len, const uint8 *crc_data, int32 status);
 t_stat ethq_destroy(ETH_QUE* que);                      /* release FIFO queue */
+t_stat ethp_init (ETH_POOL* pool, size_t size, int max);/* allocate buffer pool */
+void ethp_destroy (ETH_POOL* pool);                     /* release buffer pool */
+void *ethp_get (ETH_POOL* pool);                        /* take buffer from pool (NULL if exhausted) */
+void ethp_put (ETH_POOL* pool, void *buf);              /* return buffer to pool */
 const char *eth_capabilities(void);
+void eth_data_totals (t_uint64 *packets_read,          /* totals across all devices */
+                      t_uint64 *bytes_read,
+                      t_uint64 *packets_written,
+                      t_uint64 *bytes_written);
 t_stat sim_ether_test (DEVICE *dptr);                   /* unit test routine */
 
 #if !defined(SIM_TEST_INIT)     /* Need stubs for test APIs */
@@ -47,6 +47,7 @@ extern "C" {
 #endif
 
 #include "sim_frontpanel.h"
+#include "sim_frontpanel_shmem.h"
 
 #include <stdio.h>
 #include <stdarg.h>
@@ -118,6 +119,19 @@ return 0;
 
 #endif /* NOT _WIN32 */
 
+/* Shared memory register mirror support */
+#if defined(_WIN32)
+#define HAVE_PANEL_SHMEM 1
+#define _panel_memory_barrier() MemoryBarrier ()
+#elif defined(HAVE_SHM_OPEN) && defined(__GNUC__)
+#include <sys/mman.h>
+#include <fcntl.h>
+#define HAVE_PANEL_SHMEM 1
+#define _panel_memory_barrier() __sync_synchronize ()
+#endif
+#define PANEL_SHMEM_INTERVAL 16667  /* usecs between mirror updates (60Hz) */
+#define PANEL_SHMEM_TRIES    5      /* mirror reads before falling back to EXAMINE */
+
 typedef struct {
     char *name;
     char *device_name;
@@ -153,6 +167,7 @@ struct PANEL {
     pthread_mutex_t         io_lock;
     pthread_mutex_t         io_send_lock;
     pthread_mutex_t         io_command_lock;
+    pthread_mutex_t         shm_lock;       /* serializes register mirror setup */
     int                     command_count;
     int                     io_waiting;
     char                    *io_response;
@@ -172,6 +187,13 @@ struct PANEL {
     unsigned int            sample_frequency;
     unsigned int            sample_dither_pct;
     unsigned int            sample_depth;
+    SIM_PANEL_SHMEM         *shm;           /* register mirror (when available) */
+    void                    *shm_base;      /* mirror mapping */
+    size_t                  shm_size;       /* mirror mapping size */
+    int                     shm_stale;      /* register mirror needs (re)establishing */
+#if defined(_WIN32)
+    HANDLE                  hShmem;
+#endif
     int                     debug;
     char                    *simulator_version;
     int                     radix;
@@ -192,6 +214,7 @@ struct PANEL {
  *                        acquired and released in application threads: 
  *                                                  _panel_register_query_string,
  *                                                  _panel_establish_register_bits_collection,
+ *                                                  _panel_establish_shared_memory,
  *                                                  _panel_sendf
  *                        acquired and released in internal threads: 
  *                                                  _panel_callback
@@ -203,6 +226,10 @@ struct PANEL {
  *   io_command_lock     To serialize frontpanel application command requests
  *                        acquired and released in: _panel_get_registers, 
  *                                                  _panel_sendf_completion
+ *   shm_lock            Serializes (re)establishing the register mirror, which
+ *                       is done from both application and callback threads.
+ *                       Acquired before io_lock, never while holding it.
+ *                        acquired and released in: _panel_establish_shared_memory
  *
  *  Condition Var:  Sync Mutex:  Purpose & Duration:
  *   io_done        io_lock
@@ -634,6 +661,218 @@ free (buf);
 return 0;
 }
 
+static void
+_panel_unmap_shared_memory (PANEL *panel)
+{
+#if defined(HAVE_PANEL_SHMEM)
+if (panel->shm_base) {
+#if defined(_WIN32)
+    UnmapViewOfFile (panel->shm_base);
+    CloseHandle (panel->hShmem);
+    panel->hShmem = NULL;
+#else
+    munmap (panel->shm_base, panel->shm_size);
+#endif
+    }
+#endif
+panel->shm_base = NULL;
+panel->shm_size = 0;
+panel->shm = NULL;
+}
+
+/* 
+   Ask the simulator to publish the values of the current register list 
+   (and the bit sample totals) in a shared memory segment and map it.  
+   When this isn't possible register data is simply gathered via the 
+   remote console connection.  Called with shm_lock held.
+ */
+static int
+_panel_map_shared_memory (PANEL *panel)
+{
+#if defined(HAVE_PANEL_SHMEM)
+static int shm_count = 0;
+size_t i, buf_data, buf_needed = 1, value_count = 0;
+int cmd_stat, usecs, reg_count = 0;
+char *buf, *response = NULL, name[64];
+SIM_PANEL_SHMEM *shm = NULL;
+void *base = NULL;
+size_t size = 0;
+
+pthread_mutex_lock (&panel->io_lock);
+panel->shm_stale = 0;
+_panel_unmap_shared_memory (panel);
+usecs = panel->usecs_between_callbacks;
+if ((usecs <= 0) || (usecs > PANEL_SHMEM_INTERVAL))
+    usecs = PANEL_SHMEM_INTERVAL;
+for (i=0; i<panel->reg_count; i++) {
+    if (!panel->regs[i].bits)
+        buf_needed += 20 + strlen (panel->regs[i].name) + (panel->regs[i].device_name ? strlen (panel->regs[i].device_name) : 0);
+    }
+buf = (char *)_panel_malloc (buf_needed);
+if (!buf) {
+    panel->State = Error;
+    pthread_mutex_unlock (&panel->io_lock);
+    return -1;
+    }
+*buf = '\0';
+buf_data = 0;
+for (i=0; i<panel->reg_count; i++) {
+    if (panel->regs[i].bits)
+        continue;
+    sprintf (buf + buf_data, "%s%s", (reg_count++ != 0) ? "," : "", panel->regs[i].indirect ? "-I " : "");
+    buf_data += strlen (buf + buf_data);
+    if (panel->regs[i].device_name) {
+        sprintf (buf + buf_data, "%s ", panel->regs[i].device_name);
+        buf_data += strlen (buf + buf_data);
+        }
+    sprintf (buf + buf_data, "%s", panel->regs[i].name);
+    buf_data += strlen (buf + buf_data);
+    if (panel->regs[i].element_count > 0) {
+        sprintf (buf + buf_data, "[0:%d]", (int)(panel->regs[i].element_count-1));
+        buf_data += strlen (buf + buf_data);
+        value_count += panel->regs[i].element_count;
+        }
+    else
+        ++value_count;
+    }
+sprintf (name, "simh-panel-%d-%d", (int)getpid(), ++shm_count);
+pthread_mutex_unlock (&panel->io_lock);
+/* Command status isn't reliably reported while the simulator is running, */
+/* so success is determined by whether the segment can be mapped           */
+if (_panel_sendf (panel, &cmd_stat, &response, "SHMEM %s EVERY %d USECS %s\r", name, usecs, buf)) {
+    free (buf);
+    return -1;
+    }
+free (response);
+free (buf);
+#if defined(_WIN32)
+if (1) {
+    SYSTEM_INFO SysInfo;
+
+    GetSystemInfo (&SysInfo);
+    panel->hShmem = OpenFileMappingA (FILE_MAP_READ, FALSE, name);
+    if (panel->hShmem != NULL) {
+        base = MapViewOfFile (panel->hShmem, FILE_MAP_READ, 0, 0, 0);
+        if (base != NULL) {
+            size = *((DWORD *)base) + SysInfo.dwPageSize;
+            shm = (SIM_PANEL_SHMEM *)((char *)base + SysInfo.dwPageSize);
+            }
+        else {
+            CloseHandle (panel->hShmem);
+            panel->hShmem = NULL;
+            }
+        }
+    }
+#else
+if (1) {
+    char shm_name[72];
+    struct stat statb;
+    int fd;
+
+    sprintf (shm_name, "/%s", name);
+    fd = shm_open (shm_name, O_RDONLY, 0);
+    if (fd != -1) {
+        if ((!fstat (fd, &statb)) && 
+            ((size_t)statb.st_size >= sizeof (*shm))) {
+            size = (size_t)statb.st_size;
+            base = mmap (NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED)
+                base = NULL;
+            shm = (SIM_PANEL_SHMEM *)base;
+            }
+        close (fd);
+        shm_unlink (shm_name);  /* name isn't needed once both sides have it mapped */
+        }
+    }
+#endif
+pthread_mutex_lock (&panel->io_lock);
+panel->shm_base = base;
+panel->shm_size = size;
+if ((base == NULL) ||
+    (shm->magic != SIM_PANEL_SHMEM_MAGIC) ||
+    (shm->value_count != value_count) ||
+    (sizeof (*shm) + shm->value_count * sizeof (unsigned long long) + shm->bits_count * sizeof (int) > shm->size)) {
+    _panel_debug (panel, DBG_REQ, "Register mirror '%s' can't be used", NULL, 0, name);
+    _panel_unmap_shared_memory (panel);
+    pthread_mutex_unlock (&panel->io_lock);
+    return -1;
+    }
+panel->shm = shm;
+_panel_debug (panel, DBG_REQ, "Register mirror '%s' established: %d values updated every %d usecs", NULL, 0, name, (int)value_count, usecs);
+pthread_mutex_unlock (&panel->io_lock);
+return 0;
+#else
+panel->shm_stale = 0;
+return -1;
+#endif
+}
+
+/* Both the application thread (after a register list change) and the
+   callback thread can (re)establish the register mirror.  io_lock can't
+   be held across the SHMEM command, so shm_lock keeps the two from
+   unmapping and mapping the segment underneath each other. */
+static int
+_panel_establish_shared_memory (PANEL *panel)
+{
+int stat;
+
+pthread_mutex_lock (&panel->shm_lock);
+stat = _panel_map_shared_memory (panel);
+pthread_mutex_unlock (&panel->shm_lock);
+return stat;
+}
+
+/* Copy register values and bit sample totals out of the register mirror.
+   Called with io_lock held.  Makes a single attempt and returns 1 if the
+   simulator was updating the mirror, so the caller can retry after 
+   releasing io_lock. */
+static int
+_panel_shmem_get_registers (PANEL *panel)
+{
+#if defined(HAVE_PANEL_SHMEM)
+const SIM_PANEL_SHMEM *shm = panel->shm;
+const unsigned long long *values = (const unsigned long long *)(shm + 1);
+const int *bits = (const int *)(values + shm->value_count);
+int sequence = shm->sequence;
+size_t i, j, v = 0, b = 0;
+
+if (sequence & 1)               /* update in progress? */
+    return 1;
+_panel_memory_barrier ();
+for (i=0; i<panel->reg_count; i++) {
+    REG *r = &panel->regs[i];
+
+    if (r->bits) {
+        size_t width;
+
+        if (b >= shm->bits_count)
+            continue;
+        width = (size_t)bits[b++];
+        for (j=0; (j < width) && (j < r->bit_count) && (b + j < shm->bits_count); j++)
+            r->bits[j] = bits[b + j];
+        b += width;
+        }
+    else {
+        size_t count = (r->element_count > 0) ? r->element_count : 1;
+
+        for (j=0; (j < count) && (v < shm->value_count); j++, v++) {
+            unsigned long long data = values[v];
+
+            if (little_endian)
+                memcpy ((char *)(r->addr) + (j * r->size), &data, r->size);
+            else
+                memcpy ((char *)(r->addr) + (j * r->size), ((char *)&data) + sizeof(data)-r->size, r->size);
+            }
+        }
+    }
+panel->simulation_time = shm->simulation_time;
+_panel_memory_barrier ();
+return (sequence == shm->sequence) ? 0 : 1;
+#else
+return -1;
+#endif
+}
+
 static PANEL **panels = NULL;
 static int panel_count = 0;
 static char *sim_panel_error_buf = NULL;
@@ -904,6 +1143,7 @@ _panel_debug (p, DBG_XMT|DBG_RCV, "Connected to simulator on %s after %dms", NUL
 pthread_mutex_init (&p->io_lock, NULL);
 pthread_mutex_init (&p->io_send_lock, NULL);
 pthread_mutex_init (&p->io_command_lock, NULL);
+pthread_mutex_init (&p->shm_lock, NULL);
 pthread_cond_init (&p->io_done, NULL);
 pthread_cond_init (&p->startup_done, NULL);
 if (sizeof(mantra) != _panel_send (p, (char *)mantra, sizeof(mantra))) {
@@ -1069,11 +1309,13 @@ if (panel) {
         sim_close_sock (sock);
         pthread_join (panel->io_thread, NULL);
         }
+    _panel_unmap_shared_memory (panel);
     if ((panel->Debug) && (panel->parent == NULL))
         pthread_join (panel->debugflush_thread, NULL);
     pthread_mutex_destroy (&panel->io_lock);
     pthread_mutex_destroy (&panel->io_send_lock);
     pthread_mutex_destroy (&panel->io_command_lock);
+    pthread_mutex_destroy (&panel->shm_lock);
     pthread_cond_destroy (&panel->io_done);
 #if defined(_WIN32)
     if (panel->hProcess) {
@@ -1272,6 +1514,7 @@ pthread_mutex_lock (&panel->io_lock);
 free (panel->regs);
 panel->regs = regs;
 panel->new_register = 1;
+panel->shm_stale = 1;
 pthread_mutex_unlock (&panel->io_lock);
 /* Now build the register query string for the whole register list */
 if (_panel_register_query_string (panel, &panel->reg_query, &panel->reg_query_size))
@@ -1352,6 +1595,25 @@ if (!panel->reg_count) {
     sim_panel_set_error (NULL, "No registers specified");
     return -1;
     }
+if (panel->shm_stale)
+    _panel_establish_shared_memory (panel);
+if (panel->shm && (panel->State == Run)) {
+    int tries, status = -1;
+
+    for (tries = 0; tries < PANEL_SHMEM_TRIES; tries++) {
+        if (tries)
+            msleep (1);                 /* let the update finish (without io_lock) */
+        pthread_mutex_lock (&panel->io_lock);
+        status = _panel_shmem_get_registers (panel);
+        if ((status == 0) && simulation_time)
+            *simulation_time = panel->simulation_time;
+        pthread_mutex_unlock (&panel->io_lock);
+        if (status <= 0)
+            break;
+        }
+    if (status == 0)
+        return 0;
+    }
 pthread_mutex_lock (&panel->io_command_lock);
 pthread_mutex_lock (&panel->io_lock);
 if (panel->reg_query_size != _panel_send (panel, panel->reg_query, panel->reg_query_size)) {
@@ -1396,6 +1658,7 @@ if (usecs_between_callbacks && (0 == panel->usecs_between_callbacks)) { /* Need
 
     _panel_debug (panel, DBG_THR, "Starting callback thread, Interval: %d usecs", NULL, 0, usecs_between_callbacks);
     panel->usecs_between_callbacks = usecs_between_callbacks;
+    panel->new_register = 1;                                        /* establish data delivery at this rate */
     pthread_cond_init (&panel->startup_done, NULL);
     pthread_attr_init(&attr);
     pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
@@ -2447,6 +2710,9 @@ char *buf = NULL;
 size_t buf_data = 0;
 unsigned int callback_count = 0;
 int cmd_stat;
+int repeating = 0;
+int halted_usecs = 0;
+long long deadline = 0;
 
 /* 
    Boost Priority for timer thread so it doesn't compete 
@@ -2473,16 +2739,55 @@ while ((p->sock != INVALID_SOCKET) &&
     p->new_register = 0;
     pthread_mutex_unlock (&p->io_lock);
 
-    if (new_register)           /* need to get and send updated register info */
+    if (new_register) {         /* need to get and send updated register info */
         _panel_register_query_string (p, &buf, &buf_data);
+        if ((!_panel_establish_shared_memory (p)) && repeating) {
+            _panel_sendf (p, &cmd_stat, NULL, "%s", register_repeat_stop);
+            repeating = 0;
+            }
+        }
 
-    /* twice a second activities:                                               */
-    /*  1) update the query string if it has changed                            */
-    /*     (only really happens at startup)                                     */
-    /*  2) update register state by polling if the simulator is halted          */
-    msleep (500);
-    pthread_mutex_lock (&p->io_lock);
-    if (new_register) {
+    if (p->shm) {
+        /* The simulator publishes register data in shared memory.  Read it */
+        /* directly at the requested rate while running and only poll a    */
+        /* halted system twice a second.                                    */
+        struct timespec time_now;
+        long long now;
+        int msecs;
+
+        clock_gettime (CLOCK_REALTIME, &time_now);
+        now = ((long long)time_now.tv_sec) * 1000000 + time_now.tv_nsec / 1000;
+        if ((deadline == 0) || (now - deadline > interval))
+            deadline = now;                 /* (re)synchronize after falling behind */
+        deadline += interval;
+        msecs = (int)((deadline - now + 500) / 1000);
+        msleep (msecs);
+        pthread_mutex_lock (&p->io_lock);
+        if ((p->State == Run) && (p->shm)) {
+            halted_usecs = 0;
+            if (_panel_shmem_get_registers (p))
+                continue;
+            if (p->callback) {
+                pthread_mutex_unlock (&p->io_lock);
+                p->callback (p, p->simulation_time_base + p->simulation_time, p->callback_context);
+                pthread_mutex_lock (&p->io_lock);
+                }
+            continue;
+            }
+        halted_usecs += interval;
+        if (halted_usecs < 500000)
+            continue;
+        halted_usecs = 0;
+        }
+    else {
+        /* twice a second activities:                                           */
+        /*  1) update the query string if it has changed                        */
+        /*     (only really happens at startup)                                 */
+        /*  2) update register state by polling if the simulator is halted      */
+        msleep (500);
+        pthread_mutex_lock (&p->io_lock);
+        }
+    if (new_register && (!p->shm)) {
         size_t repeat_data = strlen (register_repeat_prefix) +  /* prefix */
                              20                              +  /* max int width */
                              strlen (register_repeat_units)  +  /* units and spacing */
@@ -2516,6 +2821,7 @@ while ((p->sock != INVALID_SOCKET) &&
             break;
             }
         pthread_mutex_lock (&p->io_lock);
+        repeating = 1;
         free (repeat);
         }
     /* when halted, we directly poll the halted system to get updated */
@@ -43,6 +43,13 @@
          into the application.
       4) Use a simh simulator built from the same version of simh that the
          sim_frontpanel and sim_sock modules came from.
+
+   When sim_frontpanel.c is compiled with HAVE_SHM_OPEN defined (or on 
+   Windows), register and bit sample data is read from a shared memory 
+   mirror the simulator maintains rather than by exchanging EXAMINE 
+   commands, which allows high display refresh rates at little cost to 
+   the simulator.  Without it, the same data is gathered over the 
+   remote console connection.
 */
 
 #ifndef SIM_FRONTPANEL_H_
@@ -56,7 +63,7 @@ extern "C" {
 
 #if !defined(__VAX)         /* Unsupported platform */
 
-#define SIM_FRONTPANEL_VERSION   12
+#define SIM_FRONTPANEL_VERSION   13
 
 /**
 
@@ -0,0 +1,60 @@
+/* sim_frontpanel_shmem.h: frontpanel shared memory register mirror layout
+
+   Copyright (c) 2026, The SIMH contributors
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+   Except as contained in this notice, the names of the authors shall not be
+   used in advertising or otherwise to promote the sale, use or other dealings
+   in this Software without prior written authorization from the authors.
+*/
+
+#ifndef SIM_FRONTPANEL_SHMEM_H_
+#define SIM_FRONTPANEL_SHMEM_H_     0
+
+/**
+
+    Shared memory register mirror layout
+
+    This is an internal detail of the panel<->simulator protocol, shared 
+    by sim_frontpanel.c and the simulator's remote console (sim_console.c).  
+    Applications never include this file.
+
+    The segment starts with this header, followed by value_count 64 bit 
+    register values (in the order the registers were requested) and then 
+    bits_count ints holding, for each register being bit sampled, its 
+    bit width followed by the sample totals of each of its bits.
+
+    sequence is odd while the simulator is updating the contents.  A 
+    reader copies what it needs and then retries if sequence was odd or 
+    changed while it was copying.
+ */
+#define SIM_PANEL_SHMEM_MAGIC   0x53504D31      /* "SPM1" */
+
+typedef struct SIM_PANEL_SHMEM {
+    unsigned int        magic;
+    unsigned int        size;               /* segment size in bytes */
+    volatile int        sequence;           /* update sequence (odd while updating) */
+    unsigned int        value_count;        /* number of register values */
+    unsigned int        bits_count;         /* number of bit sample ints */
+    unsigned int        interval;           /* usecs between updates */
+    unsigned long long  updates;            /* updates published */
+    unsigned long long  simulation_time;    /* simulation time of last update */
+    } SIM_PANEL_SHMEM;
+
+#endif /* SIM_FRONTPANEL_SHMEM_H_ */
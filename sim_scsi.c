@@ -276,6 +276,108 @@ bus->sense_key = key;
 bus->sense_code = asc;
 }
 
+/* Asynchronous media transfers
+
+   Transfers to and from the attached container are issued with the
+   sim_disk and sim_tape _a routines.  While a transfer is in progress
+   the target keeps the bus with REQ released and scsi_read/scsi_write
+   accept no data.  When the transfer completes the rest of the command
+   runs in the main simulator thread and the controller is notified via
+   the bus ready routine.  With asynchronous I/O disabled the completion
+   runs before the _a routine returns, exactly as a synchronous command. */
+
+#define SCSI_MAX_BUS    4                               /* buses which can have transfers */
+
+typedef void (*SCSI_IO_DONE)(SCSI_BUS *bus, t_stat r);
+
+static SCSI_BUS *scsi_buses[SCSI_MAX_BUS];
+
+/* Find the bus waiting for a transfer on the given unit */
+
+static SCSI_BUS *scsi_io_bus (UNIT *uptr)
+{
+SCSI_BUS *bus;
+uint32 i;
+
+for (i = 0; i < SCSI_MAX_BUS; i++) {
+    bus = scsi_buses[i];
+    if ((bus != NULL) && (bus->io_done != NULL) && (bus->dev[bus->io_target] == uptr))
+        return bus;
+    }
+return NULL;
+}
+
+/* Transfer completion callback */
+
+static void scsi_io_callback (UNIT *uptr, t_stat r)
+{
+SCSI_BUS *bus = scsi_io_bus (uptr);
+SCSI_IO_DONE done;
+t_bool async;
+
+if (bus == NULL)                                        /* transfer abandoned? */
+    return;
+done = bus->io_done;
+async = bus->io_async;
+bus->io_done = NULL;
+bus->io_async = FALSE;
+if (async)
+    sim_debug (SCSI_DBG_BUS, bus->dptr,
+       "Target %d transfer complete\n", bus->io_target);
+done (bus, r);                                          /* finish command */
+if (async && (bus->io_done == NULL) && (bus->ready != NULL))
+    bus->ready (bus);                                   /* target ready again */
+}
+
+/* Record the completion routine before starting a transfer */
+
+static void scsi_io_start (SCSI_BUS *bus, SCSI_IO_DONE done)
+{
+bus->io_done = done;
+bus->io_target = bus->target;
+bus->io_async = FALSE;
+}
+
+/* Note a transfer which did not complete immediately */
+
+static void scsi_io_started (SCSI_BUS *bus)
+{
+if (bus->io_done != NULL) {                             /* still in progress? */
+    sim_debug (SCSI_DBG_BUS, bus->dptr,
+       "Target %d busy\n", bus->io_target);
+    bus->io_async = TRUE;
+    }
+}
+
+/* Wait for a transfer in progress, optionally discarding its result */
+
+static void scsi_io_wait (SCSI_BUS *bus, t_bool discard)
+{
+UNIT *uptr;
+
+if (bus->io_done == NULL)                               /* nothing in progress? */
+    return;
+uptr = bus->dev[bus->io_target];
+if (discard) {
+    sim_debug (SCSI_DBG_BUS, bus->dptr,
+       "Target %d transfer abandoned\n", bus->io_target);
+    bus->io_done = NULL;
+    bus->io_async = FALSE;
+    }
+sim_cancel (uptr);                                      /* wait for I/O thread */
+#if defined (SIM_ASYNCH_IO)
+if (uptr->a_check_completion)
+    uptr->a_check_completion (uptr);                    /* deliver completion now */
+#endif
+}
+
+/* Test for a transfer in progress */
+
+t_bool scsi_busy (SCSI_BUS *bus)
+{
+return (bus->io_done != NULL);
+}
+
 /* Decode the command group to get the command length */
 
 uint32 scsi_decode_group (uint8 data)
@@ -337,6 +439,24 @@ switch (st) {
 return;
 }
 
+/* Complete a tape command with immediate status */
+
+void scsi_tape_done (SCSI_BUS *bus, t_stat r)
+{
+scsi_tape_status (bus, r);
+scsi_status (bus, bus->status, bus->sense_key, bus->sense_code);
+}
+
+/* Complete a tape command with deferred status */
+
+void scsi_tape_sts_done (SCSI_BUS *bus, t_stat r)
+{
+scsi_tape_status (bus, r);
+bus->buf[bus->buf_b++] = bus->status;                   /* status code */
+scsi_set_phase (bus, SCSI_STS);                         /* status phase next */
+scsi_set_req (bus);                                     /* request to send data */
+}
+
 /* Limit the transfer count to the allocation specified
    by the SCSI command */
 
@@ -727,13 +847,22 @@ scsi_set_req (bus);                                     /* request to send data
 
 /* Command - Read (6 byte command), disk version */
 
+void scsi_read_disk_done (SCSI_BUS *bus, t_stat r)
+{
+UNIT *uptr = bus->dev[bus->target];
+SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
+
+bus->buf_b = (bus->io_count * dev->block_size);
+scsi_set_phase (bus, SCSI_DATI);                        /* data in phase next */
+scsi_set_req (bus);                                     /* request to send data */
+}
+
 void scsi_read6_disk (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 UNIT *uptr = bus->dev[bus->target];
 SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
 t_lba lba;
-t_seccnt sects, sectsread;
-t_stat r;
+t_seccnt sects;
 
 lba = GETW (data, 2) | ((data[1] & 0x1F) << 16);
 sects = data[4];
@@ -742,26 +871,95 @@ if (sects == 0)
 
 sim_debug (SCSI_DBG_CMD, bus->dptr, "Read(6) lba %d blks %d\n", lba, sects);
 
-if (uptr->flags & UNIT_ATT)
-    r = sim_disk_rdsect (uptr, lba, &bus->buf[0], &sectsread, sects);
+if (uptr->flags & UNIT_ATT) {
+    scsi_io_start (bus, &scsi_read_disk_done);
+    sim_disk_rdsect_a (uptr, lba, &bus->buf[0], &bus->io_count, sects, &scsi_io_callback);
+    scsi_io_started (bus);
+    }
 else {
     memset (&bus->buf[0], 0, (sects * dev->block_size));
-    sectsread = sects;
+    bus->io_count = sects;
+    scsi_read_disk_done (bus, SCPE_OK);
     }
+}
 
-bus->buf_b = (sectsread * dev->block_size);
-scsi_set_phase (bus, SCSI_DATI);                        /* data in phase next */
+/* Command - Read (6 byte command), tape version */
+
+void scsi_read6_tape_xfer (SCSI_BUS *bus, t_seccnt sectsread)
+{
+if (sectsread > 0) {
+    bus->buf_b = sectsread;
+    scsi_set_phase (bus, SCSI_DATI);                    /* data in phase next */
+    }
+else {
+    bus->buf[bus->buf_b++] = bus->status;               /* status code */
+    scsi_set_phase (bus, SCSI_STS);                     /* status phase next */
+    }
 scsi_set_req (bus);                                     /* request to send data */
 }
 
-/* Command - Read (6 byte command), tape version */
+void scsi_read6_tape_done (SCSI_BUS *bus, t_stat r)
+{
+UNIT *uptr = bus->dev[bus->target];
+SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
+t_seccnt sects, sectsread;
+uint32 flags;
+
+sects = GETW (bus->cmd, 3) | (bus->cmd[2] << 16);
+flags = bus->cmd[1];
+sectsread = bus->io_count;
+memset (&bus->cmd[0], 0, 10);                           /* clear current cmd */
+
+if (flags & 0x1) {
+    sim_debug (SCSI_DBG_CMD, bus->dptr,
+        "Read tape blk %d, read %d, r = %d\n", sects, sectsread, r);
+    }
+else {
+    sim_debug (SCSI_DBG_CMD, bus->dptr,
+        "Read tape max %d, read %d, r = %d\n", sects, sectsread, r);
+    if (r == MTSE_INVRL) {                              /* overlength condition */
+        sim_debug (SCSI_DBG_CMD, bus->dptr,
+            "Overlength\n");
+        if ((flags & 0x2) && (dev->block_size == 0)) {  /* SILI set */
+            sim_debug (SCSI_DBG_CMD, bus->dptr,
+                "SILI set\n");
+            }
+        else {
+            sim_debug (SCSI_DBG_CMD, bus->dptr,
+                "SILI not set - check condition\n");
+            scsi_status (bus, STS_CHK, (KEY_OK | KEY_M_ILI), ASC_OK);
+            return;
+            }
+        }
+    else if ((r == MTSE_OK) && (sectsread < sects)) {   /* underlength condition */
+        sim_debug (SCSI_DBG_CMD, bus->dptr,
+            "Underlength\n");
+        if (flags & 0x2) {                              /* SILI set */
+            sim_debug (SCSI_DBG_CMD, bus->dptr,
+                "SILI set\n");
+            }
+        else {
+            sim_debug (SCSI_DBG_CMD, bus->dptr,
+                "SILI not set - check condition\n");
+            scsi_status_deferred (bus, STS_CHK, (KEY_OK | KEY_M_ILI), ASC_OK);
+            bus->sense_info = (sects - sectsread);
+            }
+        }
+    }
+
+if (r != MTSE_OK) {
+    sim_debug (SCSI_DBG_CMD, bus->dptr,
+        "Read error, r = %d\n", r);
+    }
+scsi_tape_status (bus, r);
+scsi_read6_tape_xfer (bus, sectsread);
+}
 
 void scsi_read6_tape (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 UNIT *uptr = bus->dev[bus->target];
 SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
-t_seccnt sects, sectsread;
-t_stat r;
+t_seccnt sects;
 
 if ((data[1] & 0x3) == 0x3) {                           /* SILI and FIXED? */
     scsi_status (bus, STS_CHK, KEY_ILLREQ, ASC_INVCDB);
@@ -769,7 +967,6 @@ if ((data[1] & 0x3) == 0x3) {                           /* SILI and FIXED? */
     }
 
 sects = GETW (data, 3) | (data[2] << 16);
-sectsread = 0;
 
 if (sects == 0) {                                       /* no data to read */
     scsi_status (bus, STS_OK, KEY_OK, ASC_OK);
@@ -780,65 +977,19 @@ sim_debug (SCSI_DBG_CMD, bus->dptr,
     "Read(6) blks %d fixed %d\n", sects, (data[1] & 0x1));
 
 if (uptr->flags & UNIT_ATT) {
-    if (data[1] & 0x1) {
-        r = sim_tape_rdrecf (uptr, &bus->buf[0], &sectsread, (sects * dev->block_size));
-        sim_debug (SCSI_DBG_CMD, bus->dptr,
-            "Read tape blk %d, read %d, r = %d\n", sects, sectsread, r);
-        }
-    else {
-        r = sim_tape_rdrecf (uptr, &bus->buf[0], &sectsread, sects);
-        sim_debug (SCSI_DBG_CMD, bus->dptr,
-            "Read tape max %d, read %d, r = %d\n", sects, sectsread, r);
-        if (r == MTSE_INVRL) {                          /* overlength condition */
-            sim_debug (SCSI_DBG_CMD, bus->dptr,
-                "Overlength\n");
-            if ((data[1] & 0x2) && (dev->block_size == 0)) { /* SILI set */
-                sim_debug (SCSI_DBG_CMD, bus->dptr,
-                    "SILI set\n");
-                }
-            else {
-                sim_debug (SCSI_DBG_CMD, bus->dptr,
-                    "SILI not set - check condition\n");
-                scsi_status (bus, STS_CHK, (KEY_OK | KEY_M_ILI), ASC_OK);
-                return;
-                }
-            }
-        else if ((r == MTSE_OK) && (sectsread < sects)) {  /* underlength condition */
-            sim_debug (SCSI_DBG_CMD, bus->dptr,
-                "Underlength\n");
-            if (data[1] & 0x2) {                        /* SILI set */
-                sim_debug (SCSI_DBG_CMD, bus->dptr,
-                    "SILI set\n");
-                }
-            else {
-                sim_debug (SCSI_DBG_CMD, bus->dptr,
-                    "SILI not set - check condition\n");
-                scsi_status_deferred (bus, STS_CHK, (KEY_OK | KEY_M_ILI), ASC_OK);
-                bus->sense_info = (sects - sectsread);
-                }
-            }
-        }
-
-    if (r != MTSE_OK) {
-        sim_debug (SCSI_DBG_CMD, bus->dptr,
-            "Read error, r = %d\n", r);
-        }
-        scsi_tape_status (bus, r);
+    memcpy (&bus->cmd[0], &data[0], 6);                 /* save current cmd */
+    bus->io_count = 0;
+    scsi_io_start (bus, &scsi_read6_tape_done);
+    if (data[1] & 0x1)
+        sim_tape_rdrecf_a (uptr, &bus->buf[0], &bus->io_count, (sects * dev->block_size), &scsi_io_callback);
+    else
+        sim_tape_rdrecf_a (uptr, &bus->buf[0], &bus->io_count, sects, &scsi_io_callback);
+    scsi_io_started (bus);
     }
 else {
     memset (&bus->buf[0], 0, (sects * dev->block_size));
-    sectsread = (sects * dev->block_size);
-    }
-
-if (sectsread > 0) {
-    bus->buf_b = sectsread;
-    scsi_set_phase (bus, SCSI_DATI);                    /* data in phase next */
+    scsi_read6_tape_xfer (bus, (sects * dev->block_size));
     }
-else {
-    bus->buf[bus->buf_b++] = bus->status;               /* status code */
-    scsi_set_phase (bus, SCSI_STS);                     /* status phase next */
-    }
-scsi_set_req (bus);                                     /* request to send data */
 }
 
 /* Command - Read (10 byte command), disk version */
@@ -848,8 +999,7 @@ void scsi_read10_disk (SCSI_BUS *bus, uint8 *data, uint32 len)
 UNIT *uptr = bus->dev[bus->target];
 SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
 t_lba lba;
-t_seccnt sects, sectsread;
-t_stat r;
+t_seccnt sects;
 
 lba = GETL (data, 2);
 sects = GETW (data, 7);
@@ -861,54 +1011,67 @@ if (sects == 0) {                                       /* no data to read */
     return;
     }
 
-if (uptr->flags & UNIT_ATT)
-    r = sim_disk_rdsect (uptr, lba, &bus->buf[0], &sectsread, sects);
+if (uptr->flags & UNIT_ATT) {
+    scsi_io_start (bus, &scsi_read_disk_done);
+    sim_disk_rdsect_a (uptr, lba, &bus->buf[0], &bus->io_count, sects, &scsi_io_callback);
+    scsi_io_started (bus);
+    }
 else {
     memset (&bus->buf[0], 0, (sects * dev->block_size));
-    sectsread = sects;
+    bus->io_count = sects;
+    scsi_read_disk_done (bus, SCPE_OK);
     }
-
-bus->buf_b = (sectsread * dev->block_size);
-scsi_set_phase (bus, SCSI_DATI);                        /* data in phase next */
-scsi_set_req (bus);                                     /* request to send data */
 }
 
 /* Command - Read Long */
 /* This command is needed by VMS for host-based volume shadowing */
 /* See DKDRIVER */
 
+void scsi_read_long_done (SCSI_BUS *bus, t_stat r)
+{
+bus->buf_b = GETW (bus->cmd, 7);
+memset (&bus->cmd[0], 0, 10);                           /* clear current cmd */
+scsi_set_phase (bus, SCSI_DATI);                        /* data in phase next */
+scsi_set_req (bus);                                     /* request to send data */
+}
+
 void scsi_read_long (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 UNIT *uptr = bus->dev[bus->target];
 t_lba lba;
-t_seccnt sects, sectsread;
-t_stat r;
+t_seccnt sects;
 
 lba = GETL (data, 2);
 sects = GETW (data, 7);
 
 sim_debug (SCSI_DBG_CMD, bus->dptr, "Read Long lba %d bytes %d\n", lba, sects);
 
-if (uptr->flags & UNIT_ATT)
-    r = sim_disk_rdsect (uptr, lba, &bus->buf[0], &sectsread, ((sects >> 9) + 1));
+memcpy (&bus->cmd[0], &data[0], 10);                    /* save current cmd */
+if (uptr->flags & UNIT_ATT) {
+    scsi_io_start (bus, &scsi_read_long_done);
+    sim_disk_rdsect_a (uptr, lba, &bus->buf[0], &bus->io_count, ((sects >> 9) + 1), &scsi_io_callback);
+    scsi_io_started (bus);
+    }
 else {
     memset (&bus->buf[0], 0, sects);
+    scsi_read_long_done (bus, SCPE_OK);
     }
-
-bus->buf_b = sects;
-scsi_set_phase (bus, SCSI_DATI);                        /* data in phase next */
-scsi_set_req (bus);                                     /* request to send data */
 }
 
 /* Command - Write (6 byte command), disk version */
 
+void scsi_write_disk_done (SCSI_BUS *bus, t_stat r)
+{
+memset (&bus->cmd[0], 0, 10);
+scsi_status (bus, STS_OK, KEY_OK, ASC_OK);
+}
+
 void scsi_write6_disk (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 UNIT *uptr = bus->dev[bus->target];
 SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
 t_lba lba;
-t_seccnt sects, sectswritten;
-t_stat r;
+t_seccnt sects;
 
 if (bus->phase == SCSI_CMD) {
     sim_debug (SCSI_DBG_CMD, bus->dptr, "Write(6) - CMD\n");
@@ -925,22 +1088,32 @@ else if (bus->phase == SCSI_DATO) {
     lba = GETW (bus->cmd, 2) | ((bus->cmd[1] & 0x1F) << 16);
     sim_debug (SCSI_DBG_CMD, bus->dptr, "Write(6) - DATO, lba %d bytes %d\n", lba, sects);
 
-    if (uptr->flags & UNIT_ATT)
-        r = sim_disk_wrsect (uptr, lba, &bus->buf[0], &sectswritten, sects);
-
-    memset (&bus->cmd[0], 0, 10);
-    scsi_status (bus, STS_OK, KEY_OK, ASC_OK);
+    if (uptr->flags & UNIT_ATT) {
+        scsi_io_start (bus, &scsi_write_disk_done);
+        sim_disk_wrsect_a (uptr, lba, &bus->buf[0], &bus->io_count, sects, &scsi_io_callback);
+        scsi_io_started (bus);
+        }
+    else
+        scsi_write_disk_done (bus, SCPE_OK);
     }
 }
 
 /* Command - Write (6 byte command), tape version */
 
+void scsi_write6_tape_done (SCSI_BUS *bus, t_stat r)
+{
+sim_debug (SCSI_DBG_CMD, bus->dptr,
+    "Write(6) - DATO, r = %d\n", r);
+scsi_tape_status (bus, r);                              /* translate status */
+memset (&bus->cmd[0], 0, 10);                           /* clear current cmd */
+scsi_status (bus, bus->status, bus->sense_key, bus->sense_code);
+}
+
 void scsi_write6_tape (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 UNIT *uptr = bus->dev[bus->target];
 SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
 t_seccnt sects;
-t_stat r;
 
 if (bus->phase == SCSI_CMD) {
     sim_debug (SCSI_DBG_CMD, bus->dptr,
@@ -961,16 +1134,15 @@ else if (bus->phase == SCSI_DATO) {
         "Write(6) - DATO, bytes %d\n", sects);
 
     if (uptr->flags & UNIT_ATT) {
-        r = sim_tape_wrrecf (uptr, &bus->buf[0], sects);
-        sim_debug (SCSI_DBG_CMD, bus->dptr,
-            "Write(6) - DATO, r = %d\n", r);
-        scsi_tape_status (bus, r);                      /* translate status */
+        scsi_io_start (bus, &scsi_write6_tape_done);
+        sim_tape_wrrecf_a (uptr, &bus->buf[0], sects, &scsi_io_callback);
+        scsi_io_started (bus);
         }
-    else
+    else {
         scsi_status_deferred (bus, STS_OK, KEY_OK, ASC_OK);
-
-    memset (&bus->cmd[0], 0, 10);                       /* clear current cmd */
-    scsi_status (bus, bus->status, bus->sense_key, bus->sense_code);
+        memset (&bus->cmd[0], 0, 10);                   /* clear current cmd */
+        scsi_status (bus, bus->status, bus->sense_key, bus->sense_code);
+        }
     }
 }
 
@@ -981,8 +1153,7 @@ void scsi_write10_disk (SCSI_BUS *bus, uint8 *data, uint32 len)
 UNIT *uptr = bus->dev[bus->target];
 SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
 t_lba lba;
-t_seccnt sects, sectswritten;
-t_stat r;
+t_seccnt sects;
 
 if (bus->phase == SCSI_CMD) {
     sim_debug (SCSI_DBG_CMD, bus->dptr, "Write(10) - CMD\n");
@@ -1001,11 +1172,13 @@ else if (bus->phase == SCSI_DATO) {
     lba = GETL (bus->cmd, 2);
     sim_debug (SCSI_DBG_CMD, bus->dptr, "Write(10) - DATO, lba %d bytes %d\n", lba, sects);
 
-    if (uptr->flags & UNIT_ATT)
-        r = sim_disk_wrsect (uptr, lba, &bus->buf[0], &sectswritten, sects);
-
-    memset (&bus->cmd[0], 0, 10);
-    scsi_status (bus, STS_OK, KEY_OK, ASC_OK);
+    if (uptr->flags & UNIT_ATT) {
+        scsi_io_start (bus, &scsi_write_disk_done);
+        sim_disk_wrsect_a (uptr, lba, &bus->buf[0], &bus->io_count, sects, &scsi_io_callback);
+        scsi_io_started (bus);
+        }
+    else
+        scsi_write_disk_done (bus, SCPE_OK);
     }
 }
 
@@ -1015,17 +1188,21 @@ void scsi_erase (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 UNIT *uptr = bus->dev[bus->target];
 SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
-t_stat r;
 
 sim_debug (SCSI_DBG_CMD, bus->dptr, "Erase\n");
 
-if (data[1] & 0x1)                                      /* LONG bit set? */
-    r = sim_tape_wreom (uptr);                          /* erase to EOT */
+if (uptr->flags & UNIT_ATT) {
+    scsi_io_start (bus, &scsi_tape_done);
+    if (data[1] & 0x1)                                  /* LONG bit set? */
+        sim_tape_wreom_a (uptr, &scsi_io_callback);     /* erase to EOT */
+    else
+        sim_tape_wrgap_a (uptr, dev->gaplen, &scsi_io_callback); /* write gap */
+    scsi_io_started (bus);
+    }
+else if (data[1] & 0x1)                                 /* LONG bit set? */
+    scsi_tape_done (bus, sim_tape_wreom (uptr));        /* erase to EOT */
 else
-    r = sim_tape_wrgap (uptr, dev->gaplen);             /* write gap */
-
-scsi_tape_status (bus, r);
-scsi_status (bus, bus->status, bus->sense_key, bus->sense_code);
+    scsi_tape_done (bus, sim_tape_wrgap (uptr, dev->gaplen)); /* write gap */
 }
 
 /* Command - Reserve Unit */
@@ -1049,14 +1226,16 @@ scsi_status (bus, STS_OK, KEY_OK, ASC_OK);              /* GOOD status */
 void scsi_rewind (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 UNIT *uptr = bus->dev[bus->target];
-t_stat r;
 
 sim_debug (SCSI_DBG_CMD, bus->dptr, "Rewind\n");
 
-r = sim_tape_rewind (uptr);
-
-scsi_tape_status (bus, r);
-scsi_status (bus, bus->status, bus->sense_key, bus->sense_code);
+if (uptr->flags & UNIT_ATT) {
+    scsi_io_start (bus, &scsi_tape_done);
+    sim_tape_rewind_a (uptr, &scsi_io_callback);
+    scsi_io_started (bus);
+    }
+else
+    scsi_tape_done (bus, sim_tape_rewind (uptr));
 }
 
 /* Command - Send Diagnostic */
@@ -1076,44 +1255,89 @@ else
 void scsi_space (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 UNIT *uptr = bus->dev[bus->target];
-uint32 code, skipped;
+uint32 code;
 t_seccnt sects;
-t_stat r;
+t_stat r = MTSE_OK;
 
 code = data[1] & 0x7;
 sects = GETW (data, 3) | (data[2] << 16);
 
 sim_debug (SCSI_DBG_CMD, bus->dptr, "Space %d %s\n", sects, ((code == 0) ? "records" : "files"));
 
+if ((uptr->flags & UNIT_ATT) && (code <= 1)) {
+    scsi_io_start (bus, &scsi_tape_sts_done);
+    if (sects & 0x800000) {                             /* reverse */
+        sects = 0x1000000 - sects;
+        if (code == 0)                                  /* blocks */
+            sim_tape_sprecsr_a (uptr, sects, &bus->io_count, &scsi_io_callback);
+        else                                            /* filemarks */
+            sim_tape_spfiler_a (uptr, sects, &bus->io_count, &scsi_io_callback);
+        }
+    else if (code == 0)                                 /* blocks forwards */
+        sim_tape_sprecsf_a (uptr, sects, &bus->io_count, &scsi_io_callback);
+    else                                                /* filemarks forwards */
+        sim_tape_spfilef_a (uptr, sects, &bus->io_count, &scsi_io_callback);
+    scsi_io_started (bus);
+    return;
+    }
+
 switch (code) {
 
     case 0:                                             /* blocks */
         if (sects & 0x800000) {                         /* reverse */
             sects = 0x1000000 - sects;
-            r = sim_tape_sprecsr (uptr, sects, &skipped);
+            r = sim_tape_sprecsr (uptr, sects, &bus->io_count);
             }
         else                                            /* forwards */
-            r = sim_tape_sprecsf (uptr, sects, &skipped);
+            r = sim_tape_sprecsf (uptr, sects, &bus->io_count);
         break;
 
     case 1:                                             /* filemarks */
         if (sects & 0x800000) {                         /* reverse */
             sects = 0x1000000 - sects;
-            r = sim_tape_spfiler (uptr, sects, &skipped);
+            r = sim_tape_spfiler (uptr, sects, &bus->io_count);
             }
         else                                            /* forwards */
-            r = sim_tape_spfilef (uptr, sects, &skipped);
+            r = sim_tape_spfilef (uptr, sects, &bus->io_count);
         break;
         }
 
-scsi_tape_status (bus, r);
-bus->buf[bus->buf_b++] = bus->status;                   /* status code */
-scsi_set_phase (bus, SCSI_STS);                         /* status phase next */
-scsi_set_req (bus);                                     /* request to send data */
+scsi_tape_sts_done (bus, r);
 }
 
 /* Command - Write Filemarks */
 
+/* Filemarks which complete immediately are handled by the loop below
+   rather than by recursing once per mark; only a completion delivered
+   later by the I/O thread re-enters here to continue the loop. */
+
+void scsi_wrfmark_done (SCSI_BUS *bus, t_stat r)
+{
+UNIT *uptr = bus->dev[bus->target];
+t_seccnt sects;
+
+if (bus->io_loop) {                                     /* completed inside loop? */
+    bus->io_loop = FALSE;
+    bus->io_status = r;                                 /* let the loop continue */
+    return;
+    }
+sects = GETW (bus->cmd, 3) | (bus->cmd[2] << 16);
+
+while ((r == MTSE_OK) && (++bus->io_count < sects)) {   /* more to write? */
+    scsi_io_start (bus, &scsi_wrfmark_done);
+    bus->io_loop = TRUE;
+    sim_tape_wrtmk_a (uptr, &scsi_io_callback);
+    if (bus->io_loop) {                                 /* not complete yet? */
+        bus->io_loop = FALSE;
+        scsi_io_started (bus);
+        return;
+        }
+    r = bus->io_status;
+    }
+memset (&bus->cmd[0], 0, 10);                           /* clear current cmd */
+scsi_tape_sts_done (bus, r);
+}
+
 void scsi_wrfmark (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 UNIT *uptr = bus->dev[bus->target];
@@ -1125,15 +1349,22 @@ sim_debug (SCSI_DBG_CMD, bus->dptr, "Write Filemarks\n");
 
 sects = GETW (data, 3) | (data[2] << 16);
 
+if ((uptr->flags & UNIT_ATT) && (sects > 0)) {
+    memcpy (&bus->cmd[0], &data[0], 6);                 /* save current cmd */
+    bus->io_count = 0;
+    scsi_io_start (bus, &scsi_wrfmark_done);
+    sim_tape_wrtmk_a (uptr, &scsi_io_callback);
+    scsi_io_started (bus);
+    return;
+    }
+
+r = MTSE_OK;
 for (i = 0; i < sects; i++) {
     r = sim_tape_wrtmk (uptr);
     if (r != MTSE_OK) break;
     }
-    
-scsi_tape_status (bus, r);
-bus->buf[bus->buf_b++] = bus->status;                   /* status code */
-scsi_set_phase (bus, SCSI_STS);                         /* status phase next */
-scsi_set_req (bus);                                     /* request to send data */
+
+scsi_tape_sts_done (bus, r);
 }
 
 /* Command - Read Block Limits */
@@ -1484,6 +1715,8 @@ uint32 left = len;
 uint32 bc;
 uint8 *buf;
 
+if (scsi_busy (bus))                                    /* target busy? */
+    return 0;
 scsi_release_req (bus);                                 /* assume done */
 for (buf = data; left > 0; buf += bc, left -= bc) {
     switch (bus->phase) {
@@ -1503,6 +1736,8 @@ for (buf = data; left > 0; buf += bc, left -= bc) {
         scsi_set_req (bus);                             /* request more */
         return (len - left);
         }
+    if (scsi_busy (bus))                                /* command in progress? */
+        return (len - left + bc);                       /* wait for completion */
     }
 switch (bus->phase) {                                   /* new phase */
     case SCSI_DATI:                                     /* data in */
@@ -1523,6 +1758,8 @@ uint32 scsi_read (SCSI_BUS *bus, uint8 *data, uint32 len)
 {
 uint32 i;
 
+if (scsi_busy (bus))                                    /* target busy? */
+    return 0;
 if (len == 0) {
     *data = bus->buf[bus->buf_t];
     return 0;
@@ -1606,6 +1843,7 @@ switch (dev->devtype) {
 void scsi_reset (SCSI_BUS *bus)
 {
 sim_debug (SCSI_DBG_BUS, bus->dptr, "Bus reset\n");
+scsi_io_wait (bus, TRUE);                               /* abandon transfer */
 bus->phase = SCSI_DATO;
 bus->buf_t = bus->buf_b = 0;
 bus->atn = FALSE;
@@ -1624,6 +1862,14 @@ bus->sense_info = 0;
 
 t_stat scsi_init (SCSI_BUS *bus, uint32 maxfr)
 {
+uint32 i;
+
+for (i = 0; i < SCSI_MAX_BUS; i++) {                    /* register bus */
+    if ((scsi_buses[i] == NULL) || (scsi_buses[i] == bus)) {
+        scsi_buses[i] = bus;
+        break;
+        }
+    }
 if (bus->buf == NULL)
     bus->buf = (uint8 *)calloc (maxfr, sizeof(uint8));
 if (bus->buf == NULL)
@@ -1713,9 +1959,14 @@ switch (dev->devtype) {
 t_stat scsi_detach (UNIT *uptr)
 {
 SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
+SCSI_BUS *bus = scsi_io_bus (uptr);
 
 if (dev == NULL)
     return SCPE_NOFNC;
+while (bus != NULL) {                                   /* transfer in progress? */
+    scsi_io_wait (bus, FALSE);                          /* let it finish */
+    bus = scsi_io_bus (uptr);
+    }
 
 switch (dev->devtype) {
     case SCSI_DISK:
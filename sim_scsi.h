@@ -105,6 +105,13 @@ struct scsi_bus_t {
     uint32 sense_code;
     uint32 sense_qual;
     uint32 sense_info;
+    void (*ready)(struct scsi_bus_t *bus);              /* target ready routine */
+    void (*io_done)(struct scsi_bus_t *bus, t_stat r);  /* transfer completion */
+    int32 io_target;                                    /* target with transfer */
+    t_bool io_async;                                    /* transfer on I/O thread */
+    uint32 io_count;                                    /* transfer count */
+    t_bool io_loop;                                     /* completion caught by loop */
+    t_stat io_status;                                   /* caught completion status */
 };
 
 typedef struct scsi_bus_t SCSI_BUS;
@@ -115,6 +122,7 @@ void scsi_release (SCSI_BUS *bus);
 void scsi_set_atn (SCSI_BUS *bus);
 void scsi_release_atn (SCSI_BUS *bus);
 t_bool scsi_select (SCSI_BUS *bus, uint32 target);
+t_bool scsi_busy (SCSI_BUS *bus);
 uint32 scsi_write (SCSI_BUS *bus, uint8 *data, uint32 len);
 uint32 scsi_read (SCSI_BUS *bus, uint8 *data, uint32 len);
 uint32 scsi_state (SCSI_BUS *bus, uint32 id);
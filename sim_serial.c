@@ -1308,6 +1308,18 @@ return SCPE_OK;
 }
 
 
+/* Return the file descriptor of a serial port.
+
+   This lets the asynchronous multiplexer poll thread wait on serial ports
+   together with network sockets.
+*/
+
+int sim_serial_fd (SERHANDLE port)
+{
+return port->port;
+}
+
+
 /* Read from a serial port.
 
    The port is checked for available characters.  If any are present, they are
@@ -100,22 +100,54 @@
 #include <pthread.h>
 #endif
 
+/* Data transfer totals across all tape units (reported by BENCHMARK) */
+
+static t_uint64 tape_bytes_read = 0;
+static t_uint64 tape_bytes_written = 0;
+#if defined SIM_ASYNCH_IO
+static pthread_mutex_t tape_totals_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void sim_tape_count (t_uint64 *total, t_mtrlnt bc)
+{
+#if defined SIM_ASYNCH_IO
+pthread_mutex_lock (&tape_totals_lock);
+#endif
+*total += bc;
+#if defined SIM_ASYNCH_IO
+pthread_mutex_unlock (&tape_totals_lock);
+#endif
+}
+
+void sim_tape_data_totals (t_uint64 *bytes_read, t_uint64 *bytes_written)
+{
+#if defined SIM_ASYNCH_IO
+pthread_mutex_lock (&tape_totals_lock);
+#endif
+*bytes_read = tape_bytes_read;
+*bytes_written = tape_bytes_written;
+#if defined SIM_ASYNCH_IO
+pthread_mutex_unlock (&tape_totals_lock);
+#endif
+}
+
 static struct sim_tape_fmt {
     const char          *name;                          /* name */
     int32               uflags;                         /* unit flags */
     t_addr              bot;                            /* bot test */
     t_addr              eom_remnant;                    /* potentially unprocessed data */
+    int32               rechdr;                         /* bytes before record data, -1 if not indexed */
     } fmts[] = {
-    { "SIMH",       0,       sizeof (t_mtrlnt) - 1, sizeof (t_mtrlnt) },
-    { "E11",        0,       sizeof (t_mtrlnt) - 1, sizeof (t_mtrlnt) },
-    { "TPC",        UNIT_RO, sizeof (t_tpclnt) - 1, sizeof (t_tpclnt) },
-    { "P7B",        0,       0,                     0                 },
-    { "AWS",        0,       0,                     0                 },
-    { "TAR",        UNIT_RO, 0,                     0                 },
-    { "ANSI",       UNIT_RO, 0,                     0                 },
-    { "FIXED",      UNIT_RO, 0,                     0                 },
-    { "DOS11",      UNIT_RO, 0,                     0                 },
-    { NULL,         0,       0,                     0                 }
+    { "SIMH",       0,       sizeof (t_mtrlnt) - 1, sizeof (t_mtrlnt), sizeof (t_mtrlnt) },
+    { "E11",        0,       sizeof (t_mtrlnt) - 1, sizeof (t_mtrlnt), sizeof (t_mtrlnt) },
+    { "TPC",        UNIT_RO, sizeof (t_tpclnt) - 1, sizeof (t_tpclnt), sizeof (t_tpclnt) },
+    { "P7B",        0,       0,                     0,                 0                 },
+    { "AWS",        0,       0,                     0,                 sizeof (t_awshdr) },
+    { "TAR",        UNIT_RO, 0,                     0,                 -1                },
+    { "ANSI",       UNIT_RO, 0,                     0,                 -1                },
+    { "FIXED",      UNIT_RO, 0,                     0,                 -1                },
+    { "DOS11",      UNIT_RO, 0,                     0,                 -1                },
+    { NULL,         0,       0,                     0,                 -1                }
     };
 
 static const uint32 bpi [] = {                          /* tape density table, indexed by MT_DENS constants */
@@ -134,15 +166,40 @@ static t_stat sim_tape_wrdata (UNIT *uptr, uint32 dat);
 static t_stat sim_tape_aws_wrdata (UNIT *uptr, uint8 *buf, t_mtrlnt bc);
 static uint32 sim_tape_tpc_map (UNIT *uptr, t_addr *map, uint32 mapsize);
 static t_stat sim_tape_validate_tape (UNIT *uptr);
+static void sim_tape_idx_free (UNIT *uptr);
 static t_addr sim_tape_tpc_fnd (UNIT *uptr, t_addr *map);
 static void sim_tape_data_trace (UNIT *uptr, const uint8 *data, size_t len, const char* txt, int detail, uint32 reason);
 static t_stat tape_erase_fwd (UNIT *uptr, t_mtrlnt gap_size);
 static t_stat tape_erase_rev (UNIT *uptr, t_mtrlnt gap_size);
 
+/* Object index
+
+   For the on-disk formats with self-describing records (SIMH, E11, TPC,
+   P7B and AWS) the start of every record and tape mark is kept in a
+   table as the image is validated at attach time, together with its
+   record length and the number of tape marks before it.  Entry
+   index_count is a sentinel holding the end of the last indexed object.
+   Reads and record spacing from an indexed position then need no
+   metadata I/O, and file spacing is a binary search on the tape mark
+   counts.  Anything beyond the sentinel (a gap, a bad record, or what
+   is left after a write in mid tape) goes through the format routines
+   as before.  Every write truncates the index at the position written
+   and records and tape marks written at the sentinel are appended.
+*/
+
+typedef struct {
+    t_addr              pos;                /* start of object */
+    t_mtrlnt            bc;                 /* record length (0 for a tape mark) */
+    uint32              tmks;               /* tape marks before this object */
+    } TAPE_OBJECT;
+
 struct tape_context {
     DEVICE              *dptr;              /* Device for unit (access to debug flags) */
     uint32              dbit;               /* debugging bit for trace */
     uint32              auto_format;        /* Format determined dynamically */
+    TAPE_OBJECT         *index;             /* object index (NULL if none) */
+    uint32              index_count;        /* objects indexed */
+    uint32              index_size;         /* entries allocated */
 #if defined SIM_ASYNCH_IO
     t_bool              asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
@@ -979,6 +1036,7 @@ if (ctx)
     auto_format = ctx->auto_format;
 
 sim_tape_clr_async (uptr);
+sim_tape_idx_free (uptr);
 
 MT_CLR_INMRK (uptr);                                    /* Not within a TAR tapemark */
 if (MT_GET_FMT (uptr) >= MTUF_F_ANSI) {
@@ -1108,6 +1166,135 @@ if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
 return uptr->tape_eom;                   /* Virtual tape images: record/TM count */
 }
 
+/* Object index routines */
+
+static void sim_tape_idx_free (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx == NULL)
+    return;
+free (ctx->index);
+ctx->index = NULL;
+ctx->index_count = ctx->index_size = 0;
+}
+
+/* Find the index entry starting at pos (the sentinel included), or -1 */
+
+static int32 sim_tape_idx_find (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 lo, hi, mid;
+
+if ((ctx == NULL) || (ctx->index == NULL) ||
+    (pos > ctx->index[ctx->index_count].pos))
+    return -1;
+lo = 0;
+hi = ctx->index_count;
+while (lo < hi) {
+    mid = (lo + hi) >> 1;
+    if (ctx->index[mid].pos < pos)
+        lo = mid + 1;
+    else
+        hi = mid;
+    }
+return (ctx->index[lo].pos == pos) ? (int32)lo : -1;
+}
+
+/* Find the first entry at or after lo with at least tmks tape marks before it,
+   or index_count + 1 if there is none */
+
+static uint32 sim_tape_idx_tmk (struct tape_context *ctx, uint32 lo, uint32 tmks)
+{
+uint32 hi = ctx->index_count + 1;
+uint32 mid;
+
+while (lo < hi) {
+    mid = (lo + hi) >> 1;
+    if (ctx->index[mid].tmks < tmks)
+        lo = mid + 1;
+    else
+        hi = mid;
+    }
+return lo;
+}
+
+/* Drop the index at and beyond a position about to be written */
+
+static void sim_tape_idx_trunc (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+int32 i;
+
+if ((ctx == NULL) || (ctx->index == NULL) ||
+    (pos >= ctx->index[ctx->index_count].pos))          /* beyond the index? */
+    return;
+i = sim_tape_idx_find (uptr, pos);
+if (i < 0)                                              /* inside an object? */
+    sim_tape_idx_free (uptr);                           /*   can't tell what's left */
+else
+    ctx->index_count = (uint32)i;                       /* entry i is now the sentinel */
+}
+
+/* Append an object written (or validated) at the end of the index */
+
+static void sim_tape_idx_add (UNIT *uptr, t_addr pos, t_addr end, t_mtrlnt bc, t_bool tmk)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+TAPE_OBJECT *op;
+
+if ((ctx == NULL) || (ctx->index == NULL) ||
+    (pos != ctx->index[ctx->index_count].pos))          /* not contiguous? */
+    return;
+if (ctx->index_count + 1 == ctx->index_size) {          /* full? */
+    op = (TAPE_OBJECT *)realloc (ctx->index, 2 * ctx->index_size * sizeof (*op));
+    if (op == NULL) {
+        sim_tape_idx_free (uptr);
+        return;
+        }
+    ctx->index = op;
+    ctx->index_size = 2 * ctx->index_size;
+    }
+op = &ctx->index[ctx->index_count++];
+op->bc = tmk ? 0 : bc;
+op[1].pos = end;                                        /* new sentinel */
+op[1].tmks = op->tmks + (tmk ? 1 : 0);
+op[1].bc = 0;
+}
+
+/* Return the indexed object starting at pos, or NULL */
+
+static TAPE_OBJECT *sim_tape_idx_next (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+int32 i = sim_tape_idx_find (uptr, pos);
+
+if ((i < 0) || ((uint32)i == ctx->index_count))        /* unknown or at the sentinel? */
+    return NULL;
+return &ctx->index[i];
+}
+
+/* Return the indexed object ending at pos, or NULL
+
+   An AWS record read in reverse from the end of the medium is reported as
+   a tape mark by sim_tape_rdlntr, so that case is left to it.
+*/
+
+static TAPE_OBJECT *sim_tape_idx_prev (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+int32 i = sim_tape_idx_find (uptr, pos);
+
+if (i <= 0)                                             /* unknown or at BOT? */
+    return NULL;
+if ((MT_GET_FMT (uptr) == MTUF_F_AWS) &&
+    (uptr->tape_eom > 0) && (pos >= uptr->tape_eom))    /* AWS at EOM? */
+    return NULL;
+return &ctx->index[i - 1];
+}
+
+#define IDX_TMK(op)     ((op)[1].tmks != (op)->tmks)    /* object is a tape mark */
+
 /* Read record length forward (internal routine).
 
    Inputs:
@@ -1213,6 +1400,7 @@ t_addr saved_pos;
 uint32   bufcntr, bufcap;                               /* buffer counter and capacity */
 int32    runaway_counter, sizeof_gap;                   /* bytes remaining before runaway and bytes per gap */
 t_stat   status = MTSE_OK;
+TAPE_OBJECT *op;
 
 MT_CLR_PNU (uptr);                                      /* clear the position-not-updated flag */
 *bc = 0;
@@ -1226,6 +1414,20 @@ if ((uptr->tape_eom > 0) &&
     return MTSE_EOM;                                    /*     and quit with I/O error status */
     }
 
+if ((op = sim_tape_idx_next (uptr, uptr->pos))) {       /* if the next object is indexed */
+    if (IDX_TMK (op)) {                                 /*   then if it is a tape mark */
+        uptr->pos = op[1].pos;                          /*     then space over it */
+        return MTSE_TMK;
+        }
+    if (sim_tape_seek (uptr, op->pos + fmts[f].rechdr)) {   /* seek to the record data; if it fails */
+        MT_SET_PNU (uptr);                              /*   then set position not updated */
+        return sim_tape_ioerr (uptr);                   /*     and quit with I/O error status */
+        }
+    *bc = op->bc;                                       /* return the record length */
+    uptr->pos = op[1].pos;                              /*   and space over the record */
+    return MTSE_OK;
+    }
+
 if (sim_tape_seek (uptr, uptr->pos)) {                  /* set the initial tape position; if it fails */
     MT_SET_PNU (uptr);                                  /*   then set position not updated */
     return sim_tape_ioerr (uptr);                       /*     and quit with I/O error status */
@@ -1587,6 +1789,7 @@ t_mtrlnt buffer [256];                                  /* local tape buffer */
 uint32   bufcntr, bufcap;                               /* buffer counter and capacity */
 int32    runaway_counter, sizeof_gap;                   /* bytes remaining before runaway and bytes per gap */
 t_stat   status = MTSE_OK;
+TAPE_OBJECT *op;
 
 MT_CLR_PNU (uptr);                                      /* clear the position-not-updated flag */
 *bc = 0;
@@ -1597,6 +1800,17 @@ if ((uptr->flags & UNIT_ATT) == 0)                      /* if the unit is not at
 if (sim_tape_bot (uptr))                                /* if the unit is positioned at the BOT */
     return MTSE_BOT;                                    /*   then reading backward is not possible */
 
+if ((op = sim_tape_idx_prev (uptr, uptr->pos))) {       /* if the preceding object is indexed */
+    if (sim_tape_seek (uptr, op->pos + fmts[f].rechdr)) /*   then seek to its data; if it fails */
+        return sim_tape_ioerr (uptr);                   /*     then quit with I/O error status */
+    uptr->pos = op->pos;                                /* space back over it */
+    if (f == MTUF_F_P7B)                                /* P7B reports the length */
+        *bc = (t_mtrlnt)(op[1].pos - op->pos);          /*   of tape marks too */
+    else
+        *bc = op->bc;
+    return IDX_TMK (op) ? MTSE_TMK : MTSE_OK;
+    }
+
 switch (f) {                                            /* otherwise the read method depends on the tape format */
 
     case MTUF_F_STD:
@@ -1931,6 +2145,7 @@ for ( ; i < rbc; i++)                                   /* fill with 0's */
 if (f == MTUF_F_P7B)                                    /* p7b? strip SOR */
     buf[0] = buf[0] & P7B_DPAR;
 sim_tape_data_trace(uptr, buf, rbc, "Record Read", (uptr->dctrl | ctx->dptr->dctrl) & MTSE_DBG_DAT, MTSE_DBG_STR);
+sim_tape_count (&tape_bytes_read, rbc);
 return (MTR_F (tbc)? MTSE_RECE: MTSE_OK);
 }
 
@@ -2001,6 +2216,7 @@ for ( ; i < rbc; i++)                                   /* fill with 0's */
 if (f == MTUF_F_P7B)                                    /* p7b? strip SOR */
     buf[0] = buf[0] & P7B_DPAR;
 sim_tape_data_trace(uptr, buf, rbc, "Record Read Reverse", (uptr->dctrl | ctx->dptr->dctrl) & MTSE_DBG_DAT, MTSE_DBG_STR);
+sim_tape_count (&tape_bytes_read, rbc);
 return (MTR_F (tbc)? MTSE_RECE: MTSE_OK);
 }
 
@@ -2034,7 +2250,8 @@ t_stat sim_tape_wrrecf (UNIT *uptr, uint8 *buf, t_mtrlnt bc)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 uint32 f = MT_GET_FMT (uptr);
-t_mtrlnt sbc;
+t_mtrlnt i, sbc;
+t_addr opos;
 t_stat status = MTSE_OK;
 
 if (ctx == NULL)                                        /* if not properly attached? */
@@ -2052,6 +2269,9 @@ if (sbc == 0)                                           /* nothing to do? */
     return MTSE_OK;
 if (sim_tape_seek (uptr, uptr->pos))                    /* set pos */
     return MTSE_IOERR;
+opos = uptr->pos;
+if (f != MTUF_F_AWS)                                    /* AWS indexes its own writes */
+    sim_tape_idx_trunc (uptr, opos);
 switch (f) {                                            /* case on format */
 
     case MTUF_F_STD:                                    /* standard */
@@ -2066,6 +2286,7 @@ switch (f) {                                            /* case on format */
             return sim_tape_ioerr (uptr);
             }
         uptr->pos = uptr->pos + sbc + (2 * sizeof (t_mtrlnt));  /* move tape */
+        sim_tape_idx_add (uptr, opos, uptr->pos, bc, FALSE);
         break;
 
     case MTUF_F_P7B:                                    /* Pierce 7B */
@@ -2077,6 +2298,8 @@ switch (f) {                                            /* case on format */
             return sim_tape_ioerr (uptr);
             }
         uptr->pos = uptr->pos + sbc;                    /* move tape */
+        for (i = 0; (i < sbc) && ((buf[i] & P7B_DPAR) == P7B_EOF); i++) ;
+        sim_tape_idx_add (uptr, opos, uptr->pos, sbc, (i == sbc));/* all EOF is a tape mark */
         break;
     case MTUF_F_AWS:                                    /* AWS */
         status = sim_tape_aws_wrdata (uptr, buf, bc);
@@ -2087,6 +2310,7 @@ switch (f) {                                            /* case on format */
 if (uptr->pos > uptr->tape_eom)
     uptr->tape_eom = uptr->pos;         /* update EOM as needed */
 sim_tape_data_trace(uptr, buf, sbc, "Record Written", (uptr->dctrl | ctx->dptr->dctrl) & MTSE_DBG_DAT, MTSE_DBG_STR);
+sim_tape_count (&tape_bytes_written, sbc);
 return MTSE_OK;
 }
 
@@ -2106,6 +2330,7 @@ static t_stat sim_tape_aws_wrdata (UNIT *uptr, uint8 *buf, t_mtrlnt bc)
 t_awshdr awshdr;
 size_t   rdcnt;
 t_bool   replacing_record;
+t_addr   opos;
 
 memset (&awshdr, 0, sizeof (t_awshdr));
 if (sim_tape_seek (uptr, uptr->pos))        /* set pos */
@@ -2123,6 +2348,8 @@ if ((!sim_tape_bot (uptr)) &&
     }
 if (sim_tape_seek (uptr, uptr->pos))        /* set pos */
     return MTSE_IOERR;
+opos = uptr->pos;
+sim_tape_idx_trunc (uptr, opos);
 replacing_record = (awshdr.nxtlen == (t_awslnt)bc) && (awshdr.rectyp == (bc ? AWS_REC : AWS_TMK));
 awshdr.nxtlen = (t_awslnt)bc;
 awshdr.rectyp = (bc) ? AWS_REC : AWS_TMK;
@@ -2138,6 +2365,7 @@ if ((!replacing_record) || (bc == 0)) {
     if (!replacing_record)
         sim_set_fsize (uptr->fileref, uptr->pos + sizeof (awshdr));
     }
+sim_tape_idx_add (uptr, opos, uptr->pos, bc, (bc == 0));
 if (uptr->pos > uptr->tape_eom)
     uptr->tape_eom = uptr->pos;                     /* Update EOM if we're there */
 return MTSE_OK;
@@ -2156,6 +2384,7 @@ if (ctx == NULL)                                        /* if not properly attac
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
+sim_tape_idx_trunc (uptr, uptr->pos);
 (void)sim_tape_seek (uptr, uptr->pos);                  /* set pos */
 (void)sim_fwrite (&dat, sizeof (t_mtrlnt), 1, uptr->fileref);
 if (ferror (uptr->fileref)) {                           /* error? */
@@ -2174,6 +2403,8 @@ return MTSE_OK;
 t_stat sim_tape_wrtmk (UNIT *uptr)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+t_addr opos = uptr->pos;
+t_stat r;
 
 if (ctx == NULL)                                        /* if not properly attached? */
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
@@ -2184,7 +2415,10 @@ if (MT_GET_FMT (uptr) == MTUF_F_P7B) {                  /* P7B? */
     }
 if (MT_GET_FMT (uptr) == MTUF_F_AWS)                    /* AWS? */
     return sim_tape_aws_wrdata (uptr, NULL, 0);
-return sim_tape_wrdata (uptr, MTR_TMK);
+r = sim_tape_wrdata (uptr, MTR_TMK);
+if (r == MTSE_OK)
+    sim_tape_idx_add (uptr, opos, uptr->pos, 0, TRUE);
+return r;
 }
 
 t_stat sim_tape_wrtmk_a (UNIT *uptr, TAPE_PCALLBACK callback)
@@ -2211,6 +2445,7 @@ if (sim_tape_wrp (uptr))                                /* write prot? */
 if (MT_GET_FMT (uptr) == MTUF_F_P7B)                    /* cant do P7B */
     return MTSE_FMT;
 if (MT_GET_FMT (uptr) == MTUF_F_AWS) {
+    sim_tape_idx_trunc (uptr, uptr->pos);
     sim_set_fsize (uptr->fileref, uptr->pos);
     result = MTSE_OK;
     }
@@ -2598,6 +2833,7 @@ if (gap_size == meta_size) {                            /* if the request is for
 
         else {                                              /*   otherwise */
             metadatum = MTR_GAP;                            /*     replace it with an erase gap marker */
+            sim_tape_idx_trunc (uptr, uptr->pos);
 
             xfer = sim_fwrite (&metadatum, meta_size,   /* write the gap marker */
                                1, uptr->fileref);
@@ -2810,12 +3046,33 @@ t_stat sim_tape_sprecsf (UNIT *uptr, uint32 count, uint32 *skipped)
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 t_stat st;
 t_mtrlnt tbc;
+int32 i;
+uint32 k, n;
 
 if (ctx == NULL)                                        /* if not properly attached? */
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 sim_debug_unit (ctx->dbit, uptr, "sim_tape_sprecsf(unit=%d, count=%d)\n", (int)(uptr-ctx->dptr->units), count);
 
 *skipped = 0;
+i = sim_tape_idx_find (uptr, uptr->pos);
+if ((count > 0) && (i >= 0) && ((uint32)i < ctx->index_count)) {    /* indexed? */
+    k = sim_tape_idx_tmk (ctx, i + 1, ctx->index[i].tmks + 1);      /* object after the next tape mark */
+    n = ((k <= ctx->index_count) ? k - 1 : ctx->index_count) - i;   /* records before it */
+    if (n > count)
+        n = count;
+    *skipped = n;
+    st = MTSE_OK;
+    if ((n < count) && (k <= ctx->index_count)) {       /* stopped by a tape mark? */
+        n = n + 1;                                      /*   space over it too */
+        st = MTSE_TMK;
+        }
+    MT_CLR_PNU (uptr);
+    uptr->pos = ctx->index[i + n].pos;
+    (void)sim_tape_seek (uptr, uptr->pos);
+    sim_debug_unit (MTSE_DBG_STR, uptr, "sprecsf: indexed, skipped: %u, st: %d, pos: %" T_ADDR_FMT "u\n", *skipped, st, uptr->pos);
+    if ((st != MTSE_OK) || (*skipped == count))
+        return st;
+    }
 while (*skipped < count) {                              /* loopo */
     st = sim_tape_sprecf (uptr, &tbc);                  /* spc rec */
     if (st != MTSE_OK)
@@ -2906,12 +3163,34 @@ t_stat sim_tape_sprecsr (UNIT *uptr, uint32 count, uint32 *skipped)
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 t_stat st;
 t_mtrlnt tbc;
+int32 i;
+uint32 k, n;
 
 if (ctx == NULL)                                        /* if not properly attached? */
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 sim_debug_unit (ctx->dbit, uptr, "sim_tape_sprecsr(unit=%d, count=%d)\n", (int)(uptr-ctx->dptr->units), count);
 
 *skipped = 0;
+i = sim_tape_idx_find (uptr, uptr->pos);
+if ((count > 0) && !MT_TST_PNU (uptr) &&
+    sim_tape_idx_prev (uptr, uptr->pos)) {              /* indexed? */
+    k = (ctx->index[i].tmks > 0) ?                      /* object after the preceding tape mark */
+        sim_tape_idx_tmk (ctx, 0, ctx->index[i].tmks) : 0;
+    n = i - k;                                          /* records after it */
+    if (n > count)
+        n = count;
+    *skipped = n;
+    st = MTSE_OK;
+    if ((n < count) && (k > 0)) {                       /* stopped by a tape mark? */
+        n = n + 1;                                      /*   space back over it too */
+        st = MTSE_TMK;
+        }
+    uptr->pos = ctx->index[i - n].pos;
+    (void)sim_tape_seek (uptr, uptr->pos);
+    sim_debug_unit (MTSE_DBG_STR, uptr, "sprecsr: indexed, skipped: %u, st: %d, pos: %" T_ADDR_FMT "u\n", *skipped, st, uptr->pos);
+    if ((st != MTSE_OK) || (*skipped == count))
+        return st;
+    }
 while (*skipped < count) {                              /* loopo */
     st = sim_tape_sprecr (uptr, &tbc);                  /* spc rec rev */
     if (st != MTSE_OK)
@@ -3491,6 +3770,14 @@ if (rec_sizes == NULL) {
     return SCPE_MEM;
     }
 
+sim_tape_idx_free (uptr);
+if (fmts[MT_GET_FMT (uptr)].rechdr >= 0) {              /* format can be indexed? */
+    struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+    ctx->index = (TAPE_OBJECT *)calloc (256, sizeof (*ctx->index));
+    if (ctx->index != NULL)
+        ctx->index_size = 256;                          /* start empty, sentinel at BOT */
+    }
 r = sim_tape_rewind (uptr);
 while (r == SCPE_OK) {
     if (stop_cpu) { /* SIGINT? */
@@ -3559,6 +3846,8 @@ while (r == SCPE_OK) {
             sim_printf ("Unexpected tape file position after forward and skip record: (%" T_ADDR_FMT "u, %" T_ADDR_FMT "u)\n", pos_fa, pos_sa);
             break;
             }
+        if (pos_f == pos_r)                         /* no gap before it? */
+            sim_tape_idx_add (uptr, pos_f, pos_fa, bc_f, (r_f == MTSE_TMK));
         r = SCPE_OK;
         break;
     case MTSE_INVRL:                                /* invalid rec lnt */
@@ -3577,6 +3866,12 @@ while (r == SCPE_OK) {
         }
     }
 uptr->tape_eom = uptr->pos;
+if (((struct tape_context *)uptr->tape_ctx)->index != NULL) {
+    struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+    sim_debug_unit (MTSE_DBG_STR, uptr, "validate: indexed %u objects (%u tape marks) through %" T_ADDR_FMT "u\n",
+                                        ctx->index_count, ctx->index[ctx->index_count].tmks, ctx->index[ctx->index_count].pos);
+    }
 if (!stop_cpu) {            /* if SIGINT didn't interrupt the scan */
     sim_messagef (SCPE_OK, "%s: Tape Image %s'%s' scanned as %s format\n", sim_uname (uptr),
                            ((MT_GET_FMT (uptr) >= MTUF_F_ANSI) ? "made from " : ""), uptr->filename,
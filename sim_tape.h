@@ -234,6 +234,7 @@ t_stat sim_tape_density_supported (char *string, size_t string_size, int32 valid
 t_stat sim_tape_set_asynch (UNIT *uptr, int latency);
 t_stat sim_tape_clr_asynch (UNIT *uptr);
 t_stat sim_tape_test (DEVICE *dptr);
+void sim_tape_data_totals (t_uint64 *bytes_read, t_uint64 *bytes_written);
 t_stat sim_tape_add_debug (DEVICE *dptr);
 
 #ifdef  __cplusplus
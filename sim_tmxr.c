@@ -342,6 +342,22 @@
 
 #include <ctype.h>
 #include <math.h>
+#if defined(SIM_ASYNCH_MUX) && defined(HAVE_EPOLL)
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+/* The asynchronous poll thread rebuilds its descriptor set only when
+   tmxr_poll_gen changes, so every place which opens or closes a listening,
+   connected or serial descriptor (or changes the unit that polls it)
+   calls _tmxr_poll_changed */
+
+#if defined(SIM_ASYNCH_MUX)
+static volatile uint32 tmxr_poll_gen = 0;
+#define _tmxr_poll_changed() ++tmxr_poll_gen
+#else
+#define _tmxr_poll_changed()
+#endif
 
 /* Telnet protocol constants - negatives are for init'ing signed char data */
 
@@ -459,6 +475,73 @@ static void tmxr_add_to_open_list (TMXR* mux);
    indications.
 */
 
+/* Ready lists
+
+   Each mux keeps two intrusive lists of its lines.  The receive list holds
+   the lines with a socket, serial port or loopback attached (the only ones
+   tmxr_poll_rx can read from) and the transmit list holds the lines which
+   have had output queued since they last drained.  Lines join a list when
+   that state is established and are dropped by the poll routines once it
+   no longer holds, so a poll costs time proportional to the active lines
+   rather than to the configured ones.
+
+   Some devices change the number of lines or reallocate the line array, so
+   the lists remember the array they were built for.  When it changes, no
+   line is added until the next poll has rebuilt the lists from scratch.
+*/
+
+#define TMXR_RDY_RX     0                               /* receive ready list */
+#define TMXR_RDY_TX     1                               /* transmit ready list */
+
+static void _tmxr_ready_add (TMLN *lp, int list)
+{
+TMXR *mp = lp->mp;
+
+if ((mp == NULL) ||                                     /* no mux yet, */
+    (lp->rdy_on[list]) ||                               /* already listed */
+    (mp->rdy_ldsc != mp->ldsc) ||                       /* or lists stale? */
+    (mp->rdy_lines != mp->lines))
+    return;                                             /* nothing to do */
+lp->rdy_on[list] = TRUE;
+lp->rdy_prev[list] = NULL;
+lp->rdy_next[list] = mp->rdy_head[list];
+if (mp->rdy_head[list])
+    mp->rdy_head[list]->rdy_prev[list] = lp;
+mp->rdy_head[list] = lp;
+}
+
+static void _tmxr_ready_del (TMXR *mp, TMLN *lp, int list)
+{
+if (lp->rdy_prev[list])
+    lp->rdy_prev[list]->rdy_next[list] = lp->rdy_next[list];
+else
+    mp->rdy_head[list] = lp->rdy_next[list];
+if (lp->rdy_next[list])
+    lp->rdy_next[list]->rdy_prev[list] = lp->rdy_prev[list];
+lp->rdy_next[list] = lp->rdy_prev[list] = NULL;
+lp->rdy_on[list] = FALSE;
+}
+
+static void _tmxr_ready_build (TMXR *mp)
+{
+int32 i;
+TMLN *lp;
+
+mp->rdy_head[TMXR_RDY_RX] = mp->rdy_head[TMXR_RDY_TX] = NULL;
+mp->rdy_ldsc = mp->ldsc;
+mp->rdy_lines = mp->lines;
+for (i = mp->lines - 1; i >= 0; i--) {                  /* build in line order */
+    lp = mp->ldsc + i;
+    if (lp->mp == NULL)
+        lp->mp = mp;
+    lp->rdy_on[TMXR_RDY_RX] = lp->rdy_on[TMXR_RDY_TX] = FALSE;
+    if (lp->sock || lp->serport || lp->loopback)
+        _tmxr_ready_add (lp, TMXR_RDY_RX);
+    if (lp->conn || lp->txbfd)
+        _tmxr_ready_add (lp, TMXR_RDY_TX);
+    }
+}
+
 static void tmxr_init_line (TMLN *lp)
 {
 lp->tsta = 0;                                           /* init telnet state */
@@ -468,6 +551,9 @@ lp->rxbpr = lp->rxbpi = lp->rxcnt = lp->rxpcnt = 0;     /* init receive indexes
 if (!lp->txbfd || lp->notelnet)                         /* if not buffered telnet */
     lp->txbpr = lp->txbpi = lp->txcnt = lp->txpcnt = 0; /*   init transmit indexes */
 lp->txdrp = lp->txstall = 0;
+lp->rxpolls = lp->txpolls = 0;
+if (lp->sock || lp->serport || lp->loopback)            /* something to read from? */
+    _tmxr_ready_add (lp, TMXR_RDY_RX);
 tmxr_set_get_modem_bits (lp, 0, 0, NULL);
 if (lp->mp && (!lp->mp->buffered) && (!lp->txbfd)) {
     lp->txbfd = 0;
@@ -1041,6 +1127,7 @@ if (mp->last_poll_time == 0) {                          /* first poll initializa
                 sim_cancel (mp->ldsc[i].o_uptr);
             }
         }
+    _tmxr_poll_changed ();
     }
 
 if (sim_is_running && 
@@ -1143,6 +1230,7 @@ if (mp->master) {
             lp->conn = TRUE;                            /* record connection */
             lp->sock = newsock;                         /* save socket */
             lp->ipad = address;                         /* ip address */
+            _tmxr_poll_changed ();
             tmxr_init_line (lp);                        /* init line */
             lp->notelnet = mp->notelnet;                /* apply mux default telnet setting */
             lp->nomessage = mp->nomessage;              /* apply mux default telnet setting */
@@ -1198,6 +1286,8 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                             lp->conn = TRUE;                    /* record connection */
                             lp->sock = lp->connecting;          /* it now looks normal */
                             lp->connecting = 0;
+                            _tmxr_poll_changed ();
+                            _tmxr_ready_add (lp, TMXR_RDY_RX);
                             lp->ipad = (char *)realloc (lp->ipad, 1+strlen (lp->destination));
                             strcpy (lp->ipad, lp->destination);
                             lp->cnms = sim_os_msec ();
@@ -1249,6 +1339,7 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                                 tmxr_debug_connect_line (lp, msg);
                                 sim_close_sock (lp->connecting);    /* abort our as yet unconnnected socket */
                                 lp->connecting = 0;
+                                _tmxr_poll_changed ();
                                 }
                             }
                         if (lp->conn == FALSE) {                    /* is the line available? */
@@ -1256,6 +1347,7 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                                 lp->conn = TRUE;                    /* record connection */
                                 lp->sock = newsock;                 /* save socket */
                                 lp->ipad = address;                 /* ip address */
+                                _tmxr_poll_changed ();
                                 tmxr_init_line (lp);                /* init line */
                                 if (!lp->notelnet) {
                                     sim_write_sock (lp->sock, (char *)mantra, sizeof(mantra));
@@ -1293,6 +1385,7 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
         tmxr_debug_connect_line (lp, msg);
         lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0)  | 
                                                                                                                   (lp->mp->packet ? SIM_SOCK_OPT_NODELAY : 0));
+        _tmxr_poll_changed ();
         }
 
     }
@@ -1367,6 +1460,7 @@ if ((lp->destination) && (!lp->serport)) {
         }
     }
 tmxr_init_line (lp);                                /* initialize line state */
+_tmxr_poll_changed ();
 return SCPE_OK;
 }
 
@@ -1707,6 +1801,7 @@ else {
             lp->conn = TRUE;                            /* record connection */
             lp->sock = lp->mp->ring_sock;               /* save socket */
             lp->mp->ring_sock = INVALID_SOCKET;
+            _tmxr_poll_changed ();
             lp->ipad = lp->mp->ring_ipad;               /* ip address */
             lp->mp->ring_ipad = NULL;
             lp->mp->ring_start_time = 0;
@@ -1779,6 +1874,7 @@ if (lp->mp && lp->modem_control) {                  /* This API ONLY works on mo
                 tmxr_debug_connect_line (lp, msg);
                 lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | 
                                                                                                                           (lp->packet ? SIM_SOCK_OPT_NODELAY : 0));
+                _tmxr_poll_changed ();
                 }
             }
         }
@@ -1824,6 +1920,7 @@ if (lp->loopback) {
     lp->lpbcnt = lp->lpbpi = lp->lpbpr = 0;
     if (!lp->conn)
         lp->ser_connect_pending = TRUE;
+    _tmxr_ready_add (lp, TMXR_RDY_RX);
     }
 else {
     free (lp->lpb);
@@ -1890,6 +1987,17 @@ return r;
 }
 
 
+/* Character totals across all lines (reported by BENCHMARK) */
+
+static t_uint64 tmxr_chars_read = 0;
+static t_uint64 tmxr_chars_written = 0;
+
+void tmxr_data_totals (t_uint64 *chars_read, t_uint64 *chars_written)
+{
+*chars_read = tmxr_chars_read;
+*chars_written = tmxr_chars_written;
+}
+
 /* Get character from specific line
 
    Inputs:
@@ -1932,6 +2040,7 @@ if (((lp->conn || lp->txbfd) && lp->rcve) &&            /* (conn or buffered) &
 if (lp->rxbpi == lp->rxbpr)                             /* empty? zero ptrs */
     lp->rxbpi = lp->rxbpr = 0;
 if (val) {                                              /* Got something? */
+    ++tmxr_chars_read;
     if (lp->rxbps)
         lp->rxnexttime = floor (sim_gtime_now + ((lp->rxdeltausecs * sim_timer_inst_per_sec ()) / USECS_PER_SECOND));
     else
@@ -2017,16 +2126,24 @@ return SCPE_LOST;
 
 void tmxr_poll_rx (TMXR *mp)
 {
-int32 i, nbytes, j;
-TMLN *lp;
+int32 nbytes, j;
+TMLN *lp, *next;
 
 tmxr_debug_trace (mp, "tmxr_poll_rx()");
-for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
-    lp = mp->ldsc + i;                                  /* get line desc */
-    if (!(lp->sock || lp->serport || lp->loopback) || 
-        !(lp->rcve))                                    /* skip if not connected */
+if ((mp->rdy_ldsc != mp->ldsc) || (mp->rdy_lines != mp->lines))
+    _tmxr_ready_build (mp);                             /* (re)build ready lists */
+for (lp = mp->rdy_head[TMXR_RDY_RX]; lp != NULL; lp = next) {/* loop thru ready lines */
+    next = lp->rdy_next[TMXR_RDY_RX];
+    if (lp->rxbpi == lp->rxbpr)                         /* if buf empty, */
+        lp->rxbpi = lp->rxbpr = 0;                      /* reset pointers */
+    if (!(lp->sock || lp->serport || lp->loopback)) {   /* no longer connected? */
+        _tmxr_ready_del (mp, lp, TMXR_RDY_RX);          /* drop from list */
+        continue;
+        }
+    if (!(lp->rcve))                                    /* skip if not enabled */
         continue;
 
+    ++lp->rxpolls;
     nbytes = 0;
     if (lp->rxbpi == 0)                                 /* need input? */
         nbytes = tmxr_read (lp,                         /* yes, read */
@@ -2246,12 +2363,9 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
                 }
             }
         }                                               /* end else nbytes */
-    }                                                   /* end for lines */
-for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
-    lp = mp->ldsc + i;                                  /* get line desc */
     if (lp->rxbpi == lp->rxbpr)                         /* if buf empty, */
         lp->rxbpi = lp->rxbpr = 0;                      /* reset pointers */
-    }                                                   /* end for */
+    }                                                   /* end for lines */
 }
 
 
@@ -2308,6 +2422,7 @@ if ((lp->conn == FALSE) &&                              /* no conn & not buffere
     return SCPE_LOST;
     }
 tmxr_debug_trace_line (lp, "tmxr_putc_ln()");
+_tmxr_ready_add (lp, TMXR_RDY_TX);                      /* output needs polling */
 #define TXBUF_AVAIL(lp) ((lp->serport ? 2: lp->txbsz) - tmxr_tqln (lp))
 #define TXBUF_CHAR(lp, c) {                               \
     lp->txb[lp->txbpi++] = (char)(c);                     \
@@ -2343,6 +2458,7 @@ if ((lp->conn && (TXBUF_AVAIL(lp) > 1)) ||              /* connected and room fo
                         (lp->txdeltausecs - 1000) / 1000 : 
                         1);                             /* wait an approximate character delay */
         }
+    ++tmxr_chars_written;
     return SCPE_OK;                                     /* char sent */
     }
 ++lp->txstall; lp->xmte = 0;                            /* no room, dsbl line */
@@ -2414,15 +2530,20 @@ return (lp->conn || lp->loopback) ? SCPE_OK : SCPE_LOST;
 
 void tmxr_poll_tx (TMXR *mp)
 {
-int32 i, nbytes;
-TMLN *lp;
+int32 nbytes;
+TMLN *lp, *next;
 double sim_gtime_now = sim_gtime ();
 
 tmxr_debug_trace (mp, "tmxr_poll_tx()");
-for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
-    lp = mp->ldsc + i;                                  /* get line desc */
-    if ((!lp->conn) && (!lp->txbfd))                    /* skip if !conn and !buffered */
+if ((mp->rdy_ldsc != mp->ldsc) || (mp->rdy_lines != mp->lines))
+    _tmxr_ready_build (mp);                             /* (re)build ready lists */
+for (lp = mp->rdy_head[TMXR_RDY_TX]; lp != NULL; lp = next) {/* loop thru ready lines */
+    next = lp->rdy_next[TMXR_RDY_TX];
+    if ((!lp->conn) && (!lp->txbfd)) {                  /* drop if !conn and !buffered */
+        _tmxr_ready_del (mp, lp, TMXR_RDY_TX);
         continue;
+        }
+    ++lp->txpolls;
     nbytes = tmxr_send_buffered_data (lp);              /* buffered bytes */
     if (nbytes == 0) {                                  /* buf empty? enab line */
 #if defined(SIM_ASYNCH_MUX)
@@ -2436,6 +2557,8 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
             ((lp->txbps == 0) ||
              (lp->txnexttime <= sim_gtime_now)))
             lp->xmte = 1;                               /* enable line transmit */
+        if (lp->xmte && lp->rdy_on[TMXR_RDY_TX])        /* drained and enabled? */
+            _tmxr_ready_del (mp, lp, TMXR_RDY_TX);      /* nothing more to do */
         }
     }                                                   /* end for */
 }
@@ -2568,6 +2691,7 @@ if (lp->serport) {                          /* close current serial connection *
     lp->destination = NULL;
     }
 tmxr_set_line_loopback (lp, FALSE);
+_tmxr_poll_changed ();
 }
 
 t_stat tmxr_detach_ln (TMLN *lp)
@@ -3003,6 +3127,7 @@ while (*tptr) {
             lp->txb = (char *)realloc(lp->txb, lp->txbsz);
             lp->rxb = (char *)realloc(lp->rxb, lp->rxbsz);
             lp->rbr = (char *)realloc(lp->rbr, lp->rxbsz);
+            memset (lp->rbr, 0, lp->rxbsz);             /* no breaks pending */
             }
         if (nolog) {
             mp->logfiletmpl[0] = '\0';
@@ -3171,6 +3296,7 @@ while (*tptr) {
         lp->txb = (char *)realloc (lp->txb, lp->txbsz);
         lp->rxb = (char *)realloc(lp->rxb, lp->rxbsz);
         lp->rbr = (char *)realloc(lp->rbr, lp->rxbsz);
+        memset (lp->rbr, 0, lp->rxbsz);                 /* no breaks pending */
         lp->packet = packet;
         if (nolog) {
             free(lp->txlogname);
@@ -3296,6 +3422,7 @@ if (mp->ldsc[line].uptr)
 mp->ldsc[line].uptr = uptr_poll;
 if (uptr_poll->tmxr)                /* associated with a TMXR? */
     mp->ldsc[line].uptr->dynflags |= UNIT_TM_POLL;
+_tmxr_poll_changed ();
 return SCPE_OK;
 }
 
@@ -3371,22 +3498,114 @@ pthread_t           sim_tmxr_poll_thread;          /* Polling Thread Id */
 pthread_t           sim_tmxr_serial_poll_thread;   /* Serial Polling Thread Id */
 pthread_cond_t      sim_tmxr_serial_startup_cond;
 #endif
-pthread_mutex_t     sim_tmxr_poll_lock;
-pthread_cond_t      sim_tmxr_poll_cond;
+extern pthread_mutex_t sim_tmxr_poll_lock;             /* defined and initialized in scp.c */
+extern pthread_cond_t sim_tmxr_poll_cond;
 pthread_cond_t      sim_tmxr_startup_cond;
-int32               sim_tmxr_poll_count = 0;
+extern int32        sim_tmxr_poll_count;
 t_bool              sim_tmxr_poll_running = FALSE;
 
+/* Polled descriptor table
+
+   The poll thread watches every listening socket, connected socket, outgoing
+   connection in progress and (on Unix) serial port of all open muxes.  Rather
+   than rediscovering these on every wakeup, the set is kept in tmxr_pfd and
+   rebuilt only when tmxr_poll_gen shows that a descriptor has come or gone.
+   Where epoll is available the descriptors are registered with the kernel at
+   that point, each one carrying the UNIT which polls for it, so a wakeup costs
+   time proportional to the ready descriptors and is not limited by FD_SETSIZE.
+   Otherwise select() is used with fd_sets built from the same table.
+*/
+
+typedef struct {
+    SOCKET      sock;                                   /* descriptor */
+    UNIT        *uptr;                                  /* unit to activate */
+    } TMXR_PFD;
+
+static TMXR_PFD *tmxr_pfd = NULL;                       /* polled descriptors */
+static int tmxr_pfd_count = 0;
+static int tmxr_pfd_size = 0;
+
+static void _tmxr_pfd_add (SOCKET sock, UNIT *uptr)
+{
+if (tmxr_pfd_count == tmxr_pfd_size) {
+    tmxr_pfd_size = tmxr_pfd_size ? 2 * tmxr_pfd_size : 64;
+    tmxr_pfd = (TMXR_PFD *)realloc (tmxr_pfd, tmxr_pfd_size * sizeof (*tmxr_pfd));
+    }
+tmxr_pfd[tmxr_pfd_count].sock = sock;
+tmxr_pfd[tmxr_pfd_count].uptr = uptr;
+++tmxr_pfd_count;
+}
+
+static void _tmxr_pfd_build (void)
+{
+int i, j;
+
+tmxr_pfd_count = 0;
+for (i=0; i<tmxr_open_device_count; ++i) {
+    TMXR *mp = tmxr_open_devices[i];
+
+    if ((mp->master) && (mp->uptr->dynflags&UNIT_TM_POLL))
+        _tmxr_pfd_add (mp->master, mp->uptr);
+    for (j=0; j<mp->lines; ++j) {
+        TMLN *lp = &mp->ldsc[j];
+        UNIT *uptr = lp->uptr ? lp->uptr : mp->uptr;
+
+        if (lp->sock)
+            _tmxr_pfd_add (lp->sock, uptr);
+#if defined (__unix__) || defined(__APPLE__) || defined(__hpux)
+        if (lp->serport)
+            _tmxr_pfd_add ((SOCKET)sim_serial_fd (lp->serport), uptr);
+#endif
+        if (lp->connecting)
+            _tmxr_pfd_add (lp->connecting, mp->uptr);
+        if (lp->master)
+            _tmxr_pfd_add (lp->master, mp->uptr);
+        }
+    }
+}
+
+/* Activate a unit with a ready descriptor.  More than one descriptor can be
+   associated with the same unit, so make sure to only activate it one time */
+
+static void _tmxr_poll_activate (UNIT *uptr, UNIT **activated, int *wait_count)
+{
+DEVICE *d;
+int j;
+
+for (j=0; j<*wait_count; ++j)
+    if (activated[j] == uptr)
+        return;
+activated[j] = uptr;
+++*wait_count;
+d = find_dev_from_unit(uptr);
+if (!uptr->a_polling_now) {
+    uptr->a_polling_now = TRUE;
+    uptr->a_poll_waiter_count = 1;
+    sim_debug (TMXR_DBG_ASY, d, "_tmxr_poll() - Activating for data %s\n", sim_uname(uptr));
+    pthread_mutex_unlock (&sim_tmxr_poll_lock);
+    _sim_activate (uptr, 0);
+    pthread_mutex_lock (&sim_tmxr_poll_lock);
+    }
+else {
+    sim_debug (TMXR_DBG_ASY, d, "_tmxr_poll() - Already Activated %s %d times\n", sim_uname(uptr), uptr->a_poll_waiter_count);
+    ++uptr->a_poll_waiter_count;
+    }
+}
+
 static void *
 _tmxr_poll(void *arg)
 {
 struct timeval timeout;
 int timeout_usec;
 DEVICE *dptr = tmxr_open_devices[0]->dptr;
-UNIT **units = NULL;
 UNIT **activated = NULL;
-SOCKET *sockets = NULL;
+int activated_size = 0;
 int wait_count = 0;
+uint32 poll_gen = tmxr_poll_gen - 1;
+#if defined(HAVE_EPOLL)
+int epfd = -1;
+struct epoll_event *events = NULL;
+#endif
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution 
    thread which, in general, won't be readily yielding the processor when 
@@ -3395,9 +3614,6 @@ sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
 
 sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - starting\n");
 
-units = (UNIT **)calloc(FD_SETSIZE, sizeof(*units));
-activated = (UNIT **)calloc(FD_SETSIZE, sizeof(*activated));
-sockets = (SOCKET *)calloc(FD_SETSIZE, sizeof(*sockets));
 timeout_usec = 1000000;
 pthread_mutex_lock (&sim_tmxr_poll_lock);
 pthread_cond_signal (&sim_tmxr_startup_cond);   /* Signal we're ready to go */
@@ -3424,62 +3640,50 @@ while (sim_asynch_enabled) {
         pthread_cond_wait (&sim_tmxr_poll_cond, &sim_tmxr_poll_lock);
         sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - continuing with timeout of %dms\n", timeout_usec/1000);
         }
-    FD_ZERO (&readfds);
-    FD_ZERO (&errorfds);
-    for (i=max_socket_fd=socket_count=0; i<tmxr_open_device_count; ++i) {
-        mp = tmxr_open_devices[i];
-        if ((mp->master) && (mp->uptr->dynflags&UNIT_TM_POLL)) {
-            units[socket_count] = mp->uptr;
-            sockets[socket_count] = mp->master;
-            FD_SET (mp->master, &readfds);
-            FD_SET (mp->master, &errorfds);
-            if (mp->master > max_socket_fd)
-                max_socket_fd = mp->master;
-            ++socket_count;
+    if (poll_gen != tmxr_poll_gen) {            /* descriptors changed? */
+        poll_gen = tmxr_poll_gen;
+        _tmxr_pfd_build ();
+        if (activated_size < tmxr_pfd_size) {
+            activated_size = tmxr_pfd_size;
+            activated = (UNIT **)realloc (activated, activated_size * sizeof (*activated));
+#if defined(HAVE_EPOLL)
+            events = (struct epoll_event *)realloc (events, activated_size * sizeof (*events));
+#endif
             }
-        for (j=0; j<mp->lines; ++j) {
-            if (mp->ldsc[j].sock) {
-                units[socket_count] = mp->ldsc[j].uptr;
-                if (units[socket_count] == NULL)
-                    units[socket_count] = mp->uptr;
-                sockets[socket_count] = mp->ldsc[j].sock;
-                FD_SET (mp->ldsc[j].sock, &readfds);
-                FD_SET (mp->ldsc[j].sock, &errorfds);
-                if (mp->ldsc[j].sock > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].sock;
-                ++socket_count;
-                }
-#if !defined(_WIN32) && !defined(VMS)
-            if (mp->ldsc[j].serport) {
-                units[socket_count] = mp->ldsc[j].uptr;
-                if (units[socket_count] == NULL)
-                    units[socket_count] = mp->uptr;
-                sockets[socket_count] = mp->ldsc[j].serport;
-                FD_SET (mp->ldsc[j].serport, &readfds);
-                FD_SET (mp->ldsc[j].serport, &errorfds);
-                if (mp->ldsc[j].serport > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].serport;
-                ++socket_count;
+#if defined(HAVE_EPOLL)
+        /* A fresh epoll instance avoids stale registrations for
+           descriptor numbers which were closed and reused */
+        if (epfd >= 0)
+            close (epfd);
+        epfd = epoll_create1 (EPOLL_CLOEXEC);
+        for (i=0; (epfd >= 0) && (i<tmxr_pfd_count); ++i) {
+            struct epoll_event ev;
+
+            memset (&ev, 0, sizeof (ev));
+            ev.events = EPOLLIN;                /* errors and hangups are implied */
+            ev.data.ptr = tmxr_pfd[i].uptr;
+            if ((epoll_ctl (epfd, EPOLL_CTL_ADD, (int)tmxr_pfd[i].sock, &ev)) && (errno != EEXIST)) {
+                sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - epoll_ctl() failed for %d, errno=%d - using select()\n", (int)tmxr_pfd[i].sock, errno);
+                close (epfd);
+                epfd = -1;
                 }
+            }
 #endif
-            if (mp->ldsc[j].connecting) {
-                units[socket_count] = mp->uptr;
-                sockets[socket_count] = mp->ldsc[j].connecting;
-                FD_SET (mp->ldsc[j].connecting, &readfds);
-                FD_SET (mp->ldsc[j].connecting, &errorfds);
-                if (mp->ldsc[j].connecting > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].connecting;
-                ++socket_count;
-                }
-            if (mp->ldsc[j].master) {
-                units[socket_count] = mp->uptr;
-                sockets[socket_count] = mp->ldsc[j].master;
-                FD_SET (mp->ldsc[j].master, &readfds);
-                FD_SET (mp->ldsc[j].master, &errorfds);
-                if (mp->ldsc[j].master > max_socket_fd)
-                    max_socket_fd = mp->ldsc[j].master;
-                ++socket_count;
-                }
+        sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - polling %d descriptors\n", tmxr_pfd_count);
+        }
+    socket_count = tmxr_pfd_count;
+    max_socket_fd = 0;
+#if defined(HAVE_EPOLL)
+    if (epfd < 0)
+#endif
+        {
+        FD_ZERO (&readfds);
+        FD_ZERO (&errorfds);
+        for (i=0; i<socket_count; ++i) {
+            FD_SET (tmxr_pfd[i].sock, &readfds);
+            FD_SET (tmxr_pfd[i].sock, &errorfds);
+            if (tmxr_pfd[i].sock > max_socket_fd)
+                max_socket_fd = tmxr_pfd[i].sock;
             }
         }
     pthread_mutex_unlock (&sim_tmxr_poll_lock);
@@ -3492,14 +3696,20 @@ while (sim_asynch_enabled) {
         sim_os_ms_sleep (timeout_usec/1000);
         status = 0;
         }
-    else
-        status = select (1+(int)max_socket_fd, &readfds, NULL, &errorfds, &timeout);
+    else {
+#if defined(HAVE_EPOLL)
+        if (epfd >= 0)
+            status = epoll_wait (epfd, events, socket_count, timeout_usec/1000);
+        else
+#endif
+            status = select (1+(int)max_socket_fd, &readfds, NULL, &errorfds, &timeout);
+        }
     select_errno = errno;
     wait_count=0;
     pthread_mutex_lock (&sim_tmxr_poll_lock);
     switch (status) {
         case 0:     /* timeout */
-            for (i=max_socket_fd=socket_count=0; i<tmxr_open_device_count; ++i) {
+            for (i=0; i<tmxr_open_device_count; ++i) {
                 mp = tmxr_open_devices[i];
                 if (mp->master) {
                     if (!mp->uptr->a_polling_now) {
@@ -3548,34 +3758,18 @@ while (sim_asynch_enabled) {
             break;
         default:
             wait_count = 0;
-            for (i=0; i<socket_count; ++i) {
-                if (FD_ISSET(sockets[i], &readfds) || 
-                    FD_ISSET(sockets[i], &errorfds)) {
-                    /* More than one socket can be associated with the 
-                       same unit.  Only activate one time */
-                    for (j=0; j<wait_count; ++j)
-                        if (activated[j] == units[i])
-                            break;
-                    if (j == wait_count) {
-                        activated[j] = units[i];
-                        ++wait_count;
-                        if (!activated[j]->a_polling_now) {
-                            activated[j]->a_polling_now = TRUE;
-                            activated[j]->a_poll_waiter_count = 1;
-                            d = find_dev_from_unit(activated[j]);
-                            sim_debug (TMXR_DBG_ASY, d, "_tmxr_poll() - Activating for data %s\n", sim_uname(activated[j]));
-                            pthread_mutex_unlock (&sim_tmxr_poll_lock);
-                            _sim_activate (activated[j], 0);
-                            pthread_mutex_lock (&sim_tmxr_poll_lock);
-                            }
-                        else {
-                            d = find_dev_from_unit(activated[j]);
-                            sim_debug (TMXR_DBG_ASY, d, "_tmxr_poll() - Already Activated %s%d %d times\n", sim_uname(activated[j]), activated[j]->a_poll_waiter_count);
-                            ++activated[j]->a_poll_waiter_count;
-                            }
-                        }
-                    }
+#if defined(HAVE_EPOLL)
+            if (epfd >= 0) {
+                for (i=0; i<status; ++i)
+                    _tmxr_poll_activate ((UNIT *)events[i].data.ptr, activated, &wait_count);
                 }
+            else
+#endif
+                for (i=0; i<socket_count; ++i) {
+                    if (FD_ISSET(tmxr_pfd[i].sock, &readfds) || 
+                        FD_ISSET(tmxr_pfd[i].sock, &errorfds))
+                        _tmxr_poll_activate (tmxr_pfd[i].uptr, activated, &wait_count);
+                    }
             if (wait_count)
                 timeout_usec = 10000; /* Wait 10ms next time */
             break;
@@ -3583,9 +3777,12 @@ while (sim_asynch_enabled) {
     sim_tmxr_poll_count += wait_count;
     }
 pthread_mutex_unlock (&sim_tmxr_poll_lock);
-free(units);
 free(activated);
-free(sockets);
+#if defined(HAVE_EPOLL)
+if (epfd >= 0)
+    close (epfd);
+free(events);
+#endif
 
 sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - exiting\n");
 
@@ -3938,6 +4135,7 @@ if (!found) {
     for (i=0; i<mux->lines; i++)
         mux->ldsc[i].send.after = mux->ldsc[i].send.delay = 0;
     }
+_tmxr_poll_changed ();
 #if defined(SIM_ASYNCH_MUX)
 pthread_mutex_unlock (&sim_tmxr_poll_lock);
 if ((tmxr_open_device_count == 1) && (sim_asynch_enabled))
@@ -3960,6 +4158,7 @@ for (i=0; i<tmxr_open_device_count; ++i)
         --tmxr_open_device_count;
         break;
         }
+_tmxr_poll_changed ();
 #if defined(SIM_ASYNCH_MUX)
 pthread_mutex_unlock (&sim_tmxr_poll_lock);
 #endif
@@ -4526,7 +4725,7 @@ if (sooner != interval) {
 #if defined(SIM_ASYNCH_MUX)
 if (!sim_asynch_enabled) {
     sim_debug (TIMER_DBG_MUX, &sim_timer_dev, "tmxr_clock_coschedule_tmr(tmr=%d) - coscheduling %s after interval %d ticks\n", tmr, sim_uname (uptr), ticks);
-    return sim_clock_coschedule (uptr, tmr, ticks);
+    return sim_clock_coschedule_tmr (uptr, tmr, ticks);
     }
 return SCPE_OK;
 #else
@@ -4991,6 +5190,8 @@ else {
             fprintf (st, "*%.0f", lp->bpsfactor);
         fprintf (st, " bps\n");
         }
+    if (lp->rxpolls || lp->txpolls)
+        fprintf (st, "  serviced by input/output polls = %u/%u\n", lp->rxpolls, lp->txpolls);
     }
 if (lp->txbfd)
     fprintf (st, "  output buffer size = %d\n", lp->txbsz);
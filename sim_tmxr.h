@@ -206,6 +206,11 @@ struct tmln {
     DEVICE              *dptr;                          /* line specific device */
     EXPECT              expect;                         /* Expect rules */
     SEND                send;                           /* Send input state */
+    TMLN                *rdy_next[2];                   /* ready list links (rx, tx) - private */
+    TMLN                *rdy_prev[2];
+    t_bool              rdy_on[2];                      /* on ready list flags - private */
+    uint32              rxpolls;                        /* rcv polls which serviced line */
+    uint32              txpolls;                        /* xmt polls which serviced line */
     };
 
 struct tmxr {
@@ -231,6 +236,9 @@ struct tmxr {
     t_bool              port_speed_control;             /* multiplexer programmatically sets port speed */
     t_bool              packet;                         /* Lines are packet oriented */
     t_bool              datagram;                       /* Lines use datagram packet transport */
+    TMLN                *rdy_head[2];                   /* ready lists (rx, tx) - private */
+    TMLN                *rdy_ldsc;                      /* line array ready lists describe - private */
+    int32               rdy_lines;                      /* line count ready lists describe - private */
     };
 
 int32 tmxr_poll_conn (TMXR *mp);
@@ -313,6 +321,7 @@ const char *tmxr_send_line_name (const SEND *snd);
 const char *tmxr_expect_line_name (const EXPECT *exp);
 t_stat tmxr_startup (void);
 t_stat tmxr_shutdown (void);
+void tmxr_data_totals (t_uint64 *chars_read, t_uint64 *chars_written);
 t_stat tmxr_sock_test (DEVICE *dptr);
 t_stat tmxr_start_poll (void);
 t_stat tmxr_stop_poll (void);
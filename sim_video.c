@@ -316,13 +316,14 @@ static int SDL_SavePNG_RW(SDL_Surface *surface, SDL_RWops *dst, int freedst)
 #define EVENT_CLOSE      2                              /* close event for SDL */
 #define EVENT_CURSOR     3                              /* new cursor for SDL */
 #define EVENT_WARP       4                              /* warp mouse position for SDL */
-#define EVENT_DRAW       5                              /* draw/blit region for SDL */
 #define EVENT_SHOW       6                              /* show SDL capabilities */
 #define EVENT_OPEN       7                              /* vid_open request */
 #define EVENT_EXIT       8                              /* program exit */
 #define EVENT_SCREENSHOT 9                              /* produce screenshot of video window */
 #define EVENT_BEEP      10                              /* audio beep */
 #define MAX_EVENTS      20                              /* max events in queue */
+#define VID_TILE_SHIFT   5                              /* damage tracked in 32x32 tiles */
+#define VID_TILE_SIZE   (1 << VID_TILE_SHIFT)
 
 typedef struct {
     SIM_KEY_EVENT events[MAX_EVENTS];
@@ -356,6 +357,7 @@ static void vid_beep_setup (int duration_ms, int tone_frequency);
 static void vid_beep_cleanup (void);
 static void vid_controllers_setup (void);
 static void vid_controllers_cleanup (void);
+static void vid_flush_damage (void);
 t_bool vid_key_state[SDL_NUM_SCANCODES];
 SDL_Texture *vid_texture;                               /* video buffer in GPU */
 SDL_Renderer *vid_renderer;
@@ -364,6 +366,12 @@ SDL_PixelFormat *vid_format;
 uint32 vid_windowID;
 SDL_Thread *vid_thread_handle = NULL;                   /* event thread handle */
 SDL_mutex *vid_draw_mutex = NULL;                       /* window update mutex */
+static uint32 *vid_shadow = NULL;                       /* shadow frame buffer */
+static uint8 *vid_damage = NULL;                        /* per tile damaged flags */
+static SDL_Rect *vid_damage_spans = NULL;               /* span work areas for vid_flush_damage */
+static int32 vid_tiles_x;                               /* tiles per row */
+static int32 vid_tiles_y;                               /* tile rows */
+static t_bool vid_refresh_pending = FALSE;              /* EVENT_REDRAW queued */
 SDL_Cursor *vid_cursor = NULL;                          /* current cursor */
 t_bool vid_cursor_visible = FALSE;                      /* cursor visibility state */
 KEY_EVENT_QUEUE vid_key_events;                         /* keyboard events */
@@ -570,6 +578,16 @@ if (0 == (--vid_gamepad_inited)) {
     }
 }
 
+static void vid_free_frame_buffer (void)
+{
+free (vid_shadow);
+vid_shadow = NULL;
+free (vid_damage);
+vid_damage = NULL;
+free (vid_damage_spans);
+vid_damage_spans = NULL;
+}
+
 t_stat vid_open (DEVICE *dptr, const char *title, uint32 width, uint32 height, int flags)
 {
 if (!vid_active) {
@@ -586,6 +604,17 @@ if (!vid_active) {
     vid_height = height;
     vid_mouse_captured = FALSE;
     vid_cursor_visible = (vid_flags & SIM_VID_INPUTCAPTURED);
+    vid_tiles_x = (vid_width + VID_TILE_SIZE - 1) >> VID_TILE_SHIFT;
+    vid_tiles_y = (vid_height + VID_TILE_SIZE - 1) >> VID_TILE_SHIFT;
+    vid_shadow = (uint32 *)calloc (vid_width * vid_height, sizeof (*vid_shadow));
+    vid_damage = (uint8 *)calloc (vid_tiles_x * vid_tiles_y, sizeof (*vid_damage));
+    vid_damage_spans = (SDL_Rect *)calloc (2 * vid_tiles_x, sizeof (*vid_damage_spans));
+    vid_refresh_pending = FALSE;
+    if ((!vid_shadow) || (!vid_damage) || (!vid_damage_spans)) {
+        vid_active = FALSE;
+        vid_free_frame_buffer ();
+        return SCPE_MEM;
+        }
 
     vid_key_events.head = 0;
     vid_key_events.tail = 0;
@@ -602,8 +631,11 @@ if (!vid_active) {
     memset (button_callback, 0, sizeof button_callback);
 
     stat = vid_create_window ();
-    if (stat != SCPE_OK)
+    if (stat != SCPE_OK) {
+        vid_active = FALSE;
+        vid_free_frame_buffer ();                       /* no window, drop the shadow */
         return stat;
+        }
 
     sim_debug (SIM_VID_DBG_VIDEO|SIM_VID_DBG_KEY|SIM_VID_DBG_MOUSE, vid_dev, "vid_open() - Success\n");
     }
@@ -634,6 +666,7 @@ if (vid_active) {
         }
     while (vid_ready)
         sim_os_ms_sleep (10);
+    vid_free_frame_buffer ();
 
     if (vid_mouse_events.sem) {
         SDL_DestroySemaphore(vid_mouse_events.sem);
@@ -700,56 +733,48 @@ uint32 vid_map_rgb (uint8 r, uint8 g, uint8 b)
 return SDL_MapRGB (vid_format, r, g, b);
 }
 
-static SDL_Rect *vid_dst_last;
-static uint32 *vid_data_last;
+/* vid_draw copies the region into the shadow frame buffer and marks the
+   tiles it covers as damaged.  Nothing is queued to the video thread; the
+   damaged tiles are uploaded to the texture as a batch by the next
+   vid_refresh (normally once per simulated vertical sync), so a device which
+   redraws a frame a scan line at a time costs neither memory allocations
+   nor event queue entries per call. */
 
 void vid_draw (int32 x, int32 y, int32 w, int32 h, uint32 *buf)
 {
-SDL_Event user_event;
-SDL_Rect *vid_dst;
-uint32 *vid_data;
+int32 row, tx, ty, tx_first, tx_last, ty_last;
+int32 pitch = w;
 
 sim_debug (SIM_VID_DBG_VIDEO, vid_dev, "vid_draw(%d, %d, %d, %d)\n", x, y, w, h);
 
-SDL_LockMutex (vid_draw_mutex);                         /* Synchronize to check region dimensions */
-if (vid_dst_last                                     && /* As yet unprocessed draw rectangle? */
-    (vid_dst_last->x == x) && (vid_dst_last->y == y) && /* AND identical position? */
-    (vid_dst_last->w == w) && (vid_dst_last->h == h)) { /* AND identical dimensions? */
-    memcpy (vid_data_last, buf, w*h*sizeof(*buf));      /* Replace region contents */
-    SDL_UnlockMutex (vid_draw_mutex);                   /* Done */
+if (!vid_shadow)
     return;
+if (x < 0) {                                            /* clip to frame buffer */
+    buf -= x;
+    w += x;
+    x = 0;
     }
-SDL_UnlockMutex (vid_draw_mutex);
-
-vid_dst = (SDL_Rect *)malloc (sizeof(*vid_dst));
-if (!vid_dst) {
-    sim_printf ("%s: vid_draw() memory allocation error\n", vid_dname(vid_dev));
-    return;
+if (y < 0) {
+    buf -= y * pitch;
+    h += y;
+    y = 0;
     }
-vid_dst->x = x;
-vid_dst->y = y;
-vid_dst->w = w;
-vid_dst->h = h;
-vid_data = (uint32 *)malloc (w*h*sizeof(*buf));
-if (!vid_data) {
-    sim_printf ("%s: vid_draw() memory allocation error\n", vid_dname(vid_dev));
-    free (vid_dst);
+if (x + w > vid_width)
+    w = vid_width - x;
+if (y + h > vid_height)
+    h = vid_height - y;
+if ((w <= 0) || (h <= 0))
     return;
-    }
-memcpy (vid_data, buf, w*h*sizeof(*buf));
-user_event.type = SDL_USEREVENT;
-user_event.user.code = EVENT_DRAW;
-user_event.user.data1 = (void *)vid_dst;
-user_event.user.data2 = (void *)vid_data;
-SDL_LockMutex (vid_draw_mutex);         /* protect vid_dst_last & vid_data_last */
-vid_dst_last = vid_dst;
-vid_data_last = vid_data;
-SDL_UnlockMutex (vid_draw_mutex);       /* done protection */
-if (SDL_PushEvent (&user_event) < 0) {
-    sim_printf ("%s: vid_draw() SDL_PushEvent error: %s\n", vid_dname(vid_dev), SDL_GetError());
-    free (vid_dst);
-    free (vid_data);
-    }
+SDL_LockMutex (vid_draw_mutex);                         /* protect vid_shadow & vid_damage */
+for (row = 0; row < h; row++)
+    memcpy (&vid_shadow[(y + row) * vid_width + x], &buf[row * pitch], w * sizeof (*buf));
+tx_first = x >> VID_TILE_SHIFT;
+tx_last = (x + w - 1) >> VID_TILE_SHIFT;
+ty_last = (y + h - 1) >> VID_TILE_SHIFT;
+for (ty = y >> VID_TILE_SHIFT; ty <= ty_last; ty++)
+    for (tx = tx_first; tx <= tx_last; tx++)
+        vid_damage[ty * vid_tiles_x + tx] = 1;
+SDL_UnlockMutex (vid_draw_mutex);                       /* done protection */
 }
 
 t_stat vid_set_cursor (t_bool visible, uint32 width, uint32 height, uint8 *data, uint8 *mask, uint32 hot_x, uint32 hot_y)
@@ -838,7 +863,16 @@ if ((x_delta) || (y_delta)) {
 void vid_refresh (void)
 {
 SDL_Event user_event;
+t_bool pending;
 
+SDL_LockMutex (vid_draw_mutex);
+pending = vid_refresh_pending;
+vid_refresh_pending = TRUE;
+SDL_UnlockMutex (vid_draw_mutex);
+if (pending) {                                          /* one queued refresh is enough */
+    sim_debug (SIM_VID_DBG_VIDEO, vid_dev, "vid_refresh() - Refresh Already Pending\n");
+    return;
+    }
 sim_debug (SIM_VID_DBG_VIDEO, vid_dev, "vid_refresh() - Queueing Refresh Event\n");
 
 user_event.type = SDL_USEREVENT;
@@ -846,8 +880,12 @@ user_event.user.code = EVENT_REDRAW;
 user_event.user.data1 = NULL;
 user_event.user.data2 = NULL;
 
-if (SDL_PushEvent (&user_event) < 0)
+if (SDL_PushEvent (&user_event) < 0) {
     sim_printf ("%s: vid_refresh() SDL_PushEvent error: %s\n", vid_dname(vid_dev), SDL_GetError());
+    SDL_LockMutex (vid_draw_mutex);
+    vid_refresh_pending = FALSE;
+    SDL_UnlockMutex (vid_draw_mutex);
+    }
 }
 
 int vid_map_key (int key)
@@ -1443,6 +1481,7 @@ else {
 void vid_update (void)
 {
 SDL_Rect vid_dst;
+vid_flush_damage ();
 vid_stretch(&vid_dst);
 sim_debug (SIM_VID_DBG_VIDEO, vid_dev, "Video Update Event: \n");
 if (sim_deb)
@@ -1479,26 +1518,69 @@ SDL_WarpMouseInWindow (NULL, vid_cursor_x, vid_cursor_y);
 SDL_PumpEvents ();
 }
 
-void vid_draw_region (SDL_UserEvent *event)
+static void vid_upload_span (SDL_Rect *r)
 {
-SDL_Rect *vid_dst = (SDL_Rect *)event->data1;
-uint32 *buf = (uint32 *)event->data2;
+if (r->x + r->w > vid_width)                            /* partial tiles at the right */
+    r->w = vid_width - r->x;
+if (r->y + r->h > vid_height)                           /* and bottom edges */
+    r->h = vid_height - r->y;
+sim_debug (SIM_VID_DBG_VIDEO, vid_dev, "Draw Region: (%d,%d,%d,%d)\n", r->x, r->y, r->w, r->h);
+if (SDL_UpdateTexture (vid_texture, r, &vid_shadow[r->y * vid_width + r->x], vid_width * sizeof (*vid_shadow)))
+    sim_printf ("%s: vid_flush_damage() - SDL_UpdateTexture error: %s\n", vid_dname(vid_dev), SDL_GetError());
+}
 
-sim_debug (SIM_VID_DBG_VIDEO, vid_dev, "Draw Region Event: (%d,%d,%d,%d)\n", vid_dst->x, vid_dst->x, vid_dst->w, vid_dst->h);
+/* Upload the damaged parts of the shadow frame buffer to the texture.
+   Each tile row is reduced to runs of adjacent damaged tiles, and a run
+   which exactly matches one in the row above extends it downwards, so a
+   full screen update or a scrolled band of lines becomes a single
+   SDL_UpdateTexture call. */
+
+static void vid_flush_damage (void)
+{
+SDL_Rect *prev = vid_damage_spans;
+SDL_Rect *cur = vid_damage_spans + vid_tiles_x;
+SDL_Rect *t;
+int32 prev_count = 0, cur_count, i, j, tx, ty;
+uint8 *damage;
 
 SDL_LockMutex (vid_draw_mutex);
-if (vid_dst == vid_dst_last) {
-    vid_dst_last = NULL;
-    vid_data_last = NULL;
+vid_refresh_pending = FALSE;
+if (!vid_shadow) {
+    SDL_UnlockMutex (vid_draw_mutex);
+    return;
     }
+for (ty = 0; ty < vid_tiles_y; ty++) {
+    damage = &vid_damage[ty * vid_tiles_x];
+    cur_count = 0;
+    for (tx = 0; tx < vid_tiles_x; tx++) {
+        if (!damage[tx])
+            continue;
+        cur[cur_count].x = tx << VID_TILE_SHIFT;
+        cur[cur_count].y = ty << VID_TILE_SHIFT;
+        cur[cur_count].h = VID_TILE_SIZE;
+        while ((tx < vid_tiles_x) && damage[tx])
+            damage[tx++] = 0;
+        cur[cur_count].w = (tx << VID_TILE_SHIFT) - cur[cur_count].x;
+        ++cur_count;
+        }
+    for (i = j = 0; i < prev_count; i++) {              /* extend or upload the spans above */
+        while ((j < cur_count) && (cur[j].x < prev[i].x))
+            ++j;
+        if ((j < cur_count) && (cur[j].x == prev[i].x) && (cur[j].w == prev[i].w)) {
+            cur[j].y = prev[i].y;
+            cur[j].h += prev[i].h;
+            }
+        else
+            vid_upload_span (&prev[i]);
+        }
+    t = prev;
+    prev = cur;
+    cur = t;
+    prev_count = cur_count;
+    }
+for (i = 0; i < prev_count; i++)
+    vid_upload_span (&prev[i]);
 SDL_UnlockMutex (vid_draw_mutex);
-
-if (SDL_UpdateTexture(vid_texture, vid_dst, buf, vid_dst->w*sizeof(*buf)))
-    sim_printf ("%s: vid_draw_region() - SDL_UpdateTexture error: %s\n", vid_dname(vid_dev), SDL_GetError());
-
-free (vid_dst);
-free (buf);
-event->data1 = NULL;
 }
 
 int vid_video_events (void)
@@ -1742,9 +1824,8 @@ while (vid_active) {
                 break;
 
             case SDL_USEREVENT:
-                /* There are 6 user events generated */
-                /* EVENT_REDRAW to update the display */
-                /* EVENT_DRAW   to update a region in the display texture */
+                /* There are 5 user events generated */
+                /* EVENT_REDRAW to upload damaged regions and update the display */
                 /* EVENT_SHOW   to display the current SDL video capabilities */
                 /* EVENT_CURSOR to change the current cursor */
                 /* EVENT_WARP   to warp the cursor position */
@@ -1776,10 +1857,6 @@ if (0)                        while (SDL_PeepEvents (&event, 1, SDL_GETEVENT, SD
                     if (event.user.code == EVENT_CLOSE) {
                         event.user.code = 0;    /* Mark as done */
                         }
-                    if (event.user.code == EVENT_DRAW) {
-                        vid_draw_region ((SDL_UserEvent*)&event);
-                        event.user.code = 0;    /* Mark as done */
-                        }
                     if (event.user.code == EVENT_SHOW) {
                         vid_show_video_event ();
                         event.user.code = 0;    /* Mark as done */